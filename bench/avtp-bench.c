@@ -0,0 +1,1043 @@
+/* avtp-bench.c
+ * Standalone benchmark harness for the IEEE 1722 / 1722.1 dissectors.
+ *
+ * Links packet-ieee1722.c and packet-ieee17221.c against a minimal epan
+ * stand-in (epan-shim.c) and feeds them synthetic frames in a loop, so the
+ * per-packet cost of each subtype can be measured without a full Wireshark
+ * build.  For every subtype the dissectors are run once without a tree
+ * (the packet-list pass) and once with a tree (the detail pass), and the
+ * harness reports packets/s, ns/packet and tree items/packet.
+ *
+ * Usage: avtp-bench [-n packets] [-c channels] [-b blocks] [-S streams]
+ *                   [-s 61883|aaf|adp|aecp|acmp|maap|crf|cvf|talker] [-o pref:value]
+ *                   [-f field] [-E] [-L n] [-M n] [-z stat] [-i n] [-d] [-u port|heur]
+ *                   [-R n] [-B n] [-I index]
+ *
+ *   -S  spread stream frames over this many stream IDs
+ *   -L  drop one stream packet in every n
+ *   -M  corrupt the packet data length of one 61883 packet in every n,
+ *       alternately too short for the CIP header and past the frame end
+ *   -R  capture n frames per 125 us instead of one
+ *   -B  give frames the capture time of the first of each group of n, so
+ *       they arrive in bursts at the same average rate
+ *   -z  attach a tshark statistics tap and print it after each run,
+ *       e.g. -z avtp,streams, or -z avtp,state with a small
+ *       -o ieee1722.state_memory and many -S streams to exercise eviction
+ *   -o  set a dissector preference, e.g. -o ieee1722.sample_tree:summary
+ *   -f  mark a field as referenced by a display filter
+ *   -E  treat every subtree as expanded, as in a fully expanded GUI tree
+ *   -i  print the Info column of the first n packets of the tree pass
+ *   -d  also time the tree-independent decode core (ieee1722-decode.c)
+ *       alone, for the subtypes it covers
+ *   -u  carry every frame over UDP (IEEE 1722-2016 Annex J), dispatched
+ *       by port or through the UDP heuristics; "heur" also times the
+ *       heuristic rejecting other UDP traffic
+ *   -I  after the runs, open this stream index (as written by
+ *       -z avtp,index,<file>) and time opening it and walking every
+ *       frame list
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "epan-shim.h"
+#include <epan/etypes.h>
+
+#include "../ieee1722-decode.h"
+#include "../ieee1722-index.h"
+
+/* Registration entry points, normally called from register.c */
+extern void proto_register_1722(void);
+extern void proto_register_17221(void);
+extern void proto_reg_handoff_1722(void);
+extern void proto_reg_handoff_17221(void);
+
+/* tshark statistics, normally called from tshark-tap-register.c */
+extern void register_tap_listener_avtpstreams(void);
+extern void register_tap_listener_avtpwav(void);
+extern void register_tap_listener_adpentities(void);
+extern void register_tap_listener_acmpsrt(void);
+extern void register_tap_listener_acmpgraph(void);
+extern void register_tap_listener_avtpindex(void);
+extern void register_tap_listener_avtpstate(void);
+
+#define BENCH_MAX_FRAME     1500
+#define BENCH_STREAM_ID     G_GUINT64_CONSTANT(0x0022970000010000)
+
+typedef struct _bench_frame {
+    guint8  data[BENCH_MAX_FRAME];
+    guint   len;
+    guint8  src_mac[6];
+} bench_frame_t;
+
+typedef void (*bench_build_t)(bench_frame_t *frame);
+typedef void (*bench_next_t)(bench_frame_t *frame, guint32 iteration);
+
+typedef struct _bench_case {
+    const char     *name;
+    bench_build_t   build;
+    bench_next_t    next;
+} bench_case_t;
+
+static guint bench_channels = 8;
+static guint bench_blocks = 6;
+static guint bench_streams = 1;
+static guint bench_loss = 0;
+static guint bench_malformed = 0;
+static guint bench_burst = 1;
+static guint bench_rate = 1;
+static guint bench_show_info = 0;
+static gboolean bench_decode_core = FALSE;
+
+#define BENCH_UDP_NONE      0
+#define BENCH_UDP_PORT      1
+#define BENCH_UDP_HEUR      2
+#define BENCH_UDP_ENCAP     4
+
+static guint bench_udp = BENCH_UDP_NONE;
+
+static void
+put_ntohs(guint8 *p, guint16 v)
+{
+    p[0] = v >> 8;
+    p[1] = v & 0xff;
+}
+
+static void
+put_ntohl(guint8 *p, guint32 v)
+{
+    put_ntohs(p, v >> 16);
+    put_ntohs(p + 2, v & 0xffff);
+}
+
+static void
+put_ntoh64(guint8 *p, guint64 v)
+{
+    put_ntohl(p, (guint32)(v >> 32));
+    put_ntohl(p + 4, (guint32)v);
+}
+
+/**********************************************************/
+/* IEC 61883-6 AM824 audio stream                         */
+/**********************************************************/
+static void
+build_61883(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+    guint payload = bench_blocks * bench_channels * 4;
+    guint i;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0x00;                    /* cd = 0, subtype = 61883/IIDC */
+    p[1] = 0x81;                    /* sv = 1, version = 0, tv = 1 */
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    put_ntohs(p + 20, 8 + payload); /* packet data length incl. CIP header */
+    p[22] = 0x5f;                   /* tag = 1, channel = 31 */
+    p[23] = 0xa0;                   /* tcode = 0xa, sy = 0 */
+    p[24] = 0x3f;                   /* sid */
+    p[25] = bench_channels;         /* dbs */
+    p[28] = 0x90;                   /* fmt = AM824 */
+    p[29] = 0x02;                   /* fdf: 48 kHz */
+    put_ntohs(p + 30, 0xffff);      /* syt */
+    for (i = 0; i < payload; i += 4) {
+        p[32 + i] = 0x40;           /* MBLA, 24-bit */
+        p[33 + i] = (guint8)(i * 7);
+        p[34 + i] = (guint8)(i * 13);
+        p[35 + i] = (guint8)(i * 29);
+    }
+    frame->len = 32 + payload;
+}
+
+static void
+next_61883(bench_frame_t *frame, guint32 iteration)
+{
+    guint8 *p = frame->data;
+    guint32 stream = iteration % bench_streams;
+    guint32 pkt = iteration / bench_streams;
+    guint event_block;
+    guint64 pt_ns;
+    guint32 ticks;
+
+    /* Skip one sequence number every bench_loss packets */
+    if (bench_loss != 0)
+        pkt += pkt / bench_loss;
+    p[2] = (guint8)pkt;
+    put_ntoh64(p + 4, BENCH_STREAM_ID + stream);
+    p[27] = (guint8)(pkt * bench_blocks);
+
+    /* 48 kHz: the block with DBC mod 8 == 0 carries the timestamp and SYT,
+     * presented 2 ms after the capture time set in run_case()
+     */
+    event_block = (8 - p[27] % 8) % 8;
+    if (event_block < bench_blocks) {
+        pt_ns = (pkt * bench_blocks + event_block) * G_GUINT64_CONSTANT(1000000000) / 48000 + 2000000;
+        ticks = (guint32)(pt_ns * 24576 / 1000000 % (16 * 3072));
+        p[1] |= 0x01;
+        put_ntohl(p + 12, (guint32)pt_ns);
+        put_ntohs(p + 30, (guint16)((ticks / 3072) << 12 | ticks % 3072));
+    }
+    else {
+        p[1] &= ~0x01;
+        put_ntohl(p + 12, 0);
+        put_ntohs(p + 30, 0xffff);
+    }
+
+    put_ntohs(p + 20, 8 + bench_blocks * bench_channels * 4);
+    if (bench_malformed != 0 && iteration % bench_malformed == bench_malformed - 1)
+        put_ntohs(p + 20, (iteration / bench_malformed) & 1 ? 0xfff0 : 4);
+}
+
+/**********************************************************/
+/* IEEE 1722.1 ADP / AECP / ACMP                          */
+/**********************************************************/
+static void
+build_adp(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0xfa;                    /* cd = 1, subtype = ADP */
+    p[1] = 0x00;                    /* ENTITY_AVAILABLE */
+    p[2] = 0x50;                    /* valid_time = 10 */
+    p[3] = 56;                      /* control data length */
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    put_ntohl(p + 12, 0x00229700);
+    put_ntohl(p + 16, 0x00000001);
+    put_ntohl(p + 20, 0x00000009);
+    put_ntohs(p + 24, 2);
+    put_ntohs(p + 26, 0x4001);
+    put_ntohs(p + 28, 2);
+    put_ntohs(p + 30, 0x4001);
+    put_ntohl(p + 32, 0x00000001);
+    put_ntoh64(p + 40, G_GUINT64_CONSTANT(0x0022970000000001));
+    put_ntohs(p + 48, 0x0820);
+    put_ntohs(p + 50, 0x00ff);
+    frame->len = 68;
+}
+
+/* Each entity reboots every 1000 announcements; with -L n every n-th
+ * announcement comes from a second station using the same GUID.  With
+ * more than one entity the last one goes quiet for 25 s (past its 20 s
+ * valid_time) out of every 50, sending ENTITY_DISCOVER instead.
+ */
+static void
+next_adp(bench_frame_t *frame, guint32 iteration)
+{
+    guint32 pkt = iteration / bench_streams;
+    gboolean impostor = bench_loss != 0 && pkt % bench_loss == bench_loss - 1;
+    gboolean silent = bench_streams > 1 && iteration % bench_streams == bench_streams - 1 &&
+                      iteration % 400000 >= 200000;
+
+    frame->data[1] = silent ? 0x02 : 0x00;
+    put_ntohl(frame->data + 36, impostor ? 0 : pkt % 1000);
+    put_ntoh64(frame->data + 4, BENCH_STREAM_ID + iteration % bench_streams);
+    frame->src_mac[5] = impostor ? 0x02 : 0x01;
+}
+
+static void
+build_aecp(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0xfb;                    /* cd = 1, subtype = AECP */
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    put_ntoh64(p + 12, G_GUINT64_CONSTANT(0x0022970000000002));
+}
+
+/* Enumeration cycle over 16 STREAM_INPUT descriptors: READ_DESCRIPTOR
+ * command and response, then SET_STREAM_FORMAT and GET_COUNTERS, which
+ * are annotated from the descriptor cache.
+ */
+static void
+next_aecp(bench_frame_t *frame, guint32 iteration)
+{
+    guint8 *p = frame->data;
+    guint16 index = (iteration / 4) % 16;
+
+    memset(p + 20, 0, sizeof(frame->data) - 20);
+    put_ntohs(p + 20, (guint16)(iteration / 2));
+    switch (iteration % 4) {
+    case 0:
+        p[1] = 0x00;                /* AEM_COMMAND */
+        put_ntohs(p + 22, 0x0004);  /* READ_DESCRIPTOR */
+        put_ntohs(p + 28, 0x0005);  /* STREAM_INPUT */
+        put_ntohs(p + 30, index);
+        frame->len = 32;
+        break;
+    case 1:
+        p[1] = 0x01;                /* AEM_RESPONSE */
+        put_ntohs(p + 22, 0x0004);
+        put_ntohs(p + 28, 0x0005);
+        put_ntohs(p + 30, index);
+        g_snprintf((gchar *)p + 32, 64, "Input %u", index);
+        frame->len = 28 + 132;
+        break;
+    case 2:
+        p[1] = 0x00;
+        put_ntohs(p + 22, 0x0008);  /* SET_STREAM_FORMAT */
+        put_ntohs(p + 24, 0x0005);
+        put_ntohs(p + 26, index);
+        put_ntoh64(p + 28, G_GUINT64_CONSTANT(0x00a0020840000800));
+        frame->len = 36;
+        break;
+    default:
+        p[1] = 0x01;
+        put_ntohs(p + 22, 0x0029);  /* GET_COUNTERS */
+        put_ntohs(p + 24, 0x0005);
+        put_ntohs(p + 26, index);
+        put_ntohl(p + 28, 0x0000000f);
+        frame->len = 32 + 128;
+        break;
+    }
+    p[3] = frame->len - 12;         /* control data length */
+}
+
+static void
+build_acmp(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0xfc;                    /* cd = 1, subtype = ACMP */
+    p[1] = 0x06;                    /* CONNECT_RX_COMMAND */
+    p[3] = 44;
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    put_ntoh64(p + 12, G_GUINT64_CONSTANT(0x0022970000000002));
+    put_ntoh64(p + 20, G_GUINT64_CONSTANT(0x0022970000000003));
+    put_ntoh64(p + 28, G_GUINT64_CONSTANT(0x0022970000000004));
+    p[40] = 0x91;
+    p[41] = 0xe0;
+    p[42] = 0xf0;
+    frame->len = 56;
+}
+
+/* Alternate command and response so transactions pair up, cycling
+ * through the command types.  With -L n every n-th command goes
+ * unanswered and is retried in place of its response.  Each round of
+ * commands addresses the next of -S listener sinks.
+ */
+static void
+next_acmp(bench_frame_t *frame, guint32 iteration)
+{
+    guint8 *p = frame->data;
+    guint32 transaction = iteration >> 1;
+    gboolean lost = bench_loss != 0 && transaction % bench_loss == bench_loss - 1;
+
+    p[1] = (guint8)((transaction % 7) * 2);
+    if ((iteration & 1) && !lost)
+        p[1] |= 1;
+    put_ntohs(p + 38, (guint16)(transaction / 7 % bench_streams));
+    put_ntohs(p + 48, (guint16)transaction);
+}
+
+/**********************************************************/
+/* Streams named by 1722.1                                */
+/**********************************************************/
+#define BENCH_TALKER_GUID   G_GUINT64_CONSTANT(0x0022970000000003)
+#define BENCH_TALKER_EVERY  64
+
+static bench_frame_t talker_stream_frame;
+
+static void
+build_talker(bench_frame_t *frame)
+{
+    build_61883(&talker_stream_frame);
+    *frame = talker_stream_frame;
+}
+
+/* 61883 frames over -S streams; one frame in BENCH_TALKER_EVERY is
+ * 1722.1 instead, cycling through a CONNECT_TX_RESPONSE that names a
+ * stream's talker (and SR class, B for odd streams), the talker's ENTITY descriptor and the stream's
+ * STREAM_OUTPUT descriptor, so streams get resolved as the capture goes.
+ */
+static void
+next_talker(bench_frame_t *frame, guint32 iteration)
+{
+    guint8 *p = frame->data;
+    guint32 slot = iteration / BENCH_TALKER_EVERY;
+    guint16 stream = (guint16)(slot / 3 % bench_streams);
+
+    if (iteration % BENCH_TALKER_EVERY != 0) {
+        if (p[0] != 0x00)
+            memcpy(p, talker_stream_frame.data, talker_stream_frame.len);
+        frame->len = talker_stream_frame.len;
+        next_61883(frame, iteration - slot - 1);
+        return;
+    }
+
+    memset(p, 0, 200);
+    switch (slot % 3) {
+    case 0:
+        p[0] = 0xfc;                /* ACMP */
+        p[1] = 0x01;                /* CONNECT_TX_RESPONSE */
+        p[3] = 44;
+        put_ntoh64(p + 4, BENCH_STREAM_ID + stream);
+        put_ntoh64(p + 12, G_GUINT64_CONSTANT(0x0022970000000002));
+        put_ntoh64(p + 20, BENCH_TALKER_GUID);
+        put_ntoh64(p + 28, G_GUINT64_CONSTANT(0x0022970000000004));
+        put_ntohs(p + 36, stream);
+        put_ntohs(p + 48, (guint16)slot);
+        put_ntohs(p + 50, stream & 1);      /* CLASS_B on odd streams */
+        frame->len = 56;
+        break;
+    case 1:
+        p[0] = 0xfb;                /* AECP */
+        p[1] = 0x01;                /* AEM_RESPONSE */
+        put_ntoh64(p + 4, BENCH_TALKER_GUID);
+        put_ntohs(p + 22, 0x0004);  /* READ_DESCRIPTOR */
+        put_ntohs(p + 28, 0x0000);  /* ENTITY */
+        g_snprintf((gchar *)p + 28 + 52, 64, "Stage Box");
+        frame->len = 28 + 52 + 64 + 16;
+        p[3] = frame->len - 12;
+        break;
+    default:
+        p[0] = 0xfb;
+        p[1] = 0x01;
+        put_ntoh64(p + 4, BENCH_TALKER_GUID);
+        put_ntohs(p + 22, 0x0004);
+        put_ntohs(p + 28, 0x0006);  /* STREAM_OUTPUT */
+        put_ntohs(p + 30, stream);
+        g_snprintf((gchar *)p + 32, 64, "Out %u", stream);
+        frame->len = 28 + 132;
+        p[3] = frame->len - 12;
+        break;
+    }
+}
+
+/**********************************************************/
+/* AAF                                                    */
+/**********************************************************/
+static void
+build_aaf(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0x02;                    /* subtype = AAF */
+    p[1] = 0x81;                    /* sv = 1, version = 0, tv = 1 */
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    p[17] = 0x50 | (bench_channels >> 8);   /* nsr = 48 kHz */
+    p[18] = bench_channels & 0xff;
+}
+
+/* Cycle through the INT_16BIT, INT_24BIT, INT_32BIT and FLOAT_32BIT
+ * formats, filling each channel with a ramp of a different amplitude.
+ */
+static void
+next_aaf(bench_frame_t *frame, guint32 iteration)
+{
+    static const guint8 formats[] = { 4, 3, 2, 1 };
+    static const guint sizes[] = { 2, 3, 4, 4 };
+    guint8 *p = frame->data;
+    guint8 format = formats[iteration % 4];
+    guint size = sizes[iteration % 4];
+    guint f, c;
+
+    p[2] = (guint8)iteration;
+    put_ntohl(p + 12, iteration * 125000 + 2000000);
+    p[16] = format;
+    p[19] = size * 8;
+    put_ntohs(p + 20, bench_blocks * bench_channels * size);
+    for (f = 0; f < bench_blocks; f++) {
+        for (c = 0; c < bench_channels; c++) {
+            guint8 *s = p + 24 + (f * bench_channels + c) * size;
+            double v = (f + 1.0) / bench_blocks / (c + 1) * (f & 1 ? -1 : 1);
+            union { float f; guint32 u; } conv;
+            gint32 i32 = (gint32)(v * 2147483647.0);
+
+            switch (format) {
+            case 4:
+                put_ntohs(s, (guint16)(i32 >> 16));
+                break;
+            case 3:
+                s[0] = i32 >> 24;
+                s[1] = i32 >> 16;
+                s[2] = i32 >> 8;
+                break;
+            case 2:
+                put_ntohl(s, (guint32)i32);
+                break;
+            default:
+                conv.f = (float)v;
+                put_ntohl(s, conv.u);
+                break;
+            }
+        }
+    }
+    frame->len = 24 + bench_blocks * bench_channels * size;
+}
+
+/**********************************************************/
+/* MAAP                                                   */
+/**********************************************************/
+static void
+build_maap(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0xfe;                    /* subtype = MAAP */
+    p[1] = 0x01;                    /* PROBE */
+    p[2] = 0x08;                    /* maap_version = 1 */
+    p[3] = 16;
+    p[12] = 0x91;
+    p[13] = 0xe0;
+    p[14] = 0xf0;
+    p[15] = 0x00;
+    put_ntohs(p + 18, 16);
+    frame->len = 28;
+}
+
+static void
+next_maap(bench_frame_t *frame, guint32 iteration)
+{
+    /* Cycle through PROBE, DEFEND and ANNOUNCE */
+    frame->data[1] = 1 + iteration % 3;
+}
+
+/**********************************************************/
+/* CRF                                                    */
+/**********************************************************/
+#define BENCH_CRF_TIMESTAMPS    6
+#define BENCH_CRF_INTERVAL      160
+#define BENCH_CRF_DRIFT_PPM     25.0
+
+static void
+build_crf(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0x04;                    /* subtype = CRF */
+    p[1] = 0x80;                    /* sv = 1, version = 0 */
+    p[3] = 0x01;                    /* type = audio sample */
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    put_ntohl(p + 12, 48000);       /* pull = 1.0, base frequency = 48 kHz */
+    put_ntohs(p + 16, BENCH_CRF_TIMESTAMPS * 8);
+    put_ntohs(p + 18, BENCH_CRF_INTERVAL);
+    frame->len = 20 + BENCH_CRF_TIMESTAMPS * 8;
+}
+
+static void
+next_crf(bench_frame_t *frame, guint32 iteration)
+{
+    guint8 *p = frame->data;
+    guint32 stream = iteration % bench_streams;
+    guint64 pkt = iteration / bench_streams;
+    double period_ns = BENCH_CRF_INTERVAL * 1e9 / 48000 / (1.0 + BENCH_CRF_DRIFT_PPM * 1e-6);
+    guint i;
+
+    if (bench_loss != 0)
+        pkt += pkt / bench_loss;
+    p[2] = (guint8)pkt;
+    put_ntoh64(p + 4, BENCH_STREAM_ID + stream);
+
+    /* A media clock running BENCH_CRF_DRIFT_PPM fast with +/-50 ns of jitter */
+    for (i = 0; i < BENCH_CRF_TIMESTAMPS; i++) {
+        guint64 k = pkt * BENCH_CRF_TIMESTAMPS + i;
+        gint jitter_ns = (gint)((k * 2654435761u) >> 7 & 0x3ff) * 100 / 1023 - 50;
+
+        put_ntoh64(p + 20 + i * 8, G_GINT64_CONSTANT(1000000000000) + (guint64)(k * period_ns) + jitter_ns);
+    }
+}
+
+/**********************************************************/
+/* CVF H.264, each NAL split into FU-A fragments          */
+/**********************************************************/
+#define BENCH_CVF_FRAGMENTS     3
+#define BENCH_CVF_FRAGMENT_LEN  1200
+
+static void
+build_cvf(bench_frame_t *frame)
+{
+    guint8 *p = frame->data;
+
+    memset(p, 0, sizeof(frame->data));
+    p[0] = 0x03;                    /* subtype = CVF */
+    p[1] = 0x81;                    /* sv = 1, version = 0, tv = 1 */
+    put_ntoh64(p + 4, BENCH_STREAM_ID);
+    p[16] = 0x02;                   /* format = RFC payload type */
+    p[17] = 0x01;                   /* format_subtype = H.264 */
+    put_ntohs(p + 20, 4 + 2 + BENCH_CVF_FRAGMENT_LEN);
+    p[28] = 0x60 | 28;              /* FU indicator: NRI = 3, FU-A */
+    frame->len = 28 + 2 + BENCH_CVF_FRAGMENT_LEN;
+}
+
+static void
+next_cvf(bench_frame_t *frame, guint32 iteration)
+{
+    guint8 *p = frame->data;
+    guint32 stream = iteration % bench_streams;
+    guint32 pkt = iteration / bench_streams;
+    guint fragment;
+    guint i;
+
+    if (bench_loss != 0)
+        pkt += pkt / bench_loss;
+    fragment = pkt % BENCH_CVF_FRAGMENTS;
+    p[2] = (guint8)pkt;
+    put_ntoh64(p + 4, BENCH_STREAM_ID + stream);
+    p[22] = fragment == BENCH_CVF_FRAGMENTS - 1 ? 0x10 : 0x00;
+    p[29] = 5;                      /* IDR slice */
+    if (fragment == 0)
+        p[29] |= 0x80;
+    if (fragment == BENCH_CVF_FRAGMENTS - 1)
+        p[29] |= 0x40;
+    for (i = 0; i < BENCH_CVF_FRAGMENT_LEN; i++)
+        p[30 + i] = (guint8)(fragment * BENCH_CVF_FRAGMENT_LEN + i);
+}
+
+/* Stand-in for the H.264 dissector: checks what the CVF reassembly hands over */
+static void
+dissect_bench_h264(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree _U_)
+{
+    guint len = tvb_length(tvb);
+    const guint8 *nal = tvb_get_ptr(tvb, 0, len);
+    gboolean ok = len == 1 + BENCH_CVF_FRAGMENTS * BENCH_CVF_FRAGMENT_LEN && nal[0] == 0x65;
+    guint i;
+
+    for (i = 1; ok && i < len; i++)
+        ok = nal[i] == (guint8)(i - 1);
+    col_add_fstr(pinfo->cinfo, COL_INFO, "H.264 NAL type %u, %u bytes%s",
+                 nal[0] & 0x1f, len, ok ? "" : " (corrupt)");
+}
+
+static const bench_case_t bench_cases[] = {
+    { "61883", build_61883, next_61883 },
+    { "adp",   build_adp,   next_adp   },
+    { "aecp",  build_aecp,  next_aecp  },
+    { "acmp",  build_acmp,  next_acmp  },
+    { "aaf",   build_aaf,   next_aaf   },
+    { "maap",  build_maap,  next_maap  },
+    { "crf",   build_crf,   next_crf   },
+    { "cvf",   build_cvf,   next_cvf   },
+    { "talker", build_talker, next_talker },
+};
+
+/**********************************************************/
+/* Driver                                                 */
+/**********************************************************/
+static double
+now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void
+run_case(const bench_case_t *bc, guint32 count, gboolean with_tree,
+         dissector_table_t ethertype_table)
+{
+    bench_frame_t frame;
+    guint8 udp_data[BENCH_UDP_ENCAP + BENCH_MAX_FRAME];
+    dissector_table_t udp_table = find_dissector_table("udp.port");
+    frame_data fd;
+    column_info cinfo;
+    packet_info pinfo;
+    jmp_buf env;
+    guint64 items = 0;
+    volatile guint32 rejected = 0;
+    guint64 exceptions = shim_exceptions;
+    guint64 expert_infos = shim_expert_infos;
+    guint64 capture_ns;
+    double start, elapsed;
+    guint32 i;
+
+    shim_init_dissection();
+    shim_reset_tap_listeners();
+    bc->build(&frame);
+    memcpy(frame.src_mac, "\x00\x22\x97\x00\x00\x01", 6);
+    memset(&fd, 0, sizeof(fd));
+    memset(&cinfo, 0, sizeof(cinfo));
+    memset(&pinfo, 0, sizeof(pinfo));
+    pinfo.cinfo = &cinfo;
+    pinfo.fd = &fd;
+
+    start = now_ns();
+    for (i = 0; i < count; i++) {
+        tvbuff_t *tvb;
+        proto_tree * volatile tree;
+
+        bc->next(&frame, i);
+        shim_packet_begin();
+        fd.num = i + 1;
+        fd.pfd = NULL;
+        fd.pkt_len = frame.len + 14;
+        pinfo.dl_src.type = AT_ETHER;
+        pinfo.dl_src.len = 6;
+        pinfo.dl_src.data = frame.src_mac;
+        capture_ns = (guint64)(i - i % bench_burst) * 125000 / bench_rate;
+        fd.abs_ts.secs = capture_ns / 1000000000;
+        fd.abs_ts.nsecs = capture_ns % 1000000000;
+
+        tree = with_tree ? shim_tree_create_root() : NULL;
+
+        shim_catch = &env;
+        if (bench_udp == BENCH_UDP_NONE) {
+            tvb = tvb_new_real_data(frame.data, frame.len, frame.len);
+            if (setjmp(env) == 0)
+                dissector_try_uint(ethertype_table, ETHERTYPE_AVBTP, tvb, &pinfo, tree);
+        }
+        else {
+            /* Annex J encapsulation sequence number, then the AVTPDU */
+            put_ntohl(udp_data, i);
+            memcpy(udp_data + BENCH_UDP_ENCAP, frame.data, frame.len);
+            fd.pkt_len = frame.len + BENCH_UDP_ENCAP + 42;
+            tvb = tvb_new_real_data(udp_data, frame.len + BENCH_UDP_ENCAP, frame.len + BENCH_UDP_ENCAP);
+            if (setjmp(env) == 0) {
+                if (bench_udp == BENCH_UDP_PORT)
+                    dissector_try_uint(udp_table, 17220, tvb, &pinfo, tree);
+                else if (!dissector_try_heuristic(shim_udp_heur_list, tvb, &pinfo, tree))
+                    rejected++;
+            }
+        }
+        shim_catch = NULL;
+        items += shim_tree_items;
+        if (with_tree && i < bench_show_info)
+            printf("%6u  %s\n", fd.num, cinfo.col_data[COL_INFO] ? cinfo.col_data[COL_INFO] : "");
+    }
+    elapsed = now_ns() - start;
+
+    printf("%-8s %-5s %10u %14.0f %10.1f %12.1f %8" G_GINT64_MODIFIER "u %8" G_GINT64_MODIFIER "u\n",
+           bc->name, with_tree ? "yes" : "no", count,
+           count / (elapsed / 1e9), elapsed / count,
+           (double)items / count, shim_exceptions - exceptions,
+           shim_expert_infos - expert_infos);
+    if (rejected)
+        printf("         (%u frames not recognised by the UDP heuristic)\n", rejected);
+    shim_draw_tap_listeners();
+}
+
+/* UDP heuristic on traffic that is not AVTP: DNS, RTP, NTP and random
+ * payloads, none of which may be claimed. */
+static void
+run_heur_reject(guint32 count)
+{
+    static const guint8 dns[] = {
+        0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x03, 'w', 'w', 'w', 0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 0x03, 'c', 'o', 'm', 0x00,
+        0x00, 0x01, 0x00, 0x01
+    };
+    guint8 data[4][256];
+    guint len[4];
+    frame_data fd;
+    column_info cinfo;
+    packet_info pinfo;
+    guint32 claimed = 0, seed = 1;
+    double start, elapsed;
+    guint32 i, j;
+
+    shim_init_dissection();
+    memset(&fd, 0, sizeof(fd));
+    memset(&cinfo, 0, sizeof(cinfo));
+    memset(&pinfo, 0, sizeof(pinfo));
+    pinfo.cinfo = &cinfo;
+    pinfo.fd = &fd;
+
+    memcpy(data[0], dns, sizeof(dns));
+    len[0] = sizeof(dns);
+    memset(data[1], 0, sizeof(data[1]));
+    data[1][0] = 0x80;              /* RTP v2, PT 96 */
+    data[1][1] = 0x60;
+    len[1] = 12 + 160;
+    memset(data[2], 0, sizeof(data[2]));
+    data[2][0] = 0x23;              /* NTP v4 client */
+    len[2] = 48;
+    len[3] = sizeof(data[3]);
+
+    start = now_ns();
+    for (i = 0; i < count; i++) {
+        guint k = i & 3;
+        tvbuff_t *tvb;
+
+        if (k == 3) {
+            for (j = 0; j < 16; j++) {
+                seed = seed * 1103515245 + 12345;
+                data[3][j] = (guint8)(seed >> 16);
+            }
+        }
+        else {
+            put_ntohs(data[k] + 2, (guint16)i);
+        }
+        fd.num = i + 1;
+        tvb = tvb_new_real_data(data[k], len[k], len[k]);
+        if (dissector_try_heuristic(shim_udp_heur_list, tvb, &pinfo, NULL))
+            claimed++;
+    }
+    elapsed = now_ns() - start;
+
+    printf("%-8s %-5s %10u %14.0f %10.1f %12.1f %8u %8u  (claimed %u)\n",
+           "non-avtp", "heur", count, count / (elapsed / 1e9), elapsed / count, 0.0, 0, 0, claimed);
+}
+
+/* Decode core only: no tvb, no tree, no analysis */
+static void
+run_decode(const bench_case_t *bc, guint32 count)
+{
+    bench_frame_t frame;
+    ieee1722_61883_hdr_t cip;
+    ieee17221_adp_pdu_t adp;
+    ieee17221_acmp_pdu_t acmp;
+    guint64 sum = 0;
+    double start, elapsed;
+    guint32 i;
+
+    bc->build(&frame);
+    switch (frame.data[0]) {
+    case 0x00:
+    case 0xfa:
+    case 0xfc:
+        break;
+    default:
+        return;
+    }
+
+    start = now_ns();
+    for (i = 0; i < count; i++) {
+        bc->next(&frame, i);
+        switch (frame.data[0]) {
+        case 0x00:
+            if (ieee1722_decode_61883(frame.data, frame.len, &cip))
+                sum += cip.stream_id + cip.dbc;
+            break;
+        case 0xfa:
+            if (ieee17221_decode_adp(frame.data, frame.len, &adp))
+                sum += adp.entity_guid + adp.available_index;
+            break;
+        case 0xfc:
+            if (ieee17221_decode_acmp(frame.data, frame.len, &acmp))
+                sum += acmp.controller_guid + acmp.sequence_id;
+            break;
+        }
+    }
+    elapsed = now_ns() - start;
+
+    printf("%-8s %-5s %10u %14.0f %10.1f %12.1f %8u %8u  (checksum %" G_GINT64_MODIFIER "x)\n",
+           bc->name, "core", count, count / (elapsed / 1e9), elapsed / count, 0.0, 0, 0, sum);
+}
+
+static void
+run_index_read(const char *filename)
+{
+    ieee1722_index_t *idx;
+    ieee1722_index_iter_t iter;
+    gchar *err_info = NULL;
+    guint keys_of[IEEE1722_INDEX_KINDS] = { 0, 0, 0 };
+    guint64 frames = 0;
+    guint32 first_frame, last_frame, first_nsecs, frame;
+    guint64 first_secs;
+    guint bad = 0;
+    double start, open_ns, walk_ns;
+    guint nkeys, i;
+
+    start = now_ns();
+    idx = ieee1722_index_open(filename, &err_info);
+    open_ns = now_ns() - start;
+    if (idx == NULL) {
+        fprintf(stderr, "%s\n", err_info);
+        g_free(err_info);
+        exit(1);
+    }
+
+    nkeys = ieee1722_index_keys(idx);
+    start = now_ns();
+    for (i = 0; i < nkeys; i++) {
+        guint8 kind;
+        guint64 key;
+        guint32 count, n = 0, prev = 0;
+
+        ieee1722_index_key(idx, i, &kind, &key, &count);
+        if (kind < IEEE1722_INDEX_KINDS)
+            keys_of[kind]++;
+        if (!ieee1722_index_lookup(idx, kind, key, &iter)) {
+            bad++;
+            continue;
+        }
+        while (ieee1722_index_next(&iter, &frame)) {
+            if (frame <= prev)
+                bad++;
+            prev = frame;
+            n++;
+        }
+        if (n != count)
+            bad++;
+        frames += n;
+    }
+    walk_ns = now_ns() - start;
+
+    ieee1722_index_capture(idx, &first_frame, &last_frame, &first_secs, &first_nsecs);
+    printf("index: frames %u-%u, %u streams, %u entities, %u subtypes, %" G_GINT64_MODIFIER "u entries\n",
+           first_frame, last_frame, keys_of[IEEE1722_INDEX_STREAM], keys_of[IEEE1722_INDEX_ENTITY],
+           keys_of[IEEE1722_INDEX_SUBTYPE], frames);
+    printf("index: opened in %.1f us, walked in %.2f ns/entry, %u errors\n",
+           open_ns / 1e3, frames ? walk_ns / frames : 0.0, bad);
+    ieee1722_index_close(idx);
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-n packets] [-c channels] [-b blocks] [-S streams]\n"
+            "          [-s 61883|aaf|adp|aecp|acmp|maap|crf|cvf|talker] [-o pref:value] [-f field] [-E] [-L n]\n"
+            "          [-M n] [-z stat] [-i n] [-d] [-u port|heur] [-R n] [-B n] [-I index]\n", prog);
+    exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+    dissector_table_t ethertype_table;
+    const char *only = NULL;
+    GSList *pref_args = NULL;
+    GSList *field_args = NULL;
+    GSList *stat_args = NULL;
+    const char *index_file = NULL;
+    gboolean expand_all = FALSE;
+    GSList *l;
+    guint32 count = 1000000;
+    guint i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:b:S:s:o:f:EL:M:R:B:z:i:du:I:h")) != -1) {
+        switch (opt) {
+        case 'n':
+            count = (guint32)strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            bench_channels = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            bench_blocks = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'S':
+            bench_streams = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            only = optarg;
+            break;
+        case 'o':
+            pref_args = g_slist_append(pref_args, optarg);
+            break;
+        case 'f':
+            field_args = g_slist_append(field_args, optarg);
+            break;
+        case 'E':
+            expand_all = TRUE;
+            break;
+        case 'L':
+            bench_loss = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'M':
+            bench_malformed = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'R':
+            bench_rate = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'B':
+            bench_burst = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            bench_decode_core = TRUE;
+            break;
+        case 'u':
+            if (strcmp(optarg, "port") == 0)
+                bench_udp = BENCH_UDP_PORT;
+            else if (strcmp(optarg, "heur") == 0)
+                bench_udp = BENCH_UDP_HEUR;
+            else
+                usage(argv[0]);
+            break;
+        case 'z':
+            stat_args = g_slist_append(stat_args, optarg);
+            break;
+        case 'i':
+            bench_show_info = (guint)strtoul(optarg, NULL, 0);
+            break;
+        case 'I':
+            index_file = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (count == 0 || bench_streams == 0 || bench_rate == 0 || bench_burst == 0 || bench_channels == 0 || bench_channels > 255 ||
+        32 + bench_blocks * bench_channels * 4 > BENCH_MAX_FRAME)
+        usage(argv[0]);
+
+    shim_init();
+    proto_register_1722();
+    proto_register_17221();
+    register_dissector("h264", dissect_bench_h264, -1);
+    proto_reg_handoff_1722();
+    proto_reg_handoff_17221();
+    register_tap_listener_avtpstreams();
+    register_tap_listener_avtpwav();
+    register_tap_listener_adpentities();
+    register_tap_listener_acmpsrt();
+    register_tap_listener_acmpgraph();
+    register_tap_listener_avtpindex();
+    register_tap_listener_avtpstate();
+    ethertype_table = find_dissector_table("ethertype");
+
+    for (l = pref_args; l != NULL; l = l->next) {
+        gchar *arg = l->data;
+        gchar *colon = strchr(arg, ':');
+
+        if (colon == NULL)
+            usage(argv[0]);
+        *colon = '\0';
+        if (!shim_set_pref(arg, colon + 1)) {
+            fprintf(stderr, "Invalid preference %s:%s\n", arg, colon + 1);
+            exit(1);
+        }
+    }
+    shim_init_prefs();
+    for (l = field_args; l != NULL; l = l->next) {
+        if (!shim_reference_field(l->data)) {
+            fprintf(stderr, "Unknown field %s\n", (gchar *)l->data);
+            exit(1);
+        }
+    }
+    if (expand_all)
+        shim_expand_all_subtrees();
+    for (l = stat_args; l != NULL; l = l->next) {
+        if (!shim_run_stat_cmd(l->data)) {
+            fprintf(stderr, "Invalid -z argument %s\n", (gchar *)l->data);
+            exit(1);
+        }
+    }
+
+    printf("%-8s %-5s %10s %14s %10s %12s %8s %8s\n",
+           "subtype", "tree", "packets", "packets/s", "ns/packet", "items/packet",
+           "errors", "expert");
+    for (i = 0; i < G_N_ELEMENTS(bench_cases); i++) {
+        if (only != NULL && strcmp(only, bench_cases[i].name) != 0)
+            continue;
+        if (bench_decode_core)
+            run_decode(&bench_cases[i], count);
+        run_case(&bench_cases[i], count, FALSE, ethertype_table);
+        run_case(&bench_cases[i], count, TRUE, ethertype_table);
+    }
+    if (bench_udp == BENCH_UDP_HEUR)
+        run_heur_reject(count);
+    if (index_file != NULL)
+        run_index_read(index_file);
+    return 0;
+}
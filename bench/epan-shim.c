@@ -0,0 +1,1269 @@
+/* epan-shim.c
+ * Minimal stand-in for the epan dissector API, used only by the standalone
+ * benchmark harness.
+ *
+ * Tree nodes are carved from a per-packet arena that is reset between
+ * packets, which is close to what ep_alloc() does inside Wireshark, so
+ * the harness measures dissector cost rather than malloc cost.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epan-shim.h"
+#include <epan/prefs.h>
+#include <epan/emem.h>
+#include <epan/expert.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+
+jmp_buf *shim_catch = NULL;
+guint32  shim_tree_items = 0;
+guint64  shim_exceptions = 0;
+guint64  shim_expert_infos = 0;
+
+/**********************************************************/
+/* Per-packet arena                                       */
+/**********************************************************/
+#define ARENA_SIZE  (4 * 1024 * 1024)
+
+static guint8 *arena = NULL;
+static gsize   arena_used = 0;
+
+static void *
+arena_alloc(gsize size)
+{
+    void *p;
+
+    size = (size + 7) & ~(gsize)7;
+    if (arena_used + size > ARENA_SIZE) {
+        fprintf(stderr, "epan-shim: per-packet arena exhausted\n");
+        abort();
+    }
+    p = arena + arena_used;
+    arena_used += size;
+    return p;
+}
+
+/**********************************************************/
+/* Capture-scoped memory                                  */
+/**********************************************************/
+#define SE_CHUNK_SIZE   (1024 * 1024)
+
+typedef struct _se_chunk {
+    struct _se_chunk *next;
+    gsize             used;
+    gsize             size;
+    guint8            data[1];
+} se_chunk_t;
+
+static se_chunk_t *se_chunks = NULL;
+
+void *
+se_alloc(size_t size)
+{
+    se_chunk_t *chunk = se_chunks;
+    void *p;
+
+    size = (size + 7) & ~(gsize)7;
+    if (chunk == NULL || chunk->used + size > chunk->size) {
+        gsize chunk_size = MAX(SE_CHUNK_SIZE, size);
+
+        chunk = g_malloc(sizeof(se_chunk_t) + chunk_size);
+        chunk->used = 0;
+        chunk->size = chunk_size;
+        chunk->next = se_chunks;
+        se_chunks = chunk;
+    }
+    p = chunk->data + chunk->used;
+    chunk->used += size;
+    return p;
+}
+
+void *
+se_alloc0(size_t size)
+{
+    return memset(se_alloc(size), 0, size);
+}
+
+static void
+se_free_all(void)
+{
+    while (se_chunks != NULL) {
+        se_chunk_t *next = se_chunks->next;
+
+        g_free(se_chunks);
+        se_chunks = next;
+    }
+}
+
+/**********************************************************/
+/* Per-frame protocol data                                */
+/**********************************************************/
+typedef struct _frame_proto_data {
+    struct _frame_proto_data *next;
+    int                       proto;
+    void                     *proto_data;
+} frame_proto_data;
+
+void
+p_add_proto_data(frame_data *fd, int proto, void *proto_data)
+{
+    frame_proto_data *p = se_alloc(sizeof(frame_proto_data));
+
+    p->proto = proto;
+    p->proto_data = proto_data;
+    p->next = fd->pfd;
+    fd->pfd = p;
+}
+
+void *
+p_get_proto_data(frame_data *fd, int proto)
+{
+    frame_proto_data *p;
+
+    for (p = fd->pfd; p != NULL; p = p->next) {
+        if (p->proto == proto)
+            return p->proto_data;
+    }
+    return NULL;
+}
+
+/**********************************************************/
+/* Expert info                                            */
+/**********************************************************/
+void
+expert_add_info_format(packet_info *pinfo, proto_item *pi, int group,
+                       int severity, const char *format, ...)
+{
+    gchar *text = arena_alloc(128);
+    va_list ap;
+
+    (void)pinfo;
+    (void)pi;
+    (void)group;
+    (void)severity;
+    va_start(ap, format);
+    g_vsnprintf(text, 128, format, ap);
+    va_end(ap);
+    shim_expert_infos++;
+}
+
+void *
+ep_alloc(size_t size)
+{
+    return arena_alloc(size);
+}
+
+void *
+ep_alloc0(size_t size)
+{
+    return memset(arena_alloc(size), 0, size);
+}
+
+void
+shim_packet_begin(void)
+{
+    arena_used = 0;
+    shim_tree_items = 0;
+}
+
+void
+shim_throw(int exc)
+{
+    shim_exceptions++;
+    if (shim_catch == NULL) {
+        fprintf(stderr, "epan-shim: uncaught exception %d\n", exc);
+        abort();
+    }
+    longjmp(*shim_catch, exc);
+}
+
+/**********************************************************/
+/* value_string                                           */
+/**********************************************************/
+const gchar *
+match_strval(guint32 val, const value_string *vs)
+{
+    for (; vs != NULL && vs->strptr != NULL; vs++) {
+        if (vs->value == val)
+            return vs->strptr;
+    }
+    return NULL;
+}
+
+const gchar *
+val_to_str(guint32 val, const value_string *vs, const char *fmt)
+{
+    const gchar *s = match_strval(val, vs);
+    gchar *buf;
+
+    if (s != NULL)
+        return s;
+    buf = arena_alloc(64);
+    g_snprintf(buf, 64, fmt, val);
+    return buf;
+}
+
+/**********************************************************/
+/* tvbuff                                                 */
+/**********************************************************/
+static void
+check_offset_length(const tvbuff_t *tvb, gint offset, gint length)
+{
+    if (offset < 0 || length < -1)
+        shim_throw(BoundsError);
+    if (length == -1)
+        length = tvb->length - offset;
+    if (offset + length > tvb->length) {
+        shim_throw(offset + length > tvb->reported_length ?
+                   ReportedBoundsError : BoundsError);
+    }
+}
+
+tvbuff_t *
+tvb_new_real_data(const guint8 *data, guint length, gint reported_length)
+{
+    tvbuff_t *tvb = arena_alloc(sizeof(tvbuff_t));
+
+    tvb->real_data = data;
+    tvb->length = length;
+    tvb->reported_length = reported_length < 0 ? (gint)length : reported_length;
+    return tvb;
+}
+
+tvbuff_t *
+tvb_new_subset(tvbuff_t *tvb, gint offset, gint length, gint reported_length)
+{
+    if (length == -1)
+        length = tvb->length - offset;
+    if (reported_length == -1)
+        reported_length = tvb->reported_length - offset;
+    check_offset_length(tvb, offset, length);
+    return tvb_new_real_data(tvb->real_data + offset, length, reported_length);
+}
+
+tvbuff_t *
+tvb_new_child_real_data(tvbuff_t *parent, const guint8 *data, guint length, gint reported_length)
+{
+    (void)parent;
+    return tvb_new_real_data(data, length, reported_length);
+}
+
+void
+add_new_data_source(packet_info *pinfo, tvbuff_t *tvb, const char *name)
+{
+    (void)pinfo;
+    (void)tvb;
+    (void)name;
+}
+
+guint
+tvb_length(const tvbuff_t *tvb)
+{
+    return tvb->length;
+}
+
+gint
+tvb_length_remaining(const tvbuff_t *tvb, gint offset)
+{
+    if (offset < 0 || offset > tvb->length)
+        return -1;
+    return tvb->length - offset;
+}
+
+guint
+tvb_reported_length(const tvbuff_t *tvb)
+{
+    return tvb->reported_length;
+}
+
+gint
+tvb_reported_length_remaining(const tvbuff_t *tvb, gint offset)
+{
+    if (offset < 0 || offset > tvb->reported_length)
+        return -1;
+    return tvb->reported_length - offset;
+}
+
+void
+tvb_ensure_bytes_exist(const tvbuff_t *tvb, gint offset, gint length)
+{
+    check_offset_length(tvb, offset, length);
+}
+
+const guint8 *
+tvb_get_ptr(tvbuff_t *tvb, gint offset, gint length)
+{
+    check_offset_length(tvb, offset, length);
+    return tvb->real_data + offset;
+}
+
+guint8
+tvb_get_guint8(tvbuff_t *tvb, gint offset)
+{
+    check_offset_length(tvb, offset, 1);
+    return tvb->real_data[offset];
+}
+
+static guint8 *
+tvb_copy_string(tvbuff_t *tvb, gint offset, gint length, void *(*alloc)(size_t))
+{
+    const guint8 *p = tvb_get_ptr(tvb, offset, length);
+    guint8 *str = alloc(length + 1);
+
+    memcpy(str, p, length);
+    str[length] = '\0';
+    return str;
+}
+
+guint8 *
+tvb_get_ephemeral_string(tvbuff_t *tvb, gint offset, gint length)
+{
+    return tvb_copy_string(tvb, offset, length, ep_alloc);
+}
+
+guint8 *
+tvb_get_seasonal_string(tvbuff_t *tvb, gint offset, gint length)
+{
+    return tvb_copy_string(tvb, offset, length, se_alloc);
+}
+
+guint16
+tvb_get_ntohs(tvbuff_t *tvb, gint offset)
+{
+    const guint8 *p = tvb_get_ptr(tvb, offset, 2);
+    return (guint16)(p[0] << 8 | p[1]);
+}
+
+guint32
+tvb_get_ntohl(tvbuff_t *tvb, gint offset)
+{
+    const guint8 *p = tvb_get_ptr(tvb, offset, 4);
+    return (guint32)p[0] << 24 | (guint32)p[1] << 16 | (guint32)p[2] << 8 | p[3];
+}
+
+guint64
+tvb_get_ntoh64(tvbuff_t *tvb, gint offset)
+{
+    return (guint64)tvb_get_ntohl(tvb, offset) << 32 | tvb_get_ntohl(tvb, offset + 4);
+}
+
+void *
+tvb_memcpy(tvbuff_t *tvb, void *target, gint offset, size_t length)
+{
+    return memcpy(target, tvb_get_ptr(tvb, offset, (gint)length), length);
+}
+
+void
+nstime_delta(nstime_t *delta, const nstime_t *b, const nstime_t *a)
+{
+    delta->secs = b->secs - a->secs;
+    delta->nsecs = b->nsecs - a->nsecs;
+    if (delta->nsecs < 0 && delta->secs > 0) {
+        delta->nsecs += 1000000000;
+        delta->secs--;
+    }
+    else if (delta->nsecs > 0 && delta->secs < 0) {
+        delta->nsecs -= 1000000000;
+        delta->secs++;
+    }
+}
+
+double
+nstime_to_msec(const nstime_t *nstime)
+{
+    return (double)nstime->secs * 1000 + (double)nstime->nsecs / 1000000;
+}
+
+/**********************************************************/
+/* Columns                                                */
+/**********************************************************/
+void
+col_set_str(column_info *cinfo, gint col, const gchar *str)
+{
+    if (cinfo != NULL)
+        cinfo->col_data[col] = str;
+}
+
+void
+col_add_fstr(column_info *cinfo, gint col, const gchar *format, ...)
+{
+    va_list ap;
+    gchar *text;
+
+    if (cinfo == NULL)
+        return;
+    text = ep_alloc(256);
+    va_start(ap, format);
+    g_vsnprintf(text, 256, format, ap);
+    va_end(ap);
+    cinfo->col_data[col] = text;
+}
+
+void
+col_append_fstr(column_info *cinfo, gint col, const gchar *format, ...)
+{
+    va_list ap;
+    gchar *text;
+    gsize len;
+
+    if (cinfo == NULL)
+        return;
+    text = ep_alloc(256);
+    g_strlcpy(text, cinfo->col_data[col] ? cinfo->col_data[col] : "", 256);
+    len = strlen(text);
+    va_start(ap, format);
+    g_vsnprintf(text + len, 256 - len, format, ap);
+    va_end(ap);
+    cinfo->col_data[col] = text;
+}
+
+void
+col_append_str(column_info *cinfo, gint col, const gchar *str)
+{
+    col_append_fstr(cinfo, col, "%s", str);
+}
+
+/**********************************************************/
+/* Field registry and protocol tree                       */
+/**********************************************************/
+static header_field_info **hf_table = NULL;
+static int hf_count = 0;
+static int ett_count = 0;
+static gboolean *referenced = NULL;
+
+gboolean *tree_is_expanded = NULL;
+
+int
+proto_register_protocol(const char *name, const char *short_name, const char *filter_name)
+{
+    static header_field_info proto_hfi[64];
+    static int num_protos = 0;
+    header_field_info *hfi = &proto_hfi[num_protos++];
+
+    (void)short_name;
+    hfi->name = name;
+    hfi->abbrev = filter_name;
+    hfi->type = FT_PROTOCOL;
+    hf_table = g_renew(header_field_info *, hf_table, hf_count + 1);
+    hf_table[hf_count] = hfi;
+    hfi->id = hf_count;
+    return hf_count++;
+}
+
+void
+proto_register_field_array(const int parent, hf_register_info *hf, const int num_records)
+{
+    int i;
+
+    hf_table = g_renew(header_field_info *, hf_table, hf_count + num_records);
+    for (i = 0; i < num_records; i++) {
+        header_field_info *hfi = &hf[i].hfinfo;
+
+        hfi->parent = parent;
+        hfi->id = hf_count;
+        hf_table[hf_count] = hfi;
+        *hf[i].p_id = hf_count++;
+    }
+}
+
+void
+proto_register_subtree_array(gint *const *indices, const int num_indices)
+{
+    int i;
+
+    tree_is_expanded = g_renew(gboolean, tree_is_expanded, ett_count + num_indices);
+    for (i = 0; i < num_indices; i++) {
+        tree_is_expanded[ett_count] = FALSE;
+        *indices[i] = ett_count++;
+    }
+}
+
+static proto_node *
+new_node(proto_tree *tree, int hf, gint start, gint length)
+{
+    proto_node *node = arena_alloc(sizeof(proto_node));
+
+    memset(node, 0, sizeof(*node));
+    node->hf = hf;
+    node->start = start;
+    node->length = length;
+    node->ett = -1;
+    node->parent = tree;
+    if (tree->last_child != NULL)
+        tree->last_child->next = node;
+    else
+        tree->first_child = node;
+    tree->last_child = node;
+    shim_tree_items++;
+    return node;
+}
+
+proto_tree *
+shim_tree_create_root(void)
+{
+    proto_node *root = arena_alloc(sizeof(proto_node));
+
+    memset(root, 0, sizeof(*root));
+    root->hf = -1;
+    root->ett = -1;
+    return root;
+}
+
+/* Fetch the value the way proto_tree_add_item() would, so item cost
+ * includes the bounds check and the byte loads. */
+static void
+fetch_value(tvbuff_t *tvb, header_field_info *hfi, gint start, gint length)
+{
+    volatile guint64 sink;
+
+    switch (hfi->type) {
+    case FT_BOOLEAN:
+    case FT_UINT8:
+    case FT_INT8:
+        sink = tvb_get_guint8(tvb, start);
+        break;
+    case FT_UINT16:
+    case FT_INT16:
+        sink = tvb_get_ntohs(tvb, start);
+        break;
+    case FT_UINT32:
+    case FT_INT32:
+        sink = tvb_get_ntohl(tvb, start);
+        break;
+    case FT_UINT64:
+    case FT_INT64:
+        sink = tvb_get_ntoh64(tvb, start);
+        break;
+    default:
+        tvb_ensure_bytes_exist(tvb, start, length);
+        sink = 0;
+        break;
+    }
+    (void)sink;
+}
+
+proto_item *
+proto_tree_add_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                    const gint start, gint length, const gboolean little_endian)
+{
+    header_field_info *hfi;
+
+    (void)little_endian;
+    if (tree == NULL)
+        return NULL;
+    hfi = hf_table[hfindex];
+    if (length == -1)
+        length = tvb_length_remaining(tvb, start);
+    if (hfi->type != FT_PROTOCOL)
+        fetch_value(tvb, hfi, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_text(proto_tree *tree, tvbuff_t *tvb, gint start,
+                    gint length, const char *format, ...)
+{
+    proto_item *pi;
+    va_list ap;
+    gchar *text;
+
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    pi = new_node(tree, -1, start, length);
+    text = arena_alloc(128);
+    va_start(ap, format);
+    g_vsnprintf(text, 128, format, ap);
+    va_end(ap);
+    return pi;
+}
+
+proto_item *
+proto_tree_add_uint(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                    gint start, gint length, guint32 value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_uint64(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                      gint start, gint length, guint64 value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_int64(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                     gint start, gint length, gint64 value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_float(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                     gint start, gint length, float value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_double(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                      gint start, gint length, double value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_ether(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                     gint start, gint length, const guint8 *value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_time(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                    gint start, gint length, nstime_t *value_ptr)
+{
+    (void)value_ptr;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+proto_item *
+proto_tree_add_boolean(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                       gint start, gint length, guint32 value)
+{
+    return proto_tree_add_uint(tree, hfindex, tvb, start, length, value);
+}
+
+proto_item *
+proto_tree_add_string(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                      gint start, gint length, const char *value)
+{
+    (void)value;
+    if (tree == NULL)
+        return NULL;
+    tvb_ensure_bytes_exist(tvb, start, length);
+    return new_node(tree, hfindex, start, length);
+}
+
+/* As in proto.c: the header item, one child per field and, for each
+ * boolean that is set, its name appended to the header text. */
+proto_item *
+proto_tree_add_bitmask(proto_tree *tree, tvbuff_t *tvb, guint offset,
+                       int hf_hdr, gint ett, const int **fields,
+                       gboolean little_endian)
+{
+    header_field_info *hfi;
+    proto_item *pi;
+    proto_tree *subtree;
+    guint32 value;
+    gint len;
+    gboolean first = TRUE;
+
+    if (tree == NULL)
+        return NULL;
+    hfi = hf_table[hf_hdr];
+    switch (hfi->type) {
+    case FT_UINT8:
+        len = 1;
+        value = tvb_get_guint8(tvb, offset);
+        break;
+    case FT_UINT16:
+        len = 2;
+        value = tvb_get_ntohs(tvb, offset);
+        break;
+    default:
+        len = 4;
+        value = tvb_get_ntohl(tvb, offset);
+        break;
+    }
+    pi = proto_tree_add_item(tree, hf_hdr, tvb, offset, len, little_endian);
+    subtree = proto_item_add_subtree(pi, ett);
+    for (; *fields; fields++) {
+        header_field_info *field = hf_table[**fields];
+
+        proto_tree_add_item(subtree, **fields, tvb, offset, len, little_endian);
+        if (field->type == FT_BOOLEAN && (value & field->bitmask)) {
+            proto_item_append_text(pi, "%s%s", first ? " (" : ", ", field->name);
+            first = FALSE;
+        }
+    }
+    if (!first)
+        proto_item_append_text(pi, ")");
+    return pi;
+}
+
+void
+proto_item_append_text(proto_item *pi, const char *format, ...)
+{
+    gchar *text;
+    va_list ap;
+
+    if (pi == NULL)
+        return;
+    text = arena_alloc(128);
+    va_start(ap, format);
+    g_vsnprintf(text, 128, format, ap);
+    va_end(ap);
+}
+
+gboolean
+proto_field_is_referenced(proto_tree *tree, int proto_id)
+{
+    if (tree == NULL)
+        return FALSE;
+    return referenced != NULL && referenced[proto_id];
+}
+
+gboolean
+shim_reference_field(const char *abbrev)
+{
+    int i;
+
+    for (i = 0; i < hf_count; i++) {
+        if (strcmp(hf_table[i]->abbrev, abbrev) == 0) {
+            if (referenced == NULL)
+                referenced = g_new0(gboolean, hf_count);
+            referenced[i] = TRUE;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+void
+shim_expand_all_subtrees(void)
+{
+    int i;
+
+    for (i = 0; i < ett_count; i++)
+        tree_is_expanded[i] = TRUE;
+}
+
+proto_tree *
+proto_item_add_subtree(proto_item *pi, const gint idx)
+{
+    if (pi == NULL)
+        return NULL;
+    pi->ett = idx;
+    return pi;
+}
+
+proto_item *
+proto_tree_get_parent(const proto_tree *tree)
+{
+    return (proto_item *)tree;
+}
+
+proto_item *
+proto_item_get_parent(const proto_item *pi)
+{
+    return pi ? pi->parent : NULL;
+}
+
+/**********************************************************/
+/* Dissector handles and tables                           */
+/**********************************************************/
+struct dissector_handle {
+    const char  *name;
+    dissector_t  dissector;
+    int          proto;
+};
+
+struct dissector_table {
+    const char *name;
+    GHashTable *entries;
+};
+
+static GHashTable *registered_dissectors = NULL;
+static GHashTable *dissector_tables = NULL;
+
+dissector_handle_t
+create_dissector_handle(dissector_t dissector, const int proto)
+{
+    struct dissector_handle *handle = g_new0(struct dissector_handle, 1);
+
+    handle->dissector = dissector;
+    handle->proto = proto;
+    return handle;
+}
+
+void
+register_dissector(const char *name, dissector_t dissector, const int proto)
+{
+    struct dissector_handle *handle = create_dissector_handle(dissector, proto);
+
+    handle->name = name;
+    g_hash_table_insert(registered_dissectors, (gpointer)name, handle);
+}
+
+dissector_handle_t
+find_dissector(const char *name)
+{
+    return g_hash_table_lookup(registered_dissectors, name);
+}
+
+int
+call_dissector(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    handle->dissector(tvb, pinfo, tree);
+    return tvb_length(tvb);
+}
+
+dissector_table_t
+register_dissector_table(const char *name, const char *ui_name,
+                         const enum ftenum type, const int base)
+{
+    struct dissector_table *table = g_new0(struct dissector_table, 1);
+
+    (void)ui_name;
+    (void)type;
+    (void)base;
+    table->name = name;
+    table->entries = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_hash_table_insert(dissector_tables, (gpointer)name, table);
+    return table;
+}
+
+dissector_table_t
+find_dissector_table(const char *name)
+{
+    return g_hash_table_lookup(dissector_tables, name);
+}
+
+void
+dissector_add_uint(const char *abbrev, const guint32 pattern, dissector_handle_t handle)
+{
+    dissector_table_t table = find_dissector_table(abbrev);
+
+    if (table == NULL) {
+        fprintf(stderr, "epan-shim: no dissector table \"%s\"\n", abbrev);
+        abort();
+    }
+    g_hash_table_insert(table->entries, GUINT_TO_POINTER(pattern), handle);
+}
+
+dissector_handle_t
+dissector_get_uint_handle(dissector_table_t sub_dissectors, const guint32 uint_val)
+{
+    return g_hash_table_lookup(sub_dissectors->entries, GUINT_TO_POINTER(uint_val));
+}
+
+gboolean
+dissector_try_uint(dissector_table_t sub_dissectors, const guint32 uint_val,
+                   tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    dissector_handle_t handle;
+
+    handle = g_hash_table_lookup(sub_dissectors->entries, GUINT_TO_POINTER(uint_val));
+    if (handle == NULL)
+        return FALSE;
+    call_dissector(handle, tvb, pinfo, tree);
+    return TRUE;
+}
+
+void
+dissector_delete_uint(const char *name, const guint32 pattern, dissector_handle_t handle)
+{
+    dissector_table_t table = find_dissector_table(name);
+
+    (void)handle;
+    if (table != NULL)
+        g_hash_table_remove(table->entries, GUINT_TO_POINTER(pattern));
+}
+
+/* Heuristic lists, tried in registration order until one accepts */
+static GHashTable *heur_lists = NULL;
+
+void
+register_heur_dissector_list(const char *name, heur_dissector_list_t *list)
+{
+    *list = NULL;
+    g_hash_table_insert(heur_lists, (gpointer)name, list);
+}
+
+void
+heur_dissector_add(const char *name, heur_dissector_t dissector, const int proto)
+{
+    heur_dissector_list_t *list = g_hash_table_lookup(heur_lists, name);
+
+    (void)proto;
+    if (list == NULL) {
+        fprintf(stderr, "epan-shim: no heuristic list \"%s\"\n", name);
+        abort();
+    }
+    *list = g_slist_append(*list, (gpointer)dissector);
+}
+
+gboolean
+dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
+                        packet_info *pinfo, proto_tree *tree)
+{
+    GSList *l;
+
+    for (l = sub_dissectors; l != NULL; l = l->next) {
+        if (((heur_dissector_t)l->data)(tvb, pinfo, tree))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/**********************************************************/
+/* Preferences                                            */
+/**********************************************************/
+typedef enum {
+    PREF_BOOL,
+    PREF_UINT,
+    PREF_ENUM
+} pref_type_t;
+
+typedef struct {
+    gchar            *name;
+    pref_type_t       type;
+    void             *var;
+    guint             base;
+    const enum_val_t *enumvals;
+} pref_t;
+
+struct pref_module {
+    const char  *name;
+    void       (*apply_cb)(void);
+};
+
+static GHashTable *prefs = NULL;
+static GSList *pref_modules = NULL;
+
+module_t *
+prefs_register_protocol(int id, void (*apply_cb)(void))
+{
+    module_t *module = g_new0(module_t, 1);
+
+    module->name = hf_table[id]->abbrev;
+    module->apply_cb = apply_cb;
+    pref_modules = g_slist_append(pref_modules, module);
+    return module;
+}
+
+static void
+register_pref(module_t *module, const char *name, pref_type_t type, void *var,
+              guint base, const enum_val_t *enumvals)
+{
+    pref_t *pref = g_new0(pref_t, 1);
+
+    pref->name = g_strdup_printf("%s.%s", module->name, name);
+    pref->type = type;
+    pref->var = var;
+    pref->base = base;
+    pref->enumvals = enumvals;
+    g_hash_table_insert(prefs, pref->name, pref);
+}
+
+void
+prefs_register_bool_preference(module_t *module, const char *name,
+    const char *title, const char *description, gboolean *var)
+{
+    (void)title;
+    (void)description;
+    register_pref(module, name, PREF_BOOL, var, 0, NULL);
+}
+
+void
+prefs_register_uint_preference(module_t *module, const char *name,
+    const char *title, const char *description, guint base, guint *var)
+{
+    (void)title;
+    (void)description;
+    register_pref(module, name, PREF_UINT, var, base, NULL);
+}
+
+void
+prefs_register_enum_preference(module_t *module, const char *name,
+    const char *title, const char *description, gint *var,
+    const enum_val_t *enumvals, gboolean radio_buttons)
+{
+    (void)title;
+    (void)description;
+    (void)radio_buttons;
+    register_pref(module, name, PREF_ENUM, var, 0, enumvals);
+}
+
+/* Old names are only swallowed when read from a preferences file */
+void
+prefs_register_obsolete_preference(module_t *module, const char *name)
+{
+    (void)module;
+    (void)name;
+}
+
+gboolean
+shim_set_pref(const char *name, const char *value)
+{
+    pref_t *pref = g_hash_table_lookup(prefs, name);
+    const enum_val_t *ev;
+
+    if (pref == NULL)
+        return FALSE;
+    switch (pref->type) {
+    case PREF_BOOL:
+        *(gboolean *)pref->var = g_ascii_strcasecmp(value, "TRUE") == 0;
+        return TRUE;
+    case PREF_UINT:
+        *(guint *)pref->var = (guint)strtoul(value, NULL, pref->base);
+        return TRUE;
+    case PREF_ENUM:
+        for (ev = pref->enumvals; ev->name != NULL; ev++) {
+            if (g_ascii_strcasecmp(value, ev->name) == 0) {
+                *(gint *)pref->var = ev->value;
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+    return FALSE;
+}
+
+/* Run every module's apply callback, as prefs_apply_all() does */
+void
+shim_init_prefs(void)
+{
+    GSList *l;
+
+    for (l = pref_modules; l != NULL; l = l->next) {
+        module_t *module = l->data;
+
+        if (module->apply_cb != NULL)
+            module->apply_cb();
+    }
+}
+
+/**********************************************************/
+/* Taps and -z statistics                                 */
+/**********************************************************/
+typedef struct _tap_listener {
+    int            tap_id;
+    void          *tapdata;
+    tap_reset_cb   reset;
+    tap_packet_cb  packet;
+    tap_draw_cb    draw;
+} tap_listener_t;
+
+typedef struct _stat_cmd {
+    const char  *cmd;
+    void       (*func)(const char *arg, void *userdata);
+    void        *userdata;
+} stat_cmd_t;
+
+static GSList *tap_names = NULL;
+static GSList *tap_listeners = NULL;
+static GSList *stat_cmds = NULL;
+
+int
+register_tap(const char *name)
+{
+    tap_names = g_slist_append(tap_names, (gpointer)name);
+    return g_slist_length(tap_names);
+}
+
+static int
+find_tap_id(const char *name)
+{
+    GSList *l;
+    int id = 1;
+
+    for (l = tap_names; l != NULL; l = l->next, id++) {
+        if (strcmp(l->data, name) == 0)
+            return id;
+    }
+    return 0;
+}
+
+void
+tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data)
+{
+    GSList *l;
+
+    for (l = tap_listeners; l != NULL; l = l->next) {
+        tap_listener_t *tl = l->data;
+
+        if (tl->tap_id == tap_id)
+            tl->packet(tl->tapdata, pinfo, NULL, tap_specific_data);
+    }
+}
+
+GString *
+register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
+                      guint flags, tap_reset_cb tap_reset,
+                      tap_packet_cb tap_packet, tap_draw_cb tap_draw)
+{
+    tap_listener_t *tl;
+    GString *error_string;
+
+    (void)flags;
+    if (find_tap_id(tapname) == 0) {
+        error_string = g_string_new("");
+        g_string_printf(error_string, "Tap %s not found", tapname);
+        return error_string;
+    }
+    if (fstring != NULL && *fstring != '\0') {
+        error_string = g_string_new("");
+        g_string_printf(error_string, "Filters are not supported by the benchmark harness");
+        return error_string;
+    }
+    tl = g_new0(tap_listener_t, 1);
+    tl->tap_id = find_tap_id(tapname);
+    tl->tapdata = tapdata;
+    tl->reset = tap_reset;
+    tl->packet = tap_packet;
+    tl->draw = tap_draw;
+    tap_listeners = g_slist_append(tap_listeners, tl);
+    return NULL;
+}
+
+void
+remove_tap_listener(void *tapdata)
+{
+    GSList *l;
+
+    for (l = tap_listeners; l != NULL; l = l->next) {
+        tap_listener_t *tl = l->data;
+
+        if (tl->tapdata == tapdata) {
+            tap_listeners = g_slist_remove(tap_listeners, tl);
+            g_free(tl);
+            return;
+        }
+    }
+}
+
+void
+shim_reset_tap_listeners(void)
+{
+    GSList *l;
+
+    for (l = tap_listeners; l != NULL; l = l->next) {
+        tap_listener_t *tl = l->data;
+
+        if (tl->reset != NULL)
+            tl->reset(tl->tapdata);
+    }
+}
+
+void
+shim_draw_tap_listeners(void)
+{
+    GSList *l;
+
+    for (l = tap_listeners; l != NULL; l = l->next) {
+        tap_listener_t *tl = l->data;
+
+        if (tl->draw != NULL)
+            tl->draw(tl->tapdata);
+    }
+}
+
+void
+register_stat_cmd_arg(const char *cmd, void (*func)(const char *arg, void *userdata),
+                      void *userdata)
+{
+    stat_cmd_t *sc = g_new0(stat_cmd_t, 1);
+
+    sc->cmd = cmd;
+    sc->func = func;
+    sc->userdata = userdata;
+    stat_cmds = g_slist_append(stat_cmds, sc);
+}
+
+gboolean
+shim_run_stat_cmd(const char *arg)
+{
+    GSList *l;
+
+    for (l = stat_cmds; l != NULL; l = l->next) {
+        stat_cmd_t *sc = l->data;
+
+        if (g_str_has_prefix(arg, sc->cmd)) {
+            sc->func(arg, sc->userdata);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**********************************************************/
+/* Start-up                                               */
+/**********************************************************/
+heur_dissector_list_t shim_udp_heur_list = NULL;
+
+static GSList *init_routines = NULL;
+
+void
+register_init_routine(void (*func)(void))
+{
+    init_routines = g_slist_append(init_routines, (gpointer)func);
+}
+
+/* Start of a new capture, as init_dissection() does */
+void
+shim_init_dissection(void)
+{
+    GSList *l;
+
+    se_free_all();
+    for (l = init_routines; l != NULL; l = l->next)
+        ((void (*)(void))l->data)();
+}
+
+void
+shim_init(void)
+{
+    arena = g_malloc(ARENA_SIZE);
+    registered_dissectors = g_hash_table_new(g_str_hash, g_str_equal);
+    dissector_tables = g_hash_table_new(g_str_hash, g_str_equal);
+    prefs = g_hash_table_new(g_str_hash, g_str_equal);
+    heur_lists = g_hash_table_new(g_str_hash, g_str_equal);
+
+    /* Tables that the AVB dissectors register into */
+    register_dissector_table("ethertype", "Ethertype", FT_UINT16, BASE_HEX);
+    register_dissector_table("udp.port", "UDP port", FT_UINT16, BASE_DEC);
+    register_heur_dissector_list("udp", &shim_udp_heur_list);
+}
@@ -0,0 +1,44 @@
+/* epan-shim.h
+ * Harness-side controls for the minimal epan stand-in.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef __EPAN_SHIM_H__
+#define __EPAN_SHIM_H__
+
+#include <setjmp.h>
+
+#include <epan/packet.h>
+
+/* Where shim_throw() unwinds to; NULL aborts the harness */
+extern jmp_buf *shim_catch;
+
+/* Number of tree items created since the last shim_packet_begin() */
+extern guint32 shim_tree_items;
+
+/* Number of bounds exceptions raised since start-up */
+extern guint64 shim_exceptions;
+
+/* Number of expert info entries raised since start-up */
+extern guint64 shim_expert_infos;
+
+/* The "udp" heuristic list, as the UDP dissector would own it */
+extern heur_dissector_list_t shim_udp_heur_list;
+
+extern void shim_init(void);
+extern void shim_init_prefs(void);
+extern void shim_init_dissection(void);
+extern gboolean shim_set_pref(const char *name, const char *value);
+extern gboolean shim_reference_field(const char *abbrev);
+extern void shim_expand_all_subtrees(void);
+extern gboolean shim_run_stat_cmd(const char *arg);
+extern void shim_reset_tap_listeners(void);
+extern void shim_draw_tap_listeners(void);
+extern void shim_packet_begin(void);
+extern proto_tree *shim_tree_create_root(void);
+
+#endif /* __EPAN_SHIM_H__ */
@@ -0,0 +1,24 @@
+/* emem.h
+ * Packet- (ep_) and capture-scoped (se_) allocation for the benchmark harness epan stand-in.
+ * Everything is released when the harness re-runs the init routines.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef __BENCH_EPAN_EMEM_H__
+#define __BENCH_EPAN_EMEM_H__
+
+#include <glib.h>
+
+/* Packet-scoped */
+extern void *ep_alloc(size_t size);
+extern void *ep_alloc0(size_t size);
+
+/* Capture-scoped */
+extern void *se_alloc(size_t size);
+extern void *se_alloc0(size_t size);
+
+#endif /* __BENCH_EPAN_EMEM_H__ */
@@ -0,0 +1,12 @@
+/* etypes.h
+ * Ethernet type values used by the benchmark harness epan stand-in.
+ */
+
+#ifndef __BENCH_EPAN_ETYPES_H__
+#define __BENCH_EPAN_ETYPES_H__
+
+#ifndef ETHERTYPE_AVBTP
+#define ETHERTYPE_AVBTP     0x22F0
+#endif
+
+#endif /* __BENCH_EPAN_ETYPES_H__ */
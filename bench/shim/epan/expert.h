@@ -0,0 +1,37 @@
+/* expert.h
+ * Expert info for the benchmark harness epan stand-in; entries are only
+ * counted.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef __BENCH_EPAN_EXPERT_H__
+#define __BENCH_EPAN_EXPERT_H__
+
+#include <epan/packet.h>
+
+#define PI_SEVERITY_MASK    0x00F00000
+#define PI_CHAT             0x00200000
+#define PI_NOTE             0x00400000
+#define PI_WARN             0x00600000
+#define PI_ERROR            0x00800000
+
+#define PI_GROUP_MASK       0xFF000000
+#define PI_CHECKSUM         0x01000000
+#define PI_SEQUENCE         0x02000000
+#define PI_RESPONSE_CODE    0x03000000
+#define PI_REQUEST_CODE     0x04000000
+#define PI_UNDECODED        0x05000000
+#define PI_REASSEMBLE       0x06000000
+#define PI_MALFORMED        0x07000000
+#define PI_DEBUG            0x08000000
+#define PI_PROTOCOL         0x09000000
+#define PI_SECURITY         0x0a000000
+
+extern void expert_add_info_format(packet_info *pinfo, proto_item *pi, int group,
+                                   int severity, const char *format, ...) G_GNUC_PRINTF(5,6);
+
+#endif /* __BENCH_EPAN_EXPERT_H__ */
@@ -0,0 +1,284 @@
+/* packet.h
+ * Minimal stand-in for the epan dissector API, used only by the standalone
+ * benchmark harness.  It mirrors the Wireshark 1.6 signatures that
+ * packet-ieee1722.c and packet-ieee17221.c rely on, with just enough
+ * behaviour (bounds checks, tree nodes, dissector tables) for the
+ * per-packet cost to be representative.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __BENCH_EPAN_PACKET_H__
+#define __BENCH_EPAN_PACKET_H__
+
+#include <glib.h>
+#include <time.h>
+#include <epan/pint.h>
+
+#ifndef _U_
+#define _U_ __attribute__((unused))
+#endif
+
+/* Field types and display bases */
+enum ftenum {
+    FT_NONE,
+    FT_PROTOCOL,
+    FT_BOOLEAN,
+    FT_UINT8,
+    FT_UINT16,
+    FT_UINT24,
+    FT_UINT32,
+    FT_UINT64,
+    FT_INT8,
+    FT_INT16,
+    FT_INT24,
+    FT_INT32,
+    FT_INT64,
+    FT_FLOAT,
+    FT_DOUBLE,
+    FT_ABSOLUTE_TIME,
+    FT_RELATIVE_TIME,
+    FT_STRING,
+    FT_STRINGZ,
+    FT_ETHER,
+    FT_BYTES,
+    FT_FRAMENUM
+};
+
+enum {
+    BASE_NONE,
+    BASE_DEC,
+    BASE_HEX,
+    BASE_OCT,
+    BASE_DEC_HEX,
+    BASE_HEX_DEC,
+    BASE_CUSTOM
+};
+
+typedef struct _value_string {
+    guint32      value;
+    const gchar *strptr;
+} value_string;
+
+#define VALS(x) (const struct _value_string*)(x)
+
+extern const gchar *match_strval(guint32 val, const value_string *vs);
+extern const gchar *val_to_str(guint32 val, const value_string *vs, const char *fmt);
+
+typedef struct _header_field_info {
+    const char   *name;
+    const char   *abbrev;
+    enum ftenum   type;
+    int           display;
+    const void   *strings;
+    guint32       bitmask;
+    const char   *blurb;
+    int           id;
+    int           parent;
+    int           ref_type;
+    int           bitshift;
+    void         *same_name_next;
+    void         *same_name_prev;
+} header_field_info;
+
+#define HFILL 0, 0, 0, 0, NULL, NULL
+
+typedef struct hf_register_info {
+    int               *p_id;
+    header_field_info  hfinfo;
+} hf_register_info;
+
+#define array_length(x) (sizeof x / sizeof x[0])
+
+/* Exceptions: bounds violations unwind to the harness via longjmp */
+#define BoundsError         1
+#define ReportedBoundsError 2
+extern void shim_throw(int exc);
+
+/* tvbuff */
+typedef struct tvbuff {
+    const guint8 *real_data;
+    gint          length;
+    gint          reported_length;
+} tvbuff_t;
+
+extern tvbuff_t *tvb_new_real_data(const guint8 *data, guint length, gint reported_length);
+extern tvbuff_t *tvb_new_subset(tvbuff_t *tvb, gint offset, gint length, gint reported_length);
+extern tvbuff_t *tvb_new_child_real_data(tvbuff_t *parent, const guint8 *data, guint length,
+                                         gint reported_length);
+extern guint  tvb_length(const tvbuff_t *tvb);
+extern gint   tvb_length_remaining(const tvbuff_t *tvb, gint offset);
+extern guint  tvb_reported_length(const tvbuff_t *tvb);
+extern gint   tvb_reported_length_remaining(const tvbuff_t *tvb, gint offset);
+extern void   tvb_ensure_bytes_exist(const tvbuff_t *tvb, gint offset, gint length);
+extern const guint8 *tvb_get_ptr(tvbuff_t *tvb, gint offset, gint length);
+extern guint8  tvb_get_guint8(tvbuff_t *tvb, gint offset);
+extern guint8 *tvb_get_ephemeral_string(tvbuff_t *tvb, gint offset, gint length);
+extern guint8 *tvb_get_seasonal_string(tvbuff_t *tvb, gint offset, gint length);
+extern guint16 tvb_get_ntohs(tvbuff_t *tvb, gint offset);
+extern guint32 tvb_get_ntohl(tvbuff_t *tvb, gint offset);
+extern guint64 tvb_get_ntoh64(tvbuff_t *tvb, gint offset);
+extern void   *tvb_memcpy(tvbuff_t *tvb, void *target, gint offset, size_t length);
+
+/* Frame and packet info */
+typedef struct {
+    time_t secs;
+    int    nsecs;
+} nstime_t;
+
+extern void   nstime_delta(nstime_t *delta, const nstime_t *b, const nstime_t *a);
+extern double nstime_to_msec(const nstime_t *nstime);
+
+typedef struct _frame_data {
+    guint32   num;
+    guint32   pkt_len;
+    nstime_t  abs_ts;
+    void     *pfd;
+    struct {
+        unsigned int visited : 1;
+    } flags;
+} frame_data;
+
+extern void  p_add_proto_data(frame_data *fd, int proto, void *proto_data);
+extern void *p_get_proto_data(frame_data *fd, int proto);
+
+enum {
+    COL_PROTOCOL,
+    COL_INFO,
+    NUM_COL_FMTS
+};
+
+typedef struct _column_info {
+    const gchar *col_data[NUM_COL_FMTS];
+} column_info;
+
+typedef enum {
+    AT_NONE,
+    AT_ETHER
+} address_type;
+
+typedef struct _address {
+    address_type type;
+    int          len;
+    const void  *data;
+} address;
+
+typedef struct _packet_info {
+    const char  *current_proto;
+    column_info *cinfo;
+    frame_data  *fd;
+    address      dl_src;
+} packet_info;
+
+extern void add_new_data_source(packet_info *pinfo, tvbuff_t *tvb, const char *name);
+
+typedef struct _epan_dissect_t epan_dissect_t;
+
+extern void col_set_str(column_info *cinfo, gint col, const gchar *str);
+extern void col_add_fstr(column_info *cinfo, gint col, const gchar *format, ...) G_GNUC_PRINTF(3,4);
+extern void col_append_fstr(column_info *cinfo, gint col, const gchar *format, ...) G_GNUC_PRINTF(3,4);
+extern void col_append_str(column_info *cinfo, gint col, const gchar *str);
+
+/* Protocol tree.  As in Wireshark, items and trees are the same node. */
+typedef struct _proto_node {
+    struct _proto_node *first_child;
+    struct _proto_node *last_child;
+    struct _proto_node *next;
+    struct _proto_node *parent;
+    int                 hf;
+    gint                start;
+    gint                length;
+    gint                ett;
+    gboolean            generated;
+} proto_node;
+
+typedef proto_node proto_tree;
+typedef proto_node proto_item;
+
+extern proto_item *proto_tree_add_item(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                       const gint start, gint length, const gboolean little_endian);
+extern proto_item *proto_tree_add_text(proto_tree *tree, tvbuff_t *tvb, gint start,
+                                       gint length, const char *format, ...) G_GNUC_PRINTF(5,6);
+extern proto_tree *proto_item_add_subtree(proto_item *pi, const gint idx);
+extern proto_item *proto_tree_get_parent(const proto_tree *tree);
+extern proto_item *proto_item_get_parent(const proto_item *pi);
+extern proto_item *proto_tree_add_uint(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                       gint start, gint length, guint32 value);
+extern proto_item *proto_tree_add_int64(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                        gint start, gint length, gint64 value);
+extern proto_item *proto_tree_add_uint64(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                         gint start, gint length, guint64 value);
+extern proto_item *proto_tree_add_float(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                        gint start, gint length, float value);
+extern proto_item *proto_tree_add_double(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                          gint start, gint length, double value);
+extern proto_item *proto_tree_add_ether(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                        gint start, gint length, const guint8 *value);
+extern proto_item *proto_tree_add_time(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                       gint start, gint length, nstime_t *value_ptr);
+extern proto_item *proto_tree_add_boolean(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                          gint start, gint length, guint32 value);
+extern proto_item *proto_tree_add_string(proto_tree *tree, int hfindex, tvbuff_t *tvb,
+                                         gint start, gint length, const char *value);
+extern proto_item *proto_tree_add_bitmask(proto_tree *tree, tvbuff_t *tvb, guint offset,
+                                          int hf_hdr, gint ett, const int **fields,
+                                          gboolean little_endian);
+extern void proto_item_append_text(proto_item *pi, const char *format, ...) G_GNUC_PRINTF(2,3);
+extern gboolean proto_field_is_referenced(proto_tree *tree, int proto_id);
+
+#define PROTO_ITEM_SET_GENERATED(pi) do { if (pi) (pi)->generated = TRUE; } while (0)
+
+/* Expansion state of each registered subtree, indexed by ett */
+extern gboolean *tree_is_expanded;
+
+extern int  proto_register_protocol(const char *name, const char *short_name, const char *filter_name);
+extern void proto_register_field_array(const int parent, hf_register_info *hf, const int num_records);
+extern void proto_register_subtree_array(gint *const *indices, const int num_indices);
+
+/* Dissector handles and tables */
+typedef void (*dissector_t)(tvbuff_t *, packet_info *, proto_tree *);
+typedef struct dissector_handle *dissector_handle_t;
+typedef struct dissector_table *dissector_table_t;
+
+extern dissector_handle_t create_dissector_handle(dissector_t dissector, const int proto);
+extern void register_dissector(const char *name, dissector_t dissector, const int proto);
+extern dissector_handle_t find_dissector(const char *name);
+extern int call_dissector(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree);
+
+extern dissector_table_t register_dissector_table(const char *name, const char *ui_name,
+                                                  const enum ftenum type, const int base);
+extern dissector_table_t find_dissector_table(const char *name);
+extern void dissector_add_uint(const char *abbrev, const guint32 pattern, dissector_handle_t handle);
+extern dissector_handle_t dissector_get_uint_handle(dissector_table_t sub_dissectors, const guint32 uint_val);
+extern gboolean dissector_try_uint(dissector_table_t sub_dissectors, const guint32 uint_val,
+                                   tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree);
+extern void dissector_delete_uint(const char *name, const guint32 pattern, dissector_handle_t handle);
+
+/* Heuristic dissectors */
+typedef gboolean (*heur_dissector_t)(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree);
+typedef GSList *heur_dissector_list_t;
+
+extern void register_heur_dissector_list(const char *name, heur_dissector_list_t *list);
+extern void heur_dissector_add(const char *name, heur_dissector_t dissector, const int proto);
+extern gboolean dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
+                                        packet_info *pinfo, proto_tree *tree);
+
+extern void register_init_routine(void (*func)(void));
+
+#endif /* __BENCH_EPAN_PACKET_H__ */
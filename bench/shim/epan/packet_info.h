@@ -0,0 +1,5 @@
+/* packet_info.h
+ * The benchmark harness epan stand-in declares packet_info in packet.h.
+ */
+
+#include <epan/packet.h>
@@ -0,0 +1,20 @@
+/* pint.h
+ * Unaligned big-endian loads, as in the real epan/pint.h which
+ * epan/packet.h pulls in.
+ */
+
+#ifndef __BENCH_EPAN_PINT_H__
+#define __BENCH_EPAN_PINT_H__
+
+#define pntohs(p)   ((guint16)                       \
+                     ((guint16)*((const guint8 *)(p)+0)<<8|  \
+                      (guint16)*((const guint8 *)(p)+1)<<0))
+
+#define pntohl(p)   ((guint32)*((const guint8 *)(p)+0)<<24|  \
+                     (guint32)*((const guint8 *)(p)+1)<<16|  \
+                     (guint32)*((const guint8 *)(p)+2)<<8|   \
+                     (guint32)*((const guint8 *)(p)+3)<<0)
+
+#define pntoh64(p)  ((guint64)pntohl(p)<<32 | (guint64)pntohl((const guint8 *)(p)+4))
+
+#endif /* __BENCH_EPAN_PINT_H__ */
@@ -0,0 +1,34 @@
+/* prefs.h
+ * Preference registration for the benchmark harness epan stand-in.
+ * Values are set from the harness command line with -o name:value.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef __BENCH_EPAN_PREFS_H__
+#define __BENCH_EPAN_PREFS_H__
+
+#include <epan/packet.h>
+
+typedef struct {
+    const char *name;
+    const char *description;
+    gint        value;
+} enum_val_t;
+
+typedef struct pref_module module_t;
+
+extern module_t *prefs_register_protocol(int id, void (*apply_cb)(void));
+extern void prefs_register_bool_preference(module_t *module, const char *name,
+    const char *title, const char *description, gboolean *var);
+extern void prefs_register_uint_preference(module_t *module, const char *name,
+    const char *title, const char *description, guint base, guint *var);
+extern void prefs_register_enum_preference(module_t *module, const char *name,
+    const char *title, const char *description, gint *var,
+    const enum_val_t *enumvals, gboolean radio_buttons);
+extern void prefs_register_obsolete_preference(module_t *module, const char *name);
+
+#endif /* __BENCH_EPAN_PREFS_H__ */
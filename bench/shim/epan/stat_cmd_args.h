@@ -0,0 +1,16 @@
+/* stat_cmd_args.h
+ * "-z" statistics registration for the benchmark harness epan stand-in.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef __BENCH_EPAN_STAT_CMD_ARGS_H__
+#define __BENCH_EPAN_STAT_CMD_ARGS_H__
+
+extern void register_stat_cmd_arg(const char *cmd, void (*func)(const char *arg, void *userdata),
+                                  void *userdata);
+
+#endif /* __BENCH_EPAN_STAT_CMD_ARGS_H__ */
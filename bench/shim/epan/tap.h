@@ -0,0 +1,27 @@
+/* tap.h
+ * Taps for the benchmark harness epan stand-in.  Queued packets are handed
+ * to the listeners straight away; display filters are not supported.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef __BENCH_EPAN_TAP_H__
+#define __BENCH_EPAN_TAP_H__
+
+#include <epan/packet.h>
+
+typedef void (*tap_reset_cb)(void *tapdata);
+typedef int  (*tap_packet_cb)(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data);
+typedef void (*tap_draw_cb)(void *tapdata);
+
+extern int register_tap(const char *name);
+extern void tap_queue_packet(int tap_id, packet_info *pinfo, const void *tap_specific_data);
+extern GString *register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
+                                      guint flags, tap_reset_cb tap_reset,
+                                      tap_packet_cb tap_packet, tap_draw_cb tap_draw);
+extern void remove_tap_listener(void *tapdata);
+
+#endif /* __BENCH_EPAN_TAP_H__ */
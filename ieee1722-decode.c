@@ -0,0 +1,134 @@
+/* ieee1722-decode.c
+ * Tree-independent decoding of IEEE 1722 (AVB-TP) and IEEE 1722.1
+ * (AVDECC) PDUs into plain structs
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <string.h>
+
+#include <epan/pint.h>
+
+#include "ieee1722-decode.h"
+
+gboolean ieee1722_decode_common(const guint8 *data, guint len, ieee1722_common_hdr_t *hdr)
+{
+    if (len < IEEE_1722_COMMON_HEADER_SIZE)
+        return FALSE;
+
+    hdr->cd = (data[IEEE_1722_CD_OFFSET] & IEEE_1722_CD_MASK) >> 7;
+    hdr->subtype = data[IEEE_1722_CD_OFFSET];
+    hdr->sv = (data[IEEE_1722_VERSION_OFFSET] & IEEE_1722_SV_MASK) >> 7;
+    hdr->version = (data[IEEE_1722_VERSION_OFFSET] & IEEE_1722_VER_MASK) >> 4;
+    return TRUE;
+}
+
+gboolean ieee1722_decode_61883(const guint8 *data, guint len, ieee1722_61883_hdr_t *hdr)
+{
+    guint8 octet;
+
+    if (len < IEEE_1722_DATA_OFFSET)
+        return FALSE;
+
+    ieee1722_decode_common(data, len, &hdr->common);
+
+    octet = data[IEEE_1722_VERSION_OFFSET];
+    hdr->mr = (octet & IEEE_1722_MR_MASK) >> 3;
+    hdr->gv = (octet & IEEE_1722_GV_MASK) >> 1;
+    hdr->tv = octet & IEEE_1722_TV_MASK;
+    hdr->seqnum = data[IEEE_1722_SEQ_NUM_OFFSET];
+    hdr->tu = data[IEEE_1722_TU_FIELD_OFFSET] & IEEE_1722_TU_MASK;
+    hdr->stream_id = pntoh64(data + IEEE_1722_STREAM_ID_OFFSET);
+    hdr->avtp_timestamp = pntohl(data + IEEE_1722_TIMESTAMP_OFFSET);
+    hdr->gateway_info = pntohl(data + IEEE_1722_GW_INFO_OFFSET);
+    hdr->packet_data_length = pntohs(data + IEEE_1722_PKT_DATA_LENGTH_OFFSET);
+
+    octet = data[IEEE_1722_TAG_OFFSET];
+    hdr->tag = (octet & IEEE_1722_TAG_MASK) >> 6;
+    hdr->channel = octet & IEEE_1722_CHANNEL_MASK;
+    octet = data[IEEE_1722_TCODE_OFFSET];
+    hdr->tcode = (octet & IEEE_1722_TCODE_MASK) >> 4;
+    hdr->sy = octet & IEEE_1722_SY_MASK;
+
+    hdr->sid = data[IEEE_1722_SID_OFFSET] & IEEE_1722_SID_MASK;
+    hdr->dbs = data[IEEE_1722_DBS_OFFSET];
+    octet = data[IEEE_1722_FN_OFFSET];
+    hdr->fn = (octet & IEEE_1722_FN_MASK) >> 6;
+    hdr->qpc = (octet & IEEE_1722_QPC_MASK) >> 3;
+    hdr->sph = (octet & IEEE_1722_SPH_MASK) >> 2;
+    hdr->dbc = data[IEEE_1722_DBC_OFFSET];
+    hdr->fmt = data[IEEE_1722_FMT_OFFSET] & IEEE_1722_FMT_MASK;
+    hdr->fdf = data[IEEE_1722_FDF_OFFSET];
+    hdr->syt = pntohs(data + IEEE_1722_SYT_OFFSET);
+    return TRUE;
+}
+
+gboolean ieee17221_decode_adp(const guint8 *data, guint len, ieee17221_adp_pdu_t *pdu)
+{
+    if (len < ADP_PDU_SIZE)
+        return FALSE;
+
+    pdu->message_type = data[ADP_VERSION_OFFSET] & ADP_MSG_TYPE_MASK;
+    pdu->valid_time = (data[ADP_VALID_TIME_OFFSET] & ADP_VALID_TIME_MASK) >> 3;
+    pdu->cd_length = pntohs(data + ADP_VALID_TIME_OFFSET) & ADP_CD_LENGTH_MASK;
+    pdu->entity_guid = pntoh64(data + ADP_ENTITY_GUID_OFFSET);
+    pdu->vendor_id = pntohl(data + ADP_VENDOR_ID_OFFSET);
+    pdu->model_id = pntohl(data + ADP_MODEL_ID_OFFSET);
+    pdu->entity_cap = pntohl(data + ADP_ENTITY_CAP_OFFSET);
+    pdu->talker_stream_sources = pntohs(data + ADP_TALKER_STREAM_SRCS_OFFSET);
+    pdu->talker_cap = pntohs(data + ADP_TALKER_CAP_OFFSET);
+    pdu->listener_stream_sinks = pntohs(data + ADP_LISTENER_STREAM_SINKS_OFFSET);
+    pdu->listener_cap = pntohs(data + ADP_LISTENER_CAP_OFFSET);
+    pdu->controller_cap = pntohl(data + ADP_CONTROLLER_CAP_OFFSET);
+    pdu->available_index = pntohl(data + ADP_AVAIL_INDEX_OFFSET);
+    pdu->as_grandmaster_id = pntoh64(data + ADP_AS_GM_ID_OFFSET);
+    pdu->default_audio_format = pntohs(data + ADP_DEF_AUDIO_FORMAT_OFFSET);
+    pdu->channel_formats = pntohs(data + ADP_CHAN_FORMAT_OFFSET);
+    pdu->default_video_format = pntohl(data + ADP_DEF_VIDEO_FORMAT_OFFSET);
+    pdu->association_id = pntoh64(data + ADP_ASSOC_ID_OFFSET);
+    pdu->entity_type = pntohl(data + ADP_ENTITY_TYPE_OFFSET);
+    return TRUE;
+}
+
+gboolean ieee17221_decode_acmp(const guint8 *data, guint len, ieee17221_acmp_pdu_t *pdu)
+{
+    if (len < ACMP_PDU_SIZE)
+        return FALSE;
+
+    pdu->message_type = data[ACMP_VERSION_OFFSET] & ACMP_MSG_TYPE_MASK;
+    pdu->status = (data[ACMP_STATUS_FIELD_OFFSET] & ACMP_STATUS_FIELD_MASK) >> 3;
+    pdu->cd_length = pntohs(data + ACMP_STATUS_FIELD_OFFSET) & ACMP_CD_LENGTH_MASK;
+    pdu->stream_id = pntoh64(data + ACMP_STREAM_ID_OFFSET);
+    pdu->controller_guid = pntoh64(data + ACMP_CONTROLLER_GUID_OFFSET);
+    pdu->talker_guid = pntoh64(data + ACMP_TALKER_GUID_OFFSET);
+    pdu->listener_guid = pntoh64(data + ACMP_LISTENER_GUID_OFFSET);
+    pdu->talker_unique_id = pntohs(data + ACMP_TALKER_UNIQUE_ID_OFFSET);
+    pdu->listener_unique_id = pntohs(data + ACMP_LISTENER_UNIQUE_ID_OFFSET);
+    memcpy(pdu->stream_dest_mac, data + ACMP_DEST_MAC_OFFSET, 6);
+    pdu->connection_count = pntohs(data + ACMP_CONNECTION_COUNT_OFFSET);
+    pdu->sequence_id = pntohs(data + ACMP_SEQUENCE_ID_OFFSET);
+    pdu->flags = pntohs(data + ACMP_FLAGS_OFFSET);
+    pdu->default_format = pntohl(data + ACMP_DEFAULT_FORMAT_OFFSET);
+    return TRUE;
+}
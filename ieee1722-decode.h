@@ -0,0 +1,215 @@
+/* ieee1722-decode.h
+ * Tree-independent decoding of IEEE 1722 (AVB-TP) and IEEE 1722.1
+ * (AVDECC) PDUs into plain structs
+ *
+ * Nothing here depends on the protocol tree or on a tvbuff: every decoder
+ * takes a byte span, checks its length once and fills in a struct, so the
+ * same code serves the dissectors, taps and offline tools.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __IEEE1722_DECODE_H__
+#define __IEEE1722_DECODE_H__
+
+/******************************************************************************/
+/* 1722 Offsets */
+#define IEEE_1722_CD_OFFSET                  0
+#define IEEE_1722_VERSION_OFFSET             1
+#define IEEE_1722_SEQ_NUM_OFFSET             2
+#define IEEE_1722_TU_FIELD_OFFSET            3
+#define IEEE_1722_STREAM_ID_OFFSET           4
+#define IEEE_1722_TIMESTAMP_OFFSET          12
+#define IEEE_1722_GW_INFO_OFFSET            16
+#define IEEE_1722_PKT_DATA_LENGTH_OFFSET    20
+#define IEEE_1722_TAG_OFFSET                22
+#define IEEE_1722_TCODE_OFFSET              23
+#define IEEE_1722_SID_OFFSET                24
+#define IEEE_1722_DBS_OFFSET                25
+#define IEEE_1722_FN_OFFSET                 26
+#define IEEE_1722_DBC_OFFSET                27
+#define IEEE_1722_FMT_OFFSET                28
+#define IEEE_1722_FDF_OFFSET                29
+#define IEEE_1722_SYT_OFFSET                30
+#define IEEE_1722_DATA_OFFSET               32
+
+#define IEEE_1722_COMMON_HEADER_SIZE    2
+#define IEEE_1722_CIP_HEADER_SIZE       8
+
+/* Bit Field Masks */
+#define IEEE_1722_CD_MASK       0x80
+#define IEEE_1722_SV_MASK       0x80
+#define IEEE_1722_VER_MASK      0x70
+#define IEEE_1722_MR_MASK       0x08
+#define IEEE_1722_GV_MASK       0x02
+#define IEEE_1722_TV_MASK       0x01
+#define IEEE_1722_TU_MASK       0x01
+#define IEEE_1722_TAG_MASK      0xc0
+#define IEEE_1722_CHANNEL_MASK  0x3f
+#define IEEE_1722_TCODE_MASK    0xf0
+#define IEEE_1722_SY_MASK       0x0f
+#define IEEE_1722_SID_MASK      0x3f
+#define IEEE_1722_FN_MASK       0xc0
+#define IEEE_1722_QPC_MASK      0x38
+#define IEEE_1722_SPH_MASK      0x04
+#define IEEE_1722_FMT_MASK      0x3f
+
+/******************************************************************************/
+/* 1722.1 ADP Offsets */
+#define ADP_CD_OFFSET                       0
+#define ADP_VERSION_OFFSET                  1
+#define ADP_VALID_TIME_OFFSET               2
+#define ADP_CD_LENGTH_OFFSET                3
+#define ADP_ENTITY_GUID_OFFSET              4
+#define ADP_VENDOR_ID_OFFSET                12
+#define ADP_MODEL_ID_OFFSET                 16
+#define ADP_ENTITY_CAP_OFFSET               20
+#define ADP_TALKER_STREAM_SRCS_OFFSET       24
+#define ADP_TALKER_CAP_OFFSET               26
+#define ADP_LISTENER_STREAM_SINKS_OFFSET    28
+#define ADP_LISTENER_CAP_OFFSET             30
+#define ADP_CONTROLLER_CAP_OFFSET           32
+#define ADP_AVAIL_INDEX_OFFSET              36
+#define ADP_AS_GM_ID_OFFSET                 40
+#define ADP_DEF_AUDIO_FORMAT_OFFSET         48
+#define ADP_CHAN_FORMAT_OFFSET              50
+#define ADP_DEF_VIDEO_FORMAT_OFFSET         52
+#define ADP_ASSOC_ID_OFFSET                 56
+#define ADP_ENTITY_TYPE_OFFSET              64
+
+#define ADP_PDU_SIZE                        68
+
+/* Bit Field Masks */
+
+#define ADP_MSG_TYPE_MASK                   0x0f
+#define ADP_VALID_TIME_MASK                 0xf8
+#define ADP_CD_LENGTH_MASK                  0x07ff
+
+/******************************************************************************/
+/* 1722.1 ACMP Offsets */
+#define ACMP_CD_OFFSET                      0
+#define ACMP_VERSION_OFFSET                 1
+#define ACMP_STATUS_FIELD_OFFSET            2
+#define ACMP_CD_LENGTH_OFFSET               3
+#define ACMP_STREAM_ID_OFFSET               4
+#define ACMP_CONTROLLER_GUID_OFFSET         12
+#define ACMP_TALKER_GUID_OFFSET             20
+#define ACMP_LISTENER_GUID_OFFSET           28
+#define ACMP_TALKER_UNIQUE_ID_OFFSET        36
+#define ACMP_LISTENER_UNIQUE_ID_OFFSET      38
+#define ACMP_DEST_MAC_OFFSET                40
+#define ACMP_CONNECTION_COUNT_OFFSET        46
+#define ACMP_SEQUENCE_ID_OFFSET             48
+#define ACMP_FLAGS_OFFSET                   50
+#define ACMP_DEFAULT_FORMAT_OFFSET          52
+
+#define ACMP_PDU_SIZE                       56
+
+/* Bit Field Masks */
+
+#define ACMP_MSG_TYPE_MASK                  0x0f
+#define ACMP_STATUS_FIELD_MASK              0xf8
+#define ACMP_CD_LENGTH_MASK                 0x07ff
+
+/******************************************************************************/
+
+/* First two octets of every AVTPDU */
+typedef struct _ieee1722_common_hdr {
+    guint8  cd;
+    guint8  subtype;        /* the whole first octet, as in 1722-2016 */
+    guint8  sv;
+    guint8  version;
+} ieee1722_common_hdr_t;
+
+/* IEC 61883/IIDC stream header and 1394 CIP header */
+typedef struct _ieee1722_61883_hdr {
+    ieee1722_common_hdr_t common;
+    guint8  mr;
+    guint8  gv;
+    guint8  tv;
+    guint8  seqnum;
+    guint8  tu;
+    guint64 stream_id;
+    guint32 avtp_timestamp;
+    guint32 gateway_info;
+    guint16 packet_data_length;
+    guint8  tag;
+    guint8  channel;
+    guint8  tcode;
+    guint8  sy;
+    guint8  sid;
+    guint8  dbs;
+    guint8  fn;
+    guint8  qpc;
+    guint8  sph;
+    guint8  dbc;
+    guint8  fmt;
+    guint8  fdf;
+    guint16 syt;
+} ieee1722_61883_hdr_t;
+
+typedef struct _ieee17221_adp_pdu {
+    guint8  message_type;
+    guint8  valid_time;     /* in 2 second units */
+    guint16 cd_length;
+    guint64 entity_guid;
+    guint32 vendor_id;
+    guint32 model_id;
+    guint32 entity_cap;
+    guint16 talker_stream_sources;
+    guint16 talker_cap;
+    guint16 listener_stream_sinks;
+    guint16 listener_cap;
+    guint32 controller_cap;
+    guint32 available_index;
+    guint64 as_grandmaster_id;
+    guint16 default_audio_format;
+    guint16 channel_formats;
+    guint32 default_video_format;
+    guint64 association_id;
+    guint32 entity_type;
+} ieee17221_adp_pdu_t;
+
+typedef struct _ieee17221_acmp_pdu {
+    guint8  message_type;
+    guint8  status;
+    guint16 cd_length;
+    guint64 stream_id;
+    guint64 controller_guid;
+    guint64 talker_guid;
+    guint64 listener_guid;
+    guint16 talker_unique_id;
+    guint16 listener_unique_id;
+    guint8  stream_dest_mac[6];
+    guint16 connection_count;
+    guint16 sequence_id;
+    guint16 flags;
+    guint32 default_format;
+} ieee17221_acmp_pdu_t;
+
+/* Each decoder returns FALSE, leaving the struct untouched, when len is
+ * shorter than the fixed part of the PDU.  No other validation is done;
+ * field values are reported as found.
+ */
+extern gboolean ieee1722_decode_common(const guint8 *data, guint len, ieee1722_common_hdr_t *hdr);
+extern gboolean ieee1722_decode_61883(const guint8 *data, guint len, ieee1722_61883_hdr_t *hdr);
+extern gboolean ieee17221_decode_adp(const guint8 *data, guint len, ieee17221_adp_pdu_t *pdu);
+extern gboolean ieee17221_decode_acmp(const guint8 *data, guint len, ieee17221_acmp_pdu_t *pdu);
+
+#endif /* __IEEE1722_DECODE_H__ */
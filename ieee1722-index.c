@@ -0,0 +1,423 @@
+/* ieee1722-index.c
+ * Sidecar index of the frames of each AVTP stream, AVDECC entity and
+ * AVTP subtype in a capture
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+
+#include <epan/pint.h>
+
+#include "ieee1722-index.h"
+
+/* Longest LEB128 encoding of a guint32 */
+#define VARINT_MAX_SIZE     5
+
+/* Frame list of one key while the index is built */
+typedef struct _index_entry {
+    guint64 key;                /* first, it is the hash key */
+    guint8  kind;
+    guint32 count;
+    guint32 last_frame;
+    GArray *list;               /* of guint8, LEB128 deltas */
+} index_entry_t;
+
+struct _ieee1722_index_builder {
+    GHashTable *keys[IEEE1722_INDEX_KINDS];
+    guint32 first_frame;
+    guint32 last_frame;
+    guint64 first_secs;
+    guint32 first_nsecs;
+};
+
+struct _ieee1722_index {
+    GMappedFile *mapped;
+    const guint8 *table;
+    const guint8 *data;
+    guint nkeys;
+    guint key_size;
+    guint32 first_frame;
+    guint32 last_frame;
+    guint64 first_secs;
+    guint32 first_nsecs;
+};
+
+static void
+index_entry_free(gpointer p)
+{
+    index_entry_t *entry = p;
+
+    g_array_free(entry->list, TRUE);
+    g_free(entry);
+}
+
+ieee1722_index_builder_t *
+ieee1722_index_builder_new(void)
+{
+    ieee1722_index_builder_t *builder = g_new0(ieee1722_index_builder_t, 1);
+    guint kind;
+
+    for (kind = 0; kind < IEEE1722_INDEX_KINDS; kind++)
+        builder->keys[kind] = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+                                                    NULL, index_entry_free);
+    return builder;
+}
+
+void
+ieee1722_index_builder_free(ieee1722_index_builder_t *builder)
+{
+    guint kind;
+
+    for (kind = 0; kind < IEEE1722_INDEX_KINDS; kind++)
+        g_hash_table_destroy(builder->keys[kind]);
+    g_free(builder);
+}
+
+void
+ieee1722_index_add(ieee1722_index_builder_t *builder, guint8 kind, guint64 key, guint32 frame)
+{
+    index_entry_t *entry;
+    guint8 buf[VARINT_MAX_SIZE];
+    guint32 delta;
+    guint n = 0;
+
+    g_return_if_fail(kind < IEEE1722_INDEX_KINDS);
+
+    entry = g_hash_table_lookup(builder->keys[kind], &key);
+    if (entry == NULL) {
+        entry = g_new0(index_entry_t, 1);
+        entry->key = key;
+        entry->kind = kind;
+        entry->list = g_array_new(FALSE, FALSE, 1);
+        g_hash_table_insert(builder->keys[kind], &entry->key, entry);
+    }
+    else if (frame <= entry->last_frame) {
+        return;
+    }
+
+    delta = frame - entry->last_frame;
+    while (delta >= 0x80) {
+        buf[n++] = (delta & 0x7f) | 0x80;
+        delta >>= 7;
+    }
+    buf[n++] = delta;
+    g_array_append_vals(entry->list, buf, n);
+    entry->last_frame = frame;
+    entry->count++;
+}
+
+void
+ieee1722_index_set_capture(ieee1722_index_builder_t *builder, guint32 first_frame,
+                           guint32 last_frame, guint64 first_secs, guint32 first_nsecs)
+{
+    builder->first_frame = first_frame;
+    builder->last_frame = last_frame;
+    builder->first_secs = first_secs;
+    builder->first_nsecs = first_nsecs;
+}
+
+guint
+ieee1722_index_builder_keys(const ieee1722_index_builder_t *builder)
+{
+    guint kind;
+    guint n = 0;
+
+    for (kind = 0; kind < IEEE1722_INDEX_KINDS; kind++)
+        n += g_hash_table_size(builder->keys[kind]);
+    return n;
+}
+
+static void
+put_be16(guint8 *p, guint16 v)
+{
+    p[0] = v >> 8;
+    p[1] = v & 0xff;
+}
+
+static void
+put_be32(guint8 *p, guint32 v)
+{
+    p[0] = v >> 24;
+    p[1] = (v >> 16) & 0xff;
+    p[2] = (v >> 8) & 0xff;
+    p[3] = v & 0xff;
+}
+
+static void
+put_be64(guint8 *p, guint64 v)
+{
+    put_be32(p, (guint32)(v >> 32));
+    put_be32(p + 4, (guint32)v);
+}
+
+static gint
+index_entry_compare(gconstpointer a, gconstpointer b)
+{
+    const index_entry_t *ea = *(const index_entry_t * const *)a;
+    const index_entry_t *eb = *(const index_entry_t * const *)b;
+
+    if (ea->kind != eb->kind)
+        return ea->kind < eb->kind ? -1 : 1;
+    if (ea->key == eb->key)
+        return 0;
+    return ea->key < eb->key ? -1 : 1;
+}
+
+gboolean
+ieee1722_index_write(const ieee1722_index_builder_t *builder, const char *filename)
+{
+    GPtrArray *sorted;
+    guint8 header[IEEE1722_INDEX_HEADER_SIZE];
+    guint8 key[IEEE1722_INDEX_KEY_SIZE];
+    guint64 data_size = 0;
+    gboolean ok;
+    FILE *fp;
+    guint kind;
+    guint i;
+
+    sorted = g_ptr_array_new();
+    for (kind = 0; kind < IEEE1722_INDEX_KINDS; kind++) {
+        GHashTableIter iter;
+        gpointer value;
+
+        g_hash_table_iter_init(&iter, builder->keys[kind]);
+        while (g_hash_table_iter_next(&iter, NULL, &value))
+            g_ptr_array_add(sorted, value);
+    }
+    g_ptr_array_sort(sorted, index_entry_compare);
+    for (i = 0; i < sorted->len; i++)
+        data_size += ((index_entry_t *)g_ptr_array_index(sorted, i))->list->len;
+    if (data_size > G_MAXUINT32) {
+        g_ptr_array_free(sorted, TRUE);
+        errno = EFBIG;
+        return FALSE;
+    }
+
+    fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        g_ptr_array_free(sorted, TRUE);
+        return FALSE;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, IEEE1722_INDEX_MAGIC, sizeof(IEEE1722_INDEX_MAGIC));
+    put_be16(header + 8, IEEE1722_INDEX_VERSION);
+    put_be16(header + 10, IEEE1722_INDEX_KEY_SIZE);
+    put_be32(header + 12, sorted->len);
+    put_be32(header + 16, builder->first_frame);
+    put_be32(header + 20, builder->last_frame);
+    put_be64(header + 24, builder->first_secs);
+    put_be32(header + 32, builder->first_nsecs);
+    put_be64(header + 40, data_size);
+    fwrite(header, 1, sizeof(header), fp);
+
+    data_size = 0;
+    memset(key, 0, sizeof(key));
+    for (i = 0; i < sorted->len; i++) {
+        const index_entry_t *entry = g_ptr_array_index(sorted, i);
+
+        key[0] = entry->kind;
+        put_be32(key + 4, entry->count);
+        put_be64(key + 8, entry->key);
+        put_be32(key + 16, (guint32)data_size);
+        put_be32(key + 20, entry->list->len);
+        fwrite(key, 1, sizeof(key), fp);
+        data_size += entry->list->len;
+    }
+
+    for (i = 0; i < sorted->len; i++) {
+        const index_entry_t *entry = g_ptr_array_index(sorted, i);
+
+        fwrite(entry->list->data, 1, entry->list->len, fp);
+    }
+
+    ok = !ferror(fp);
+    if (fclose(fp) != 0)
+        ok = FALSE;
+    g_ptr_array_free(sorted, TRUE);
+    return ok;
+}
+
+ieee1722_index_t *
+ieee1722_index_open(const char *filename, gchar **err_info)
+{
+    ieee1722_index_t *idx;
+    GMappedFile *mapped;
+    GError *error = NULL;
+    const guint8 *base;
+    guint64 length;
+    guint64 table_end;
+    guint64 data_size;
+    guint nkeys;
+    guint key_size;
+    guint i;
+
+    mapped = g_mapped_file_new(filename, FALSE, &error);
+    if (mapped == NULL) {
+        *err_info = g_strdup(error->message);
+        g_error_free(error);
+        return NULL;
+    }
+    base = (const guint8 *)g_mapped_file_get_contents(mapped);
+    length = g_mapped_file_get_length(mapped);
+
+    if (length < IEEE1722_INDEX_HEADER_SIZE ||
+        memcmp(base, IEEE1722_INDEX_MAGIC, sizeof(IEEE1722_INDEX_MAGIC)) != 0) {
+        *err_info = g_strdup_printf("%s is not an AVTP stream index", filename);
+        g_mapped_file_unref(mapped);
+        return NULL;
+    }
+    if (pntohs(base + 8) != IEEE1722_INDEX_VERSION) {
+        *err_info = g_strdup_printf("%s is a version %u AVTP stream index, only version %u is supported",
+                                    filename, pntohs(base + 8), IEEE1722_INDEX_VERSION);
+        g_mapped_file_unref(mapped);
+        return NULL;
+    }
+
+    key_size = pntohs(base + 10);
+    nkeys = pntohl(base + 12);
+    data_size = pntoh64(base + 40);
+    table_end = IEEE1722_INDEX_HEADER_SIZE + (guint64)nkeys * key_size;
+    if (key_size < IEEE1722_INDEX_KEY_SIZE || table_end > length ||
+        data_size != length - table_end) {
+        *err_info = g_strdup_printf("%s: AVTP stream index is truncated or corrupt", filename);
+        g_mapped_file_unref(mapped);
+        return NULL;
+    }
+
+    /* Check every frame list lies inside the file once, so lookups need not */
+    for (i = 0; i < nkeys; i++) {
+        const guint8 *entry = base + IEEE1722_INDEX_HEADER_SIZE + i * key_size;
+
+        if ((guint64)pntohl(entry + 16) + pntohl(entry + 20) > data_size) {
+            *err_info = g_strdup_printf("%s: AVTP stream index is truncated or corrupt", filename);
+            g_mapped_file_unref(mapped);
+            return NULL;
+        }
+    }
+
+    idx = g_new0(ieee1722_index_t, 1);
+    idx->mapped = mapped;
+    idx->table = base + IEEE1722_INDEX_HEADER_SIZE;
+    idx->data = base + table_end;
+    idx->nkeys = nkeys;
+    idx->key_size = key_size;
+    idx->first_frame = pntohl(base + 16);
+    idx->last_frame = pntohl(base + 20);
+    idx->first_secs = pntoh64(base + 24);
+    idx->first_nsecs = pntohl(base + 32);
+    return idx;
+}
+
+void
+ieee1722_index_close(ieee1722_index_t *idx)
+{
+    g_mapped_file_unref(idx->mapped);
+    g_free(idx);
+}
+
+void
+ieee1722_index_capture(const ieee1722_index_t *idx, guint32 *first_frame, guint32 *last_frame,
+                       guint64 *first_secs, guint32 *first_nsecs)
+{
+    *first_frame = idx->first_frame;
+    *last_frame = idx->last_frame;
+    *first_secs = idx->first_secs;
+    *first_nsecs = idx->first_nsecs;
+}
+
+guint
+ieee1722_index_keys(const ieee1722_index_t *idx)
+{
+    return idx->nkeys;
+}
+
+void
+ieee1722_index_key(const ieee1722_index_t *idx, guint i, guint8 *kind, guint64 *key,
+                   guint32 *count)
+{
+    const guint8 *entry = idx->table + i * idx->key_size;
+
+    *kind = entry[0];
+    *count = pntohl(entry + 4);
+    *key = pntoh64(entry + 8);
+}
+
+gboolean
+ieee1722_index_lookup(const ieee1722_index_t *idx, guint8 kind, guint64 key,
+                      ieee1722_index_iter_t *iter)
+{
+    guint lo = 0;
+    guint hi = idx->nkeys;
+
+    while (lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        const guint8 *entry = idx->table + mid * idx->key_size;
+        guint64 mid_key = pntoh64(entry + 8);
+
+        if (entry[0] < kind || (entry[0] == kind && mid_key < key)) {
+            lo = mid + 1;
+        }
+        else if (entry[0] == kind && mid_key == key) {
+            iter->p = idx->data + pntohl(entry + 16);
+            iter->end = iter->p + pntohl(entry + 20);
+            iter->remaining = pntohl(entry + 4);
+            iter->frame = 0;
+            return TRUE;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return FALSE;
+}
+
+gboolean
+ieee1722_index_next(ieee1722_index_iter_t *iter, guint32 *frame)
+{
+    guint32 delta = 0;
+    guint shift = 0;
+    guint8 b;
+
+    if (iter->remaining == 0)
+        return FALSE;
+    do {
+        if (iter->p == iter->end || shift >= 7 * VARINT_MAX_SIZE) {
+            iter->remaining = 0;
+            return FALSE;
+        }
+        b = *iter->p++;
+        delta |= (guint32)(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+
+    iter->frame += delta;
+    iter->remaining--;
+    *frame = iter->frame;
+    return TRUE;
+}
@@ -0,0 +1,137 @@
+/* ieee1722-index.h
+ * Sidecar index of the frames of each AVTP stream, AVDECC entity and
+ * AVTP subtype in a capture
+ *
+ * The index is built while the capture is read for the first time (see
+ * tap-avtpindex.c) and written next to it, so that a later pass scoped to
+ * one stream or entity can go straight to its frames instead of
+ * dissecting the whole file.  The file is read through a read-only
+ * mapping and used in place; opening it costs one pass over the key
+ * table to check its bounds.
+ *
+ * Layout, all integers in network byte order:
+ *
+ *   header     IEEE1722_INDEX_HEADER_SIZE bytes
+ *      0  8    magic "AVTPIDX\0"
+ *      8  2    version, IEEE1722_INDEX_VERSION
+ *     10  2    size of a key table entry, at least IEEE1722_INDEX_KEY_SIZE
+ *     12  4    number of keys
+ *     16  4    number of the first frame indexed
+ *     20  4    number of the last frame indexed
+ *     24  8    capture time of the first frame indexed, seconds
+ *     32  4    capture time of the first frame indexed, nanoseconds
+ *     36  4    reserved, 0
+ *     40  8    size of the frame list area, at most 4 GB
+ *   key table  one entry per key, sorted by kind then key
+ *      0  1    kind, IEEE1722_INDEX_xxx
+ *      1  3    reserved, 0
+ *      4  4    number of frames
+ *      8  8    stream ID, entity GUID or subtype
+ *     16  4    offset of the frame list in the frame list area
+ *     20  4    length of the frame list
+ *   frame list area
+ *              per key, the ascending frame numbers as differences from
+ *              the previous one (from 0 for the first), each an unsigned
+ *              LEB128 varint: 7 bits per byte, low bits first, top bit
+ *              set on all but the last byte
+ *
+ * Readers must reject a version they don't know and skip key table
+ * fields past IEEE1722_INDEX_KEY_SIZE.  The first frame indexed and its
+ * capture time identify the capture the index was built from; it is up to
+ * the caller to check them before trusting the frame numbers.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __IEEE1722_INDEX_H__
+#define __IEEE1722_INDEX_H__
+
+#define IEEE1722_INDEX_MAGIC        "AVTPIDX"
+#define IEEE1722_INDEX_VERSION      1
+#define IEEE1722_INDEX_HEADER_SIZE  48
+#define IEEE1722_INDEX_KEY_SIZE     24
+
+/* What a key identifies */
+#define IEEE1722_INDEX_STREAM       0   /* AVTP stream ID */
+#define IEEE1722_INDEX_ENTITY       1   /* AVDECC entity GUID */
+#define IEEE1722_INDEX_SUBTYPE      2   /* AVTP subtype */
+#define IEEE1722_INDEX_KINDS        3
+
+/******************************************************************************/
+/* Building an index */
+
+typedef struct _ieee1722_index_builder ieee1722_index_builder_t;
+
+extern ieee1722_index_builder_t *ieee1722_index_builder_new(void);
+extern void ieee1722_index_builder_free(ieee1722_index_builder_t *builder);
+
+/* Frames must be added in ascending order; adding the same frame to a key
+ * again is ignored. */
+extern void ieee1722_index_add(ieee1722_index_builder_t *builder, guint8 kind, guint64 key,
+                               guint32 frame);
+
+/* The range of frames indexed and the capture time of the first */
+extern void ieee1722_index_set_capture(ieee1722_index_builder_t *builder, guint32 first_frame,
+                                       guint32 last_frame, guint64 first_secs,
+                                       guint32 first_nsecs);
+
+extern guint ieee1722_index_builder_keys(const ieee1722_index_builder_t *builder);
+
+/* FALSE, with errno set, if the file could not be written (EFBIG if the
+ * frame lists outgrow the format) */
+extern gboolean ieee1722_index_write(const ieee1722_index_builder_t *builder,
+                                     const char *filename);
+
+/******************************************************************************/
+/* Reading an index */
+
+typedef struct _ieee1722_index ieee1722_index_t;
+
+/* Frames of one key, in ascending order */
+typedef struct _ieee1722_index_iter {
+    const guint8 *p;
+    const guint8 *end;
+    guint32 remaining;
+    guint32 frame;
+} ieee1722_index_iter_t;
+
+/* NULL if the file can't be mapped or is not a valid index; *err_info
+ * then says why and must be freed with g_free(). */
+extern ieee1722_index_t *ieee1722_index_open(const char *filename, gchar **err_info);
+extern void ieee1722_index_close(ieee1722_index_t *idx);
+
+extern void ieee1722_index_capture(const ieee1722_index_t *idx, guint32 *first_frame,
+                                   guint32 *last_frame, guint64 *first_secs,
+                                   guint32 *first_nsecs);
+
+/* Keys in table order, for listing what the index holds */
+extern guint ieee1722_index_keys(const ieee1722_index_t *idx);
+extern void ieee1722_index_key(const ieee1722_index_t *idx, guint i, guint8 *kind,
+                               guint64 *key, guint32 *count);
+
+/* Binary search of the key table.  FALSE if the key is not indexed, i.e.
+ * no frame of the capture has it. */
+extern gboolean ieee1722_index_lookup(const ieee1722_index_t *idx, guint8 kind, guint64 key,
+                                      ieee1722_index_iter_t *iter);
+
+/* Next frame number of the key, FALSE at the end of the list or if the
+ * list is corrupt */
+extern gboolean ieee1722_index_next(ieee1722_index_iter_t *iter, guint32 *frame);
+
+#endif /* __IEEE1722_INDEX_H__ */
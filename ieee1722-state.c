@@ -0,0 +1,296 @@
+/* ieee1722-state.c
+ * Capacity-limited state tables for the IEEE 1722 / 1722.1 dissectors
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "ieee1722-state.h"
+
+/* What a hash table slot costs besides the entry, roughly */
+#define STATE_HASH_SLOT_COST    (3 * sizeof(gpointer))
+
+/* Entries are carved from blocks of this many, and evicted ones kept on
+ * a free list for the next insert into the same table, so a table at its
+ * share of the budget neither grows nor calls malloc */
+#define STATE_BLOCK_ENTRIES     64
+
+/* Every entry is preceded by its place in the eviction list.
+ *
+ * Moving an entry to the front on every lookup would cost more than the
+ * lookup itself, so the list is kept in insertion order and a lookup only
+ * marks the entry as referenced, as an insert does.  When an insert needs
+ * room, referenced entries at the old end get a second chance at the front
+ * instead of being evicted (the CLOCK approximation of LRU): what goes is an entry
+ * not used since it last came round.
+ */
+typedef struct _state_entry {
+    struct _state_entry *newer;
+    struct _state_entry *older;
+    ieee1722_state_table_t *table;
+    gsize cost;                 /* entry, header and owned memory */
+    gboolean referenced;        /* looked up since it was last put in front */
+} state_entry_t;
+
+/* Keeps the caller's part 8-byte aligned */
+#define STATE_HEADER_SIZE       ((sizeof(state_entry_t) + 7) & ~(gsize)7)
+
+#define STATE_DATA(entry)       ((gpointer)((guint8 *)(entry) + STATE_HEADER_SIZE))
+#define STATE_ENTRY(data)       ((state_entry_t *)((guint8 *)(data) - STATE_HEADER_SIZE))
+
+struct _ieee1722_state_table {
+    GHashTable *hash;           /* caller's part, key first, to entry */
+    gsize entry_size;
+    gsize key_size;
+    ieee1722_state_free_func free_func;
+    GSList *blocks;
+    state_entry_t *free_entries;    /* linked through older */
+    guint8 *block_next;             /* unused part of the newest block */
+    guint8 *block_end;
+    ieee1722_state_stats_t stats;
+};
+
+guint ieee1722_state_budget_kb = 16384;
+gboolean ieee1722_state_revisit = TRUE;
+
+/* Eviction list over the entries of all tables */
+static state_entry_t *state_newest = NULL;
+static state_entry_t *state_oldest = NULL;
+static guint64 state_used = 0;
+static guint32 state_evictions = 0;
+static GSList *state_tables = NULL;
+
+guint64
+ieee1722_state_budget(void)
+{
+    return (guint64)MAX(ieee1722_state_budget_kb, IEEE1722_STATE_MIN_BUDGET_KB) * 1024;
+}
+
+static void state_unlink(state_entry_t *entry)
+{
+    if (entry->newer)
+        entry->newer->older = entry->older;
+    else
+        state_newest = entry->older;
+    if (entry->older)
+        entry->older->newer = entry->newer;
+    else
+        state_oldest = entry->newer;
+}
+
+static void state_link_newest(state_entry_t *entry)
+{
+    entry->newer = NULL;
+    entry->older = state_newest;
+    if (state_newest)
+        state_newest->newer = entry;
+    else
+        state_oldest = entry;
+    state_newest = entry;
+}
+
+static state_entry_t *state_entry_alloc(ieee1722_state_table_t *table)
+{
+    gsize size = STATE_HEADER_SIZE + table->entry_size;
+    state_entry_t *entry = table->free_entries;
+
+    if (entry) {
+        table->free_entries = entry->older;
+        memset(entry, 0, size);
+        return entry;
+    }
+    if (table->block_next == table->block_end) {
+        table->block_next = g_malloc0(size * STATE_BLOCK_ENTRIES);
+        table->block_end = table->block_next + size * STATE_BLOCK_ENTRIES;
+        table->blocks = g_slist_prepend(table->blocks, table->block_next);
+    }
+    entry = (state_entry_t *)table->block_next;
+    table->block_next += size;
+    return entry;
+}
+
+/* Unlink and release an entry that is already out of its hash table */
+static void state_release(state_entry_t *entry)
+{
+    ieee1722_state_table_t *table = entry->table;
+
+    state_unlink(entry);
+    if (table->free_func)
+        table->free_func(STATE_DATA(entry));
+    table->stats.entries--;
+    table->stats.bytes -= entry->cost;
+    state_used -= entry->cost;
+}
+
+static void state_evict(state_entry_t *entry)
+{
+    ieee1722_state_table_t *table = entry->table;
+
+    g_hash_table_remove(table->hash, STATE_DATA(entry));
+    table->stats.evictions++;
+    state_evictions++;
+    state_release(entry);
+    entry->older = table->free_entries;
+    table->free_entries = entry;
+}
+
+/* Evict until cost more fits in the budget, or only keep is left */
+static void state_make_room(gsize cost, state_entry_t *keep)
+{
+    state_entry_t *entry;
+    guint64 budget = ieee1722_state_budget();
+
+    /* Ends after at most two laps, the first of which clears every
+     * referenced flag */
+    while (state_oldest && state_used + cost > budget) {
+        entry = state_oldest;
+        if (entry == keep && entry->newer == NULL)
+            break;
+        if (entry == keep || entry->referenced) {
+            entry->referenced = FALSE;
+            state_unlink(entry);
+            state_link_newest(entry);
+        }
+        else {
+            state_evict(entry);
+        }
+    }
+}
+
+ieee1722_state_table_t *
+ieee1722_state_table_new(const char *name, gsize entry_size, gsize key_size, GHashFunc hash_func,
+                         GEqualFunc key_equal_func, ieee1722_state_free_func free_func)
+{
+    ieee1722_state_table_t *table = g_new0(ieee1722_state_table_t, 1);
+
+    table->hash = g_hash_table_new(hash_func, key_equal_func);
+    table->entry_size = entry_size;
+    table->key_size = key_size;
+    table->free_func = free_func;
+    table->stats.name = name;
+    state_tables = g_slist_append(state_tables, table);
+    return table;
+}
+
+void
+ieee1722_state_table_destroy(ieee1722_state_table_t *table)
+{
+    GHashTableIter iter;
+    gpointer value;
+    GSList *l;
+
+    if (table == NULL)
+        return;
+
+    g_hash_table_iter_init(&iter, table->hash);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+        state_release(value);
+    g_hash_table_destroy(table->hash);
+    for (l = table->blocks; l; l = l->next)
+        g_free(l->data);
+    g_slist_free(table->blocks);
+    state_tables = g_slist_remove(state_tables, table);
+    g_free(table);
+}
+
+gpointer
+ieee1722_state_lookup(ieee1722_state_table_t *table, gconstpointer key)
+{
+    state_entry_t *entry = g_hash_table_lookup(table->hash, key);
+
+    if (entry == NULL)
+        return NULL;
+    entry->referenced = TRUE;
+    return STATE_DATA(entry);
+}
+
+gpointer
+ieee1722_state_insert(ieee1722_state_table_t *table, gconstpointer key)
+{
+    state_entry_t *entry;
+    gsize cost = STATE_HEADER_SIZE + table->entry_size + STATE_HASH_SLOT_COST;
+
+    state_make_room(cost, NULL);
+
+    entry = state_entry_alloc(table);
+    entry->table = table;
+    entry->cost = cost;
+    entry->referenced = TRUE;
+    memcpy(STATE_DATA(entry), key, table->key_size);
+    g_hash_table_insert(table->hash, STATE_DATA(entry), entry);
+    state_link_newest(entry);
+
+    table->stats.entries++;
+    table->stats.peak_entries = MAX(table->stats.peak_entries, table->stats.entries);
+    table->stats.bytes += cost;
+    table->stats.inserts++;
+    state_used += cost;
+    return STATE_DATA(entry);
+}
+
+gpointer
+ieee1722_state_alloc0(gpointer data, gsize size)
+{
+    state_entry_t *entry = STATE_ENTRY(data);
+
+    state_make_room(size, entry);
+    entry->cost += size;
+    entry->table->stats.bytes += size;
+    state_used += size;
+    return g_malloc0(size);
+}
+
+void
+ieee1722_state_free(gpointer data, gpointer mem, gsize size)
+{
+    state_entry_t *entry = STATE_ENTRY(data);
+
+    entry->cost -= size;
+    entry->table->stats.bytes -= size;
+    state_used -= size;
+    g_free(mem);
+}
+
+guint32
+ieee1722_state_evictions(void)
+{
+    return state_evictions;
+}
+
+guint
+ieee1722_state_stats(ieee1722_state_stats_t *stats, guint max, guint64 *used, guint64 *budget)
+{
+    GSList *l;
+    guint n = 0;
+
+    for (l = state_tables; l; l = l->next, n++) {
+        if (n < max)
+            stats[n] = ((ieee1722_state_table_t *)l->data)->stats;
+    }
+    *used = state_used;
+    *budget = ieee1722_state_budget();
+    return n;
+}
@@ -0,0 +1,116 @@
+/* ieee1722-state.h
+ * Capacity-limited state tables for the IEEE 1722 / 1722.1 dissectors
+ *
+ * The per-stream and per-entity records the dissectors keep on the first
+ * pass (AVTP streams, ADP entities, ACMP transactions, stream talkers, AEM
+ * descriptor names) live in these tables instead of plain hash tables, so
+ * that a capture running for weeks with streams and entities coming and
+ * going does not grow them forever.  All tables share one memory budget
+ * (the "ieee1722.state_memory" preference) and one eviction list: once
+ * the budget is used up, each new entry evicts entries of any table that
+ * have gone unused the longest (approximately, see ieee1722-state.c).  An
+ * evicted record is simply forgotten; if its stream or entity shows up
+ * again, its analysis starts over as for a new one.
+ *
+ * Entries are allocated by the table, zeroed, with the key copied to the
+ * start, and stay at the same address until they are evicted.  Memory an
+ * entry owns besides itself is allocated with ieee1722_state_alloc0(), so
+ * it counts against the budget, and released by the table's free function.
+ * Inserts pass over entries inserted or looked up since they were last
+ * considered and the budget never drops below room for hundreds, so an
+ * entry just looked up or inserted survives the next few inserts; other
+ * pointers to entries are only good until the next insert into any table
+ * or allocation, and ieee1722_state_evictions() tells whether one may have
+ * gone since.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __IEEE1722_STATE_H__
+#define __IEEE1722_STATE_H__
+
+/* Smallest budget honoured, whatever the preference says */
+#define IEEE1722_STATE_MIN_BUDGET_KB    64
+
+/* Budget of all tables together, in KiB; registered as a preference of
+ * the ieee1722 protocol and applied from the next insert on */
+extern guint ieee1722_state_budget_kb;
+
+/* The budget in effect, in bytes */
+extern guint64 ieee1722_state_budget(void);
+
+/* Whether frames keep what the first pass found about them even when it
+ * is not a warning (the "ieee1722.keep_frame_results" preference), so
+ * they show the same when dissected again.  Without it only frames with a
+ * finding get per-frame data, and a one-pass run stays within the budget
+ * plus that. */
+extern gboolean ieee1722_state_revisit;
+
+typedef struct _ieee1722_state_table ieee1722_state_table_t;
+
+/* Releases what an entry owns besides itself; called when the entry is
+ * evicted or its table destroyed */
+typedef void (*ieee1722_state_free_func)(gpointer entry);
+
+/* entry_size includes the key, key_size bytes at the start of the entry
+ * that hash_func and key_equal_func are given.  free_func may be NULL. */
+extern ieee1722_state_table_t *ieee1722_state_table_new(const char *name, gsize entry_size,
+                                                        gsize key_size, GHashFunc hash_func,
+                                                        GEqualFunc key_equal_func,
+                                                        ieee1722_state_free_func free_func);
+
+/* Frees every entry; NULL is ignored */
+extern void ieee1722_state_table_destroy(ieee1722_state_table_t *table);
+
+/* The entry with this key, now marked as used, or NULL */
+extern gpointer ieee1722_state_lookup(ieee1722_state_table_t *table, gconstpointer key);
+
+/* A new zeroed entry for a key not in the table, after evicting as many
+ * unused entries as it takes to make room for it */
+extern gpointer ieee1722_state_insert(ieee1722_state_table_t *table, gconstpointer key);
+
+/* Zeroed memory owned by an entry and charged to the budget until the
+ * entry goes; the table's free function must g_free() it.  Evicts other
+ * entries, never this one, as an insert does to make room. */
+extern gpointer ieee1722_state_alloc0(gpointer entry, gsize size);
+
+/* Give back memory from ieee1722_state_alloc0() before the entry goes */
+extern void ieee1722_state_free(gpointer entry, gpointer mem, gsize size);
+
+/* Entries evicted from all tables so far, to revalidate pointers kept
+ * from one frame to the next */
+extern guint32 ieee1722_state_evictions(void);
+
+/* Occupancy of one table */
+typedef struct _ieee1722_state_stats {
+    const char *name;
+    guint   entries;
+    guint   peak_entries;
+    guint64 bytes;
+    guint64 inserts;
+    guint64 evictions;
+} ieee1722_state_stats_t;
+
+/* Fills in up to max tables, in the order they were created, and returns
+ * how many there are; *used gets the bytes charged by all of them and
+ * *budget the budget in effect */
+extern guint ieee1722_state_stats(ieee1722_state_stats_t *stats, guint max, guint64 *used,
+                                  guint64 *budget);
+
+#endif /* __IEEE1722_STATE_H__ */
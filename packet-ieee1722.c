@@ -35,255 +35,2487 @@
 
 #include <glib.h>
 #include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <epan/packet.h>
 #include <epan/etypes.h>
+#include <epan/prefs.h>
+#include <epan/emem.h>
+#include <epan/expert.h>
+#include <epan/tap.h>
+
+#include "packet-ieee1722.h"
+#include "packet-ieee17221.h"
+#include "ieee1722-decode.h"
+#include "ieee1722-state.h"
+
+/* IEC 61883-6 audio and music data */
+#define IEEE_1722_FMT_AM824     0x10
+#define IEEE_1722_FDF_SFC_MASK  0x07
+#define IEEE_1722_FDF_NO_DATA   0xff
+
+/* SYT: 1394 cycle count and offset in 24.576 MHz ticks, wrapping every 16 cycles */
+#define IEEE_1722_SYT_NO_INFO           0xffff
+#define IEEE_1722_SYT_CYCLE_MASK        0xf000
+#define IEEE_1722_SYT_CYCLE_OFFSET_MASK 0x0fff
+#define IEEE_1722_SYT_TICKS_PER_CYCLE   3072
+#define IEEE_1722_SYT_TICKS_WRAP        (16 * IEEE_1722_SYT_TICKS_PER_CYCLE)
+
+/* IEEE 1722-2016 subtypes (the full first octet) */
+#define AVTP_SUBTYPE_61883_IIDC         0x00
+#define AVTP_SUBTYPE_MMA_STREAM         0x01
+#define AVTP_SUBTYPE_AAF                0x02
+#define AVTP_SUBTYPE_CVF                0x03
+#define AVTP_SUBTYPE_CRF                0x04
+#define AVTP_SUBTYPE_TSCF               0x05
+#define AVTP_SUBTYPE_SVF                0x06
+#define AVTP_SUBTYPE_RVF                0x07
+#define AVTP_SUBTYPE_AEF_CONTINUOUS     0x6E
+#define AVTP_SUBTYPE_VSF_STREAM         0x6F
+#define AVTP_SUBTYPE_EF_STREAM          0x7F
+#define AVTP_SUBTYPE_NTSCF              0x82
+#define AVTP_SUBTYPE_ESCF               0xEC
+#define AVTP_SUBTYPE_EECF               0xED
+#define AVTP_SUBTYPE_AEF_DISCRETE       0xEE
+#define AVTP_SUBTYPE_ADP                0xFA
+#define AVTP_SUBTYPE_AECP               0xFB
+#define AVTP_SUBTYPE_ACMP               0xFC
+#define AVTP_SUBTYPE_MAAP               0xFE
+#define AVTP_SUBTYPE_EF_CONTROL         0xFF
+
+static const value_string avtp_subtype_vals[] = {
+    {AVTP_SUBTYPE_61883_IIDC,       "IEC 61883/IIDC"},
+    {AVTP_SUBTYPE_MMA_STREAM,       "MMA Stream"},
+    {AVTP_SUBTYPE_AAF,              "AVTP Audio Format"},
+    {AVTP_SUBTYPE_CVF,              "Compressed Video Format"},
+    {AVTP_SUBTYPE_CRF,              "Clock Reference Format"},
+    {AVTP_SUBTYPE_TSCF,             "Time-Synchronous Control Format"},
+    {AVTP_SUBTYPE_SVF,              "SDI Video Format"},
+    {AVTP_SUBTYPE_RVF,              "Raw Video Format"},
+    {AVTP_SUBTYPE_AEF_CONTINUOUS,   "AES Encrypted Format Continuous"},
+    {AVTP_SUBTYPE_VSF_STREAM,       "Vendor Specific Format Stream"},
+    {AVTP_SUBTYPE_EF_STREAM,        "Experimental Format Stream"},
+    {AVTP_SUBTYPE_NTSCF,            "Non-Time-Synchronous Control Format"},
+    {AVTP_SUBTYPE_ESCF,             "ECC Signed Control Format"},
+    {AVTP_SUBTYPE_EECF,             "ECC Encrypted Control Format"},
+    {AVTP_SUBTYPE_AEF_DISCRETE,     "AES Encrypted Format Discrete"},
+    {AVTP_SUBTYPE_ADP,              "AVDECC Discovery Protocol"},
+    {AVTP_SUBTYPE_AECP,             "AVDECC Enumeration and Control Protocol"},
+    {AVTP_SUBTYPE_ACMP,             "AVDECC Connection Management Protocol"},
+    {AVTP_SUBTYPE_MAAP,             "MAAP"},
+    {AVTP_SUBTYPE_EF_CONTROL,       "Experimental Format Control"},
+    {0,                             NULL}
+};
+
+/* AVTP over UDP (IEEE 1722-2016 Annex J): a 32-bit encapsulation
+ * sequence number in front of the AVTPDU */
+#define AVTP_UDP_PORT                       17220
+#define AVTP_UDP_ENCAP_SEQ_NUM_OFFSET       0
+#define AVTP_UDP_ENCAP_SIZE                 4
+
+/* AVTP control header: 11-bit control_data_length after the first 16 bits */
+#define AVTP_CONTROL_DATA_LENGTH_OFFSET     2
+#define AVTP_CONTROL_DATA_LENGTH_MASK       0x07ff
+#define AVTP_CONTROL_HEADER_SIZE            12
+
+/* Common stream header (AAF, CVF, TSCF, SVF, RVF) */
+#define AVTP_STREAM_FORMAT_INFO_OFFSET      16
+#define AVTP_STREAM_DATA_LENGTH_OFFSET      20
+#define AVTP_STREAM_FORMAT_INFO2_OFFSET     22
+#define AVTP_STREAM_PAYLOAD_OFFSET          24
+
+/* AAF header */
+#define AAF_FORMAT_OFFSET                   16
+#define AAF_NSR_OFFSET                      17
+#define AAF_CHANNELS_OFFSET                 17
+#define AAF_BIT_DEPTH_OFFSET                19
+#define AAF_SP_EVT_OFFSET                   22
+
+#define AAF_NSR_MASK                        0xf0
+#define AAF_CHANNELS_MASK                   0x03ff
+#define AAF_SP_MASK                         0x10
+#define AAF_EVT_MASK                        0x0f
+
+#define AAF_FORMAT_USER                     0
+#define AAF_FORMAT_FLOAT_32BIT              1
+#define AAF_FORMAT_INT_32BIT                2
+#define AAF_FORMAT_INT_24BIT                3
+#define AAF_FORMAT_INT_16BIT                4
+#define AAF_FORMAT_AES3_32BIT               5
+
+#define AAF_MAX_SUMMARY_CHANNELS            64
+
+static const value_string aaf_format_vals[] = {
+    {AAF_FORMAT_USER,           "User specified"},
+    {AAF_FORMAT_FLOAT_32BIT,    "FLOAT_32BIT"},
+    {AAF_FORMAT_INT_32BIT,      "INT_32BIT"},
+    {AAF_FORMAT_INT_24BIT,      "INT_24BIT"},
+    {AAF_FORMAT_INT_16BIT,      "INT_16BIT"},
+    {AAF_FORMAT_AES3_32BIT,     "AES3_32BIT"},
+    {0,                         NULL}
+};
+
+static const value_string aaf_nsr_vals[] = {
+    {0x0, "User specified"},
+    {0x1, "8 kHz"},
+    {0x2, "16 kHz"},
+    {0x3, "32 kHz"},
+    {0x4, "44.1 kHz"},
+    {0x5, "48 kHz"},
+    {0x6, "88.2 kHz"},
+    {0x7, "96 kHz"},
+    {0x8, "176.4 kHz"},
+    {0x9, "192 kHz"},
+    {0xa, "24 kHz"},
+    {0,   NULL}
+};
+
+static const guint aaf_nsr_rates[16] = {
+    0, 8000, 16000, 32000, 44100, 48000, 88200, 96000, 176400, 192000, 24000, 0, 0, 0, 0, 0
+};
+
+/* CVF header */
+#define CVF_FORMAT_OFFSET                   16
+#define CVF_FORMAT_SUBTYPE_OFFSET           17
+#define CVF_FLAGS_OFFSET                    22
+#define CVF_H264_TIMESTAMP_OFFSET           24
+#define CVF_H264_PAYLOAD_OFFSET             28
+
+#define CVF_PTV_MASK                        0x20
+#define CVF_M_MASK                          0x10
+#define CVF_EVT_MASK                        0x0f
+
+#define CVF_FORMAT_RFC                      0x02
+#define CVF_FORMAT_SUBTYPE_MJPEG            0x00
+#define CVF_FORMAT_SUBTYPE_H264             0x01
+#define CVF_FORMAT_SUBTYPE_JPEG2000         0x02
+
+/* RFC 6184 fragmentation unit */
+#define H264_NAL_TYPE_MASK                  0x1f
+#define H264_NAL_FNRI_MASK                  0xe0
+#define H264_NAL_TYPE_FU_A                  28
+#define H264_FU_START                       0x80
+#define H264_FU_END                         0x40
+
+static const value_string cvf_format_vals[] = {
+    {CVF_FORMAT_RFC, "RFC payload type"},
+    {0,              NULL}
+};
+
+static const value_string cvf_format_subtype_vals[] = {
+    {CVF_FORMAT_SUBTYPE_MJPEG,      "MJPEG"},
+    {CVF_FORMAT_SUBTYPE_H264,       "H.264"},
+    {CVF_FORMAT_SUBTYPE_JPEG2000,   "JPEG 2000"},
+    {0,                             NULL}
+};
+
+/* CRF header */
+#define CRF_TYPE_OFFSET                     3
+#define CRF_PULL_FREQ_OFFSET                12
+#define CRF_DATA_LENGTH_OFFSET              16
+#define CRF_TIMESTAMP_INTERVAL_OFFSET       18
+#define CRF_DATA_OFFSET                     20
+
+#define CRF_FS_MASK                         0x02
+#define CRF_PULL_MASK                       0xe0000000
+#define CRF_BASE_FREQ_MASK                  0x1fffffff
+
+static const value_string crf_type_vals[] = {
+    {0, "User specified"},
+    {1, "Audio sample"},
+    {2, "Video frame"},
+    {3, "Video line"},
+    {4, "Machine cycle"},
+    {0, NULL}
+};
+
+/* Multiplier applied to the base frequency, indexed by the pull field */
+static const gdouble crf_pull_factors[8] = {
+    1.0, 1.0 / 1.001, 1.001, 24.0 / 25.0, 25.0 / 24.0, 1.0 / 8.0, 0.0, 0.0
+};
+
+static const value_string crf_pull_vals[] = {
+    {0, "1.0"},
+    {1, "1/1.001"},
+    {2, "1.001"},
+    {3, "24/25"},
+    {4, "25/24"},
+    {5, "1/8"},
+    {0, NULL}
+};
+
+/* NTSCF header */
+#define NTSCF_DATA_LENGTH_OFFSET            1
+#define NTSCF_SEQ_NUM_OFFSET                3
+#define NTSCF_STREAM_ID_OFFSET              4
+#define NTSCF_PAYLOAD_OFFSET                12
+
+#define NTSCF_DATA_LENGTH_MASK              0x07ff
+
+/* MAAP (IEEE 1722-2016 Annex B) */
+#define MAAP_MSG_TYPE_OFFSET                1
+#define MAAP_CD_LENGTH_OFFSET               2
+#define MAAP_STREAM_ID_OFFSET               4
+#define MAAP_REQ_START_ADDR_OFFSET          12
+#define MAAP_REQ_COUNT_OFFSET               18
+#define MAAP_CONFLICT_START_ADDR_OFFSET     20
+#define MAAP_CONFLICT_COUNT_OFFSET          26
+
+#define MAAP_MSG_TYPE_MASK                  0x0f
+#define MAAP_VERSION_MASK                   0xf8
+#define MAAP_CD_LENGTH_MASK                 0x07ff
+
+static const value_string maap_message_type_vals[] = {
+    {1, "PROBE"},
+    {2, "DEFEND"},
+    {3, "ANNOUNCE"},
+    {0, NULL}
+};
+
+/**********************************************************/
+/* Initialize the protocol and registered fields          */
+/**********************************************************/
+static int proto_1722 = -1;
+static int hf_1722_cdfield = -1;
+static int hf_1722_subtype = -1;
+static int hf_1722_svfield = -1;
+static int hf_1722_verfield = -1;
+static int hf_1722_mrfield = -1;
+static int hf_1722_gvfield = -1;
+static int hf_1722_tvfield = -1;
+static int hf_1722_seqnum = -1;
+static int hf_1722_tufield = -1;
+static int hf_1722_stream_id = -1;
+static int hf_1722_avbtp_timestamp = -1;
+static int hf_1722_gateway_info = -1;
+static int hf_1722_packet_data_length = -1;
+static int hf_1722_tag = -1;
+static int hf_1722_channel = -1;
+static int hf_1722_tcode = -1;
+static int hf_1722_sy = -1;
+static int hf_1722_sid = -1;
+static int hf_1722_dbs = -1;
+static int hf_1722_fn = -1;
+static int hf_1722_qpc = -1;
+static int hf_1722_sph = -1;
+static int hf_1722_dbc = -1;
+static int hf_1722_fmt = -1;
+static int hf_1722_fdf = -1;
+static int hf_1722_syt = -1;
+static int hf_1722_syt_cycle = -1;
+static int hf_1722_syt_cycle_offset = -1;
+static int hf_1722_data = -1;
+static int hf_1722_label = -1;
+static int hf_1722_sample = -1;
+
+/* Common stream header */
+static int hf_1722_format_info = -1;
+static int hf_1722_stream_data_length = -1;
+static int hf_1722_format_info2 = -1;
+static int hf_1722_payload = -1;
+
+/* AVTP over UDP */
+static int hf_1722_udp_encap_seqnum = -1;
+
+/* Stream talker, from 1722.1 */
+static int hf_1722_talker_guid = -1;
+static int hf_1722_talker_unique_id = -1;
+static int hf_1722_talker_name = -1;
+static int hf_1722_talker_stream_name = -1;
+
+/* AAF */
+static int hf_1722_aaf_format = -1;
+static int hf_1722_aaf_nsr = -1;
+static int hf_1722_aaf_channels = -1;
+static int hf_1722_aaf_bit_depth = -1;
+static int hf_1722_aaf_sp = -1;
+static int hf_1722_aaf_evt = -1;
+static int hf_1722_aaf_data = -1;
+static int hf_1722_aaf_peak = -1;
+static int hf_1722_aaf_rms = -1;
+
+/* CVF */
+static int hf_1722_cvf_format = -1;
+static int hf_1722_cvf_format_subtype = -1;
+static int hf_1722_cvf_ptv = -1;
+static int hf_1722_cvf_m = -1;
+static int hf_1722_cvf_evt = -1;
+static int hf_1722_cvf_h264_timestamp = -1;
+static int hf_1722_cvf_fragment = -1;
+static int hf_1722_cvf_reassembled_in = -1;
+static int hf_1722_cvf_reassembled_length = -1;
+static int hf_1722_cvf_nal = -1;
+
+/* CRF */
+static int hf_1722_crf_fs = -1;
+static int hf_1722_crf_type = -1;
+static int hf_1722_crf_pull = -1;
+static int hf_1722_crf_base_frequency = -1;
+static int hf_1722_crf_data_length = -1;
+static int hf_1722_crf_timestamp_interval = -1;
+static int hf_1722_crf_data = -1;
+static int hf_1722_crf_timestamp = -1;
+static int hf_1722_crf_nominal_frequency = -1;
+
+/* NTSCF */
+static int hf_1722_ntscf_data_length = -1;
+
+/* MAAP */
+static int hf_1722_maap_message_type = -1;
+static int hf_1722_maap_version = -1;
+static int hf_1722_maap_cd_length = -1;
+static int hf_1722_maap_req_start_addr = -1;
+static int hf_1722_maap_req_count = -1;
+static int hf_1722_maap_conflict_start_addr = -1;
+static int hf_1722_maap_conflict_count = -1;
+
+/* Sequence number analysis */
+static int hf_1722_analysis_lost = -1;
+static int hf_1722_analysis_expected_seqnum = -1;
+static int hf_1722_analysis_duplicate = -1;
+static int hf_1722_analysis_out_of_order = -1;
+static int hf_1722_analysis_pt_margin = -1;
+static int hf_1722_analysis_transit_jitter = -1;
+static int hf_1722_analysis_clock_drift = -1;
+static int hf_1722_analysis_clock_jitter = -1;
+static int hf_1722_analysis_expected_dbc = -1;
+static int hf_1722_analysis_blocks_lost = -1;
+static int hf_1722_analysis_blocks_repeated = -1;
+static int hf_1722_analysis_syt_backwards = -1;
+static int hf_1722_analysis_sr_class = -1;
+static int hf_1722_analysis_interval_frames = -1;
+static int hf_1722_analysis_reserved_frames = -1;
+static int hf_1722_analysis_window_bandwidth = -1;
+static int hf_1722_analysis_reserved_bandwidth = -1;
+
+/* Initialize the subtree pointers */
+static int ett_1722 = -1;
+static int ett_1722_audio = -1;
+static int ett_1722_sample = -1;
+static int ett_1722_syt = -1;
+static int ett_1722_analysis = -1;
+static int ett_1722_crf_data = -1;
+static int ett_1722_cvf_fragment = -1;
+static int ett_1722_aaf_audio = -1;
+static int ett_1722_aaf_channel = -1;
+
+/* Audio sample tree rendering */
+#define SAMPLE_TREE_FULL        0
+#define SAMPLE_TREE_SUMMARY     1
+
+static const enum_val_t sample_tree_modes[] = {
+    {"full",    "Full sample tree",                 SAMPLE_TREE_FULL},
+    {"summary", "Summary, samples on expansion",    SAMPLE_TREE_SUMMARY},
+    {NULL, NULL, 0}
+};
+
+static gint ieee1722_sample_tree_mode = SAMPLE_TREE_FULL;
+static guint ieee1722_max_sample_blocks = 0;
+
+/* AM824 labels (IEC 61883-6) */
+static const value_string am824_label_vals[] = {
+    {0x40, "MBLA 24-bit"},
+    {0x41, "MBLA 20-bit"},
+    {0x42, "MBLA 16-bit"},
+    {0x43, "MBLA raw"},
+    {0x80, "MIDI 1 byte"},
+    {0x81, "MIDI 2 bytes"},
+    {0x82, "MIDI 3 bytes"},
+    {0x83, "MIDI no data"},
+    {0,    NULL}
+};
+
+/* Per-stream analysis.
+ *
+ * Each stream keeps the highest sequence number seen and a bitmap of the
+ * SEQ_WINDOW_SIZE sequence numbers below it, so a frame is classified as
+ * in order, lost-before, duplicate or out of order with one hash lookup
+ * and a few bit operations.  When presentation time analysis is enabled
+ * the stream also carries its unwrapped AVTP timestamp and an RFC 3550
+ * style transit jitter estimate, so the cost stays O(1) per packet with
+ * constant state per stream.  Only frames with something to report get
+ * per-frame data.  Streams live in a capacity-limited state table (see
+ * ieee1722-state.h), which also owns everything allocated for them below;
+ * a stream evicted for lack of room starts over if it shows up again.
+ */
+#define SEQ_WINDOW_SIZE         64
+
+/* Media clock estimator.
+ *
+ * Each timestamp i of a stream is the gPTP time of media clock event k_i.
+ * The phase error against the nominal clock, ts_i - ts_0 - (k_i - k_0) *
+ * period, is fitted against k_i with an exponentially weighted least
+ * squares line: the slope gives the frequency offset in ppm and the
+ * weighted RMS of the residuals the phase jitter.  Weights start at 1/n,
+ * i.e. a plain running (Welford) regression, and settle at
+ * period / clock_window so the estimate follows the last few seconds of a
+ * long capture with a handful of doubles per stream.
+ *
+ * CRF events are counted in timestamp intervals.  For 61883-6 an event is
+ * one SYT_INTERVAL of data blocks: DBC is unwrapped into a running block
+ * count, and the AVTP timestamp is the presentation time of the block
+ * whose DBC is a multiple of SYT_INTERVAL, so no rounding is involved.
+ *
+ * The estimate is attached to one timestamped packet in
+ * CLOCK_REPORT_INTERVAL, so a 61883 stream does not need per-frame data
+ * for every frame; discontinuities are attached to every frame they hit.
+ */
+#define CLOCK_MIN_TIMESTAMPS    8
+#define CLOCK_REPORT_INTERVAL   16
+
+typedef struct _media_clock {
+    gboolean mr;                /* media reset bit of the previous packet */
+    guint64 first_ts;
+    guint64 last_ts;
+    gint64  first_event;        /* k of first_ts */
+    gint64  last_event;         /* k of last_ts */
+    gdouble period_ns;          /* nominal time between events */
+    gdouble min_weight;         /* period / clock_window */
+    guint32 timestamps;         /* 0 restarts the fit at the next timestamp */
+    guint32 unreported;         /* packets since the estimate was last reported */
+    gdouble mean_event;
+    gdouble mean_phase_ns;
+    gdouble var_event;
+    gdouble cov_ns;
+    gdouble residual_var_ns2;
+} media_clock_t;
+
+/* 61883-6 AM824 data block continuity.
+ *
+ * DBC counts data blocks modulo 256, so the DBC and block count of one
+ * packet predict the DBC of the next.  A difference is a number of blocks
+ * skipped (ahead) or repeated (behind), which shows up even when the
+ * sequence numbers are in order; across a sequence gap it is the number of
+ * blocks the lost packets carried.  DBC is also unwrapped into a running
+ * block count for the media clock, and the last usable SYT is kept to
+ * catch SYT stepping backwards.
+ */
+typedef struct _am824_track {
+    guint8  last_seqnum;
+    guint8  last_dbc;
+    guint8  last_blocks;
+    guint8  syt_seqnum;         /* sequence number of the packet with last_syt_ticks */
+    gint    last_syt_ticks;     /* -1 until a usable SYT is seen */
+    gint64  block;              /* unwrapped DBC of the previous packet */
+    guint16 datalen;            /* blocks = datalen / (dbs * 4), kept to save */
+    guint8  dbs;                /* a division per packet */
+    guint8  blocks;
+} am824_track_t;
+
+/* SR class bandwidth.
+ *
+ * The frames and bytes of a stream are counted per SR class interval of
+ * capture time (125 us for class A, 250 us for class B) in a ring of the
+ * last BW_WINDOW_INTERVALS intervals, with running totals over the ring,
+ * so the state is the same size however long the capture.  The class
+ * comes from the ACMP exchange that set the stream up (class A until one
+ * is seen) and the reservation from the stream format: the frames per
+ * interval its packet rate needs, rounded up, as for MaxIntervalFrames.
+ * Both are refreshed once per window.
+ */
+#define BW_WINDOW_INTERVALS     32      /* a power of two */
+#define BW_CLASS_A_INTERVAL_NS  125000
+#define BW_CLASS_B_INTERVAL_NS  250000
+
+static const value_string sr_class_vals[] = {
+    {0, "A"},
+    {1, "B"},
+    {0, NULL}
+};
+
+typedef struct _bw_track {
+    gint64  interval;           /* number of the current class interval */
+    gint64  interval_end_ns;    /* capture time the next one starts */
+    guint32 interval_ns;
+    gboolean class_b;
+    gboolean class_known;
+    guint16 reserved_frames;    /* per interval; 0 if the format doesn't say */
+    guint16 intervals;          /* in the window so far, up to BW_WINDOW_INTERVALS */
+    gboolean oversubscribed;    /* reported until the window drops back */
+    guint32 window_frames;
+    guint32 window_bytes;
+    guint16 frames[BW_WINDOW_INTERVALS];
+    guint32 bytes[BW_WINDOW_INTERVALS];
+} bw_track_t;
+
+/* CVF H.264 reassembly.
+ *
+ * FU-A fragments of a NAL unit arrive in consecutive packets of one
+ * stream.  The pieces are gathered in fixed-size chunks owned by the
+ * stream and charged to the state budget.  A stream keeps one chunk of its
+ * previous NAL for the next one, so a stream of NALs that fit in a chunk
+ * costs no malloc/free per fragment, and gives the others back.  No NAL
+ * may take more than a quarter of the budget.  A NAL whose end
+ * was lost is reported incomplete, and so is the NAL a stream was
+ * gathering when it was evicted.
+ *
+ * With ieee1722_state_revisit, each NAL is seasonal memory, every fragment
+ * frame points to it from its per-frame data and the finished NAL is
+ * copied out into seasonal memory, so it can be shown again.  Without it,
+ * the NAL being gathered is part of the stream and the finished one is
+ * only copied into packet memory, for the frame that completes it.
+ */
+#define CVF_CHUNK_SIZE          16384
+
+typedef struct _cvf_chunk {
+    struct _cvf_chunk *next;
+    guint   len;
+    guint8  data[CVF_CHUNK_SIZE];
+} cvf_chunk_t;
+
+typedef struct _cvf_nal {
+    guint32 first_frame;
+    guint32 reassembled_in;     /* 0 until the end fragment is seen */
+    gboolean incomplete;        /* a fragment was lost or the NAL was too big */
+    guint32 fragments;
+    guint32 length;
+    guint8 *data;               /* NAL header and body once reassembled */
+} cvf_nal_t;
+
+typedef struct _cvf_reassembly {
+    cvf_nal_t   *nal;           /* NAL being gathered, or NULL */
+    cvf_nal_t   current;        /* it, unless kept for revisiting */
+    cvf_chunk_t *head;
+    cvf_chunk_t *tail;
+    cvf_chunk_t *spare;         /* for the next NAL */
+    guint8  next_seqnum;
+} cvf_reassembly_t;
+
+/* What fragments whose NAL's start was lost belong to */
+static cvf_nal_t cvf_lost_nal = { 0, 0, TRUE, 0, 0, NULL };
+
+typedef struct _avtp_stream {
+    guint64 stream_id;
+    guint32 packets;
+    guint8  highest_seqnum;
+    guint64 seq_window;
+    /* Presentation time analysis */
+    gboolean pt_valid;
+    gint64  last_pt_ns;
+    gint64  last_transit_ns;
+    gint64  jitter_x16_ns;
+    /* Media clock, allocated on the first CRF or 61883-6 packet */
+    media_clock_t *clock;
+    /* 61883-6 continuity, allocated on the first AM824 packet */
+    am824_track_t *am824;
+    /* CVF reassembly, allocated on the first FU-A fragment */
+    cvf_reassembly_t *cvf;
+    /* SR class bandwidth, allocated on the first packet */
+    bw_track_t *bw;
+} avtp_stream_t;
+
+typedef struct _avtp_frame_info {
+    guint8  seq_status;
+    guint8  expected_seqnum;
+    guint8  lost;
+    gboolean has_pt;
+    gint64  pt_margin_ns;
+    guint32 transit_jitter_ns;
+    gboolean has_clock;
+    gfloat  clock_drift_ppm;
+    gfloat  clock_jitter_ns;
+    guint8  clock_faults;       /* IEEE1722_CLOCK_xxx */
+    guint16 syt_backwards_ticks;
+    guint8  dbc_status;         /* IEEE1722_DBC_xxx */
+    guint8  expected_dbc;
+    guint8  dbc_blocks;         /* blocks skipped, lost or repeated */
+    guint8  bw_faults;          /* IEEE1722_BW_xxx */
+    gboolean class_b;
+    gboolean class_known;
+    guint16 interval_frames;
+    guint16 reserved_frames;
+    guint32 window_kbps;
+    guint32 reserved_kbps;
+    gboolean analyzed;          /* the stream analysis found something */
+    cvf_nal_t *cvf_nal;         /* NAL of a CVF fragment, when kept */
+} avtp_frame_info_t;
+
+static ieee1722_state_table_t *avtp_streams = NULL;
+
+static int ieee1722_tap = -1;
+
+static gboolean ieee1722_analyze_seqnum = TRUE;
+static gboolean ieee1722_analyze_pt = FALSE;
+static guint ieee1722_latency_budget_us = 2000;
+static guint ieee1722_capture_clock_offset = 0;
+static gboolean ieee1722_analyze_dbc = TRUE;
+static gboolean ieee1722_analyze_clock = TRUE;
+static gboolean ieee1722_analyze_bandwidth = TRUE;
+static guint ieee1722_clock_window_s = 10;
+static gboolean ieee1722_reassemble_cvf = TRUE;
+static guint ieee1722_cvf_max_nal_kb = 2048;
+static guint ieee1722_udp_port = AVTP_UDP_PORT;
+static gboolean ieee1722_udp_heuristic = TRUE;
+
+static dissector_handle_t h264_handle;
+
+static dissector_table_t avb_dissector_table;
+
+/* Subtype dispatch.
+ *
+ * One entry per value of the first octet, so dispatch is a single array
+ * load.  Formats decoded in this file have a dissect function and are
+ * filled in by proto_reg_handoff_1722(); the others are looked up once per
+ * capture in the "ieee1722.subtype" table, so 1722.1 and Decode As
+ * dissectors are called through the same array.
+ */
+typedef void (*avtp_subtype_dissector_t)(tvbuff_t *tvb, packet_info *pinfo, proto_tree *ieee1722_tree,
+                                         ieee1722_tap_info_t *tap_info);
+
+/* Format specific part of the first-pass stream analysis */
+typedef void (*avtp_stream_analyzer_t)(tvbuff_t *tvb, avtp_stream_t *stream, avtp_frame_info_t *frame);
+
+/* Packets per second the stream format in this packet's header implies,
+ * or 0 if it doesn't say */
+typedef gdouble (*avtp_packet_rate_t)(tvbuff_t *tvb);
+
+typedef struct _avtp_subtype_entry {
+    avtp_subtype_dissector_t dissect;   /* built-in format, or NULL */
+    dissector_handle_t handle;          /* registered sub-dissector, or NULL */
+    avtp_stream_analyzer_t analyze;     /* format specific analysis, or NULL */
+    avtp_packet_rate_t packet_rate;     /* for the SR class reservation, or NULL */
+    gint seqnum_offset;                 /* stream formats only, else -1 */
+    gboolean has_timestamp;             /* avtp_timestamp at IEEE_1722_TIMESTAMP_OFFSET */
+} avtp_subtype_entry_t;
+
+static avtp_subtype_entry_t avtp_subtypes[256];
+
+static void cvf_release(cvf_reassembly_t *r);
+static void cvf_abandon(cvf_reassembly_t *r);
+static void cvf_free_chunks(cvf_chunk_t *chunk);
+
+/* Set while the previous capture's streams are freed, when the NALs they
+ * were gathering have already gone with the seasonal memory */
+static gboolean avtp_streams_closing = FALSE;
+
+/* Release what a stream owns when it is evicted or the capture closed */
+static void avtp_stream_free(gpointer data)
+{
+    avtp_stream_t *stream = data;
+
+    if (stream->cvf) {
+        if (avtp_streams_closing)
+            cvf_release(stream->cvf);
+        else
+            cvf_abandon(stream->cvf);
+        cvf_free_chunks(stream->cvf->spare);
+        g_free(stream->cvf);
+    }
+    g_free(stream->clock);
+    g_free(stream->am824);
+    g_free(stream->bw);
+}
+
+static void ieee1722_init(void)
+{
+    guint i;
+
+    avtp_streams_closing = TRUE;
+    ieee1722_state_table_destroy(avtp_streams);
+    avtp_streams_closing = FALSE;
+    avtp_streams = ieee1722_state_table_new("AVTP streams", sizeof(avtp_stream_t), sizeof(guint64),
+                                            g_int64_hash, g_int64_equal, avtp_stream_free);
+
+    /* Pick up sub-dissectors registered by other modules or via Decode As */
+    for (i = 0; i < G_N_ELEMENTS(avtp_subtypes); i++) {
+        if (avtp_subtypes[i].dissect == NULL)
+            avtp_subtypes[i].handle = dissector_get_uint_handle(avb_dissector_table, i);
+    }
+}
+
+static avtp_stream_t *ieee1722_stream_lookup(guint64 stream_id)
+{
+    avtp_stream_t *stream;
+
+    stream = ieee1722_state_lookup(avtp_streams, &stream_id);
+    if (stream == NULL)
+        stream = ieee1722_state_insert(avtp_streams, &stream_id);
+    return stream;
+}
+
+static void ieee1722_track_seqnum(avtp_stream_t *stream, guint8 seqnum, avtp_frame_info_t *frame)
+{
+    guint8 delta;
+
+    if (stream->packets == 0) {
+        stream->highest_seqnum = seqnum;
+        stream->seq_window = 1;
+        return;
+    }
+
+    delta = seqnum - stream->highest_seqnum;
+    if (delta == 0) {
+        frame->seq_status = IEEE1722_SEQ_DUPLICATE;
+    }
+    else if (delta < 128) {
+        /* Moving forward; anything skipped is presumed lost for now */
+        if (delta > 1) {
+            frame->seq_status = IEEE1722_SEQ_LOST;
+            frame->expected_seqnum = stream->highest_seqnum + 1;
+            frame->lost = delta - 1;
+        }
+        stream->seq_window = (delta < SEQ_WINDOW_SIZE) ? (stream->seq_window << delta) | 1 : 1;
+        stream->highest_seqnum = seqnum;
+    }
+    else {
+        guint8 behind = -delta;
+
+        frame->expected_seqnum = stream->highest_seqnum + 1;
+        if (behind < SEQ_WINDOW_SIZE && (stream->seq_window & ((guint64)1 << behind))) {
+            frame->seq_status = IEEE1722_SEQ_DUPLICATE;
+        }
+        else {
+            frame->seq_status = IEEE1722_SEQ_OUT_OF_ORDER;
+            if (behind < SEQ_WINDOW_SIZE)
+                stream->seq_window |= (guint64)1 << behind;
+        }
+    }
+}
+
+/* The AVTP timestamp is the low 32 bits of the gPTP time in ns.  The first
+ * timestamp of a stream is unwrapped against the capture time (which must
+ * be gPTP-synchronised to within about two seconds), later ones against
+ * the previous timestamp of the same stream.
+ */
+static void ieee1722_track_presentation_time(avtp_stream_t *stream, packet_info *pinfo,
+                                             guint32 timestamp, avtp_frame_info_t *frame)
+{
+    gint64 capture_ns;
+    gint64 pt_ns;
+    gint64 transit_ns;
+    gint64 d;
+
+    capture_ns = ((gint64)pinfo->fd->abs_ts.secs + ieee1722_capture_clock_offset) * 1000000000 +
+                 pinfo->fd->abs_ts.nsecs;
+
+    if (stream->pt_valid)
+        pt_ns = stream->last_pt_ns + (gint32)(timestamp - (guint32)stream->last_pt_ns);
+    else
+        pt_ns = capture_ns + (gint32)(timestamp - (guint32)capture_ns);
+
+    transit_ns = capture_ns - pt_ns;
+    if (stream->pt_valid) {
+        d = transit_ns - stream->last_transit_ns;
+        if (d < 0)
+            d = -d;
+        stream->jitter_x16_ns += d - ((stream->jitter_x16_ns + 8) >> 4);
+    }
+    stream->pt_valid = TRUE;
+    stream->last_pt_ns = pt_ns;
+    stream->last_transit_ns = transit_ns;
+
+    frame->has_pt = TRUE;
+    frame->pt_margin_ns = pt_ns - capture_ns;
+    frame->transit_jitter_ns = (guint32)MIN(stream->jitter_x16_ns >> 4, G_MAXUINT32);
+}
+
+static void media_clock_reset(media_clock_t *clock, guint64 ts, gint64 event, gdouble period_ns)
+{
+    clock->first_ts = ts;
+    clock->last_ts = ts;
+    clock->first_event = event;
+    clock->last_event = event;
+    clock->period_ns = period_ns;
+    clock->min_weight = period_ns / (MAX(ieee1722_clock_window_s, 1) * 1e9);
+    clock->timestamps = 0;
+    clock->mean_event = 0.0;
+    clock->mean_phase_ns = 0.0;
+    clock->var_event = 0.0;
+    clock->cov_ns = 0.0;
+    clock->residual_var_ns2 = 0.0;
+}
+
+static void media_clock_add(media_clock_t *clock, guint64 ts, gint64 event)
+{
+    gdouble weight;
+    gdouble phase_ns;
+    gdouble k;
+    gdouble d_event;
+    gdouble d_phase;
+
+    k = (gdouble)(event - clock->first_event);
+    phase_ns = (gdouble)(ts - clock->first_ts) - k * clock->period_ns;
+    weight = MAX(1.0 / (clock->timestamps + 1), clock->min_weight);
+
+    if (clock->timestamps >= 2) {
+        gdouble residual_ns = phase_ns - clock->mean_phase_ns;
+
+        if (clock->var_event > 0.0)
+            residual_ns -= clock->cov_ns / clock->var_event * (k - clock->mean_event);
+        clock->residual_var_ns2 += weight * (residual_ns * residual_ns - clock->residual_var_ns2);
+    }
+
+    d_event = k - clock->mean_event;
+    d_phase = phase_ns - clock->mean_phase_ns;
+    clock->mean_event += weight * d_event;
+    clock->mean_phase_ns += weight * d_phase;
+    clock->var_event = (1.0 - weight) * (clock->var_event + weight * d_event * d_event);
+    clock->cov_ns = (1.0 - weight) * (clock->cov_ns + weight * d_event * d_phase);
+
+    clock->last_ts = ts;
+    clock->last_event = event;
+    clock->timestamps++;
+}
+
+static void media_clock_report(media_clock_t *clock, avtp_frame_info_t *frame)
+{
+    if (++clock->unreported < CLOCK_REPORT_INTERVAL)
+        return;
+    if (clock->timestamps >= CLOCK_MIN_TIMESTAMPS && clock->var_event > 0.0) {
+        clock->unreported = 0;
+        frame->has_clock = TRUE;
+        /* A fast media clock has timestamps closer together than nominal */
+        frame->clock_drift_ppm = (gfloat)(-clock->cov_ns / clock->var_event / clock->period_ns * 1e6);
+        frame->clock_jitter_ns = (gfloat)sqrt(clock->residual_var_ns2);
+    }
+}
+
+static void crf_clock_update(media_clock_t *clock, guint64 ts)
+{
+    gint64 event = clock->last_event;
+
+    if (clock->timestamps > 0) {
+        /* Lost packets show up as a multi-interval step; a clock that does
+         * not advance restarts the fit.
+         */
+        if (ts <= clock->last_ts) {
+            media_clock_reset(clock, ts, 0, clock->period_ns);
+            event = 0;
+        }
+        else {
+            event += (gint64)((gdouble)(ts - clock->last_ts) / clock->period_ns + 0.5);
+            if (event == clock->last_event)
+                return;
+        }
+    }
+    media_clock_add(clock, ts, event);
+}
+
+/* Feed the timestamps of a CRF packet to the stream's media clock estimator */
+static void ieee1722_track_crf(tvbuff_t *tvb, avtp_stream_t *stream, avtp_frame_info_t *frame)
+{
+    media_clock_t *clock;
+    guint32 pull_freq;
+    guint16 interval;
+    gdouble nominal_hz;
+    gdouble period_ns;
+    gboolean mr;
+    gint count;
+    gint offset;
+
+    pull_freq = tvb_get_ntohl(tvb, CRF_PULL_FREQ_OFFSET);
+    interval = tvb_get_ntohs(tvb, CRF_TIMESTAMP_INTERVAL_OFFSET);
+    nominal_hz = (pull_freq & CRF_BASE_FREQ_MASK) * crf_pull_factors[pull_freq >> 29];
+    if (nominal_hz <= 0.0 || interval == 0)
+        return;
+    period_ns = interval * 1e9 / nominal_hz;
+
+    count = MIN(tvb_get_ntohs(tvb, CRF_DATA_LENGTH_OFFSET),
+                tvb_length_remaining(tvb, CRF_DATA_OFFSET)) / 8;
+    if (count <= 0)
+        return;
+
+    mr = (tvb_get_guint8(tvb, IEEE_1722_VERSION_OFFSET) & IEEE_1722_MR_MASK) != 0;
+
+    clock = stream->clock;
+    if (clock == NULL) {
+        clock = stream->clock = ieee1722_state_alloc0(stream, sizeof(media_clock_t));
+        media_clock_reset(clock, tvb_get_ntoh64(tvb, CRF_DATA_OFFSET), 0, period_ns);
+    }
+    else if (mr != clock->mr || period_ns != clock->period_ns) {
+        /* Media clock restarted or changed rate */
+        media_clock_reset(clock, tvb_get_ntoh64(tvb, CRF_DATA_OFFSET), 0, period_ns);
+    }
+    clock->mr = mr;
+
+    for (offset = CRF_DATA_OFFSET; count > 0; count--, offset += 8)
+        crf_clock_update(clock, tvb_get_ntoh64(tvb, offset));
+
+    media_clock_report(clock, frame);
+}
+
+/* IEC 61883-6 nominal sample rate, log2 of SYT_INTERVAL and the time one
+ * SYT_INTERVAL lasts, by the SFC in FDF
+ */
+static const guint am824_sfc_rates[8] = {
+    32000, 44100, 48000, 88200, 96000, 176400, 192000, 0
+};
+static const guint8 am824_syt_interval_shifts[8] = {
+    3, 3, 3, 4, 4, 5, 5, 0
+};
+static const gdouble am824_syt_periods_ns[8] = {
+    8e9 / 32000, 8e9 / 44100, 8e9 / 48000, 16e9 / 88200, 16e9 / 96000,
+    32e9 / 176400, 32e9 / 192000, 0.0
+};
+
+/* CIP payload length claimed by pkt_data_length, clamped to the frame */
+static guint ieee1722_61883_datalen(tvbuff_t *tvb, guint16 pkt_data_length)
+{
+    gint available = tvb_reported_length_remaining(tvb, IEEE_1722_DATA_OFFSET);
+
+    if (pkt_data_length < IEEE_1722_CIP_HEADER_SIZE)
+        return 0;
+    return MIN(pkt_data_length - IEEE_1722_CIP_HEADER_SIZE, (guint)MAX(available, 0));
+}
+
+/* SYT as a tick count within its 16 cycle (2 ms) range, or -1 if unusable */
+static gint syt_ticks(guint16 syt)
+{
+    guint cycle_offset = syt & IEEE_1722_SYT_CYCLE_OFFSET_MASK;
+
+    if (syt == IEEE_1722_SYT_NO_INFO || cycle_offset >= IEEE_1722_SYT_TICKS_PER_CYCLE)
+        return -1;
+    return (syt >> 12) * IEEE_1722_SYT_TICKS_PER_CYCLE + cycle_offset;
+}
+
+/* Check DBC continuity of a 61883-6 AM824 stream, then track its SYT and
+ * feed its timestamps to the media clock estimator.  SYT must not step
+ * back by more than half its 2 ms range between packets a few sequence
+ * numbers apart.  Unexplained DBC, a gap too long to count blocks across,
+ * a media reset or a rate change restarts the fit.
+ */
+static void ieee1722_track_61883(tvbuff_t *tvb, avtp_stream_t *stream, avtp_frame_info_t *frame)
+{
+    am824_track_t *am;
+    media_clock_t *clock;
+    const guint8 *raw;
+    guint16 pkt_data_length;
+    guint16 syt;
+    guint8 seqnum;
+    guint8 dbc;
+    guint8 dbs;
+    guint8 fdf;
+    guint8 step;
+    guint8 expected;
+    guint8 delta;
+    guint8 sfc;
+    guint8 syt_interval_mask;
+    guint8 first_event_block;
+    guint8 blocks;
+    guint8 dbc_status = IEEE1722_DBC_OK;
+    guint datalen = 0;
+    gint ticks;
+    gdouble period_ns;
+    gboolean mr;
+    guint32 timestamp;
+    guint64 ts;
+    gint64 event;
+
+    if (tvb_length(tvb) < IEEE_1722_DATA_OFFSET)
+        return;
+    raw = tvb_get_ptr(tvb, 0, IEEE_1722_DATA_OFFSET);
+    if ((raw[IEEE_1722_FMT_OFFSET] & IEEE_1722_FMT_MASK) != IEEE_1722_FMT_AM824)
+        return;
+
+    seqnum = raw[IEEE_1722_SEQ_NUM_OFFSET];
+    dbc = raw[IEEE_1722_DBC_OFFSET];
+    dbs = raw[IEEE_1722_DBS_OFFSET];
+    fdf = raw[IEEE_1722_FDF_OFFSET];
+    syt = pntohs(raw + IEEE_1722_SYT_OFFSET);
+    pkt_data_length = pntohs(raw + IEEE_1722_PKT_DATA_LENGTH_OFFSET);
+    if (fdf != IEEE_1722_FDF_NO_DATA)
+        datalen = ieee1722_61883_datalen(tvb, pkt_data_length);
+
+    am = stream->am824;
+    if (am == NULL) {
+        am = stream->am824 = ieee1722_state_alloc0(stream, sizeof(am824_track_t));
+        am->last_syt_ticks = -1;
+        am->block = dbc;
+    }
+    else {
+        step = seqnum - am->last_seqnum;
+        /* Duplicates and late packets add nothing */
+        if (step == 0 || step >= 128)
+            return;
+
+        /* Blocks can only be counted across a gap of up to 255 */
+        expected = am->last_dbc + am->last_blocks;
+        delta = dbc - expected;
+        if (step > 1 && (guint)(step - 1) * am->last_blocks >= 256) {
+            if (stream->clock)
+                stream->clock->timestamps = 0;
+        }
+        else if (delta != 0) {
+            if (step > 1)
+                dbc_status = IEEE1722_DBC_LOST;
+            else if (delta < 128)
+                dbc_status = IEEE1722_DBC_SKIPPED;
+            else
+                dbc_status = IEEE1722_DBC_REPEATED;
+            if (dbc_status != IEEE1722_DBC_LOST && stream->clock)
+                stream->clock->timestamps = 0;
+            if (ieee1722_analyze_dbc) {
+                frame->dbc_status = dbc_status;
+                frame->expected_dbc = expected;
+                frame->dbc_blocks = dbc_status == IEEE1722_DBC_REPEATED ? (guint8)-delta : delta;
+            }
+        }
+        am->block += (guint8)(dbc - am->last_dbc);
+    }
+
+    /* Blocks in this packet, for the DBC of the next one */
+    if (datalen != am->datalen || dbs != am->dbs) {
+        am->datalen = datalen;
+        am->dbs = dbs;
+        am->blocks = dbs != 0 ? MIN(datalen / (dbs * 4), G_MAXUINT8) : 0;
+    }
+    blocks = am->blocks;
+    am->last_seqnum = seqnum;
+    am->last_dbc = dbc;
+    am->last_blocks = blocks;
+
+    if (!ieee1722_analyze_clock)
+        return;
+
+    ticks = syt_ticks(syt);
+    if (ticks >= 0) {
+        if (am->last_syt_ticks >= 0 && (guint8)(seqnum - am->syt_seqnum) <= 4) {
+            gint syt_delta = (ticks - am->last_syt_ticks + IEEE_1722_SYT_TICKS_WRAP) % IEEE_1722_SYT_TICKS_WRAP;
+
+            if (syt_delta > IEEE_1722_SYT_TICKS_WRAP / 2) {
+                frame->clock_faults |= IEEE1722_CLOCK_SYT_BACKWARDS;
+                frame->syt_backwards_ticks = IEEE_1722_SYT_TICKS_WRAP - syt_delta;
+            }
+        }
+        am->last_syt_ticks = ticks;
+        am->syt_seqnum = seqnum;
+    }
+
+    sfc = fdf & IEEE_1722_FDF_SFC_MASK;
+    if (fdf == IEEE_1722_FDF_NO_DATA || am824_sfc_rates[sfc] == 0)
+        return;
+
+    clock = stream->clock;
+    if (clock == NULL)
+        clock = stream->clock = ieee1722_state_alloc0(stream, sizeof(media_clock_t));
+
+    period_ns = am824_syt_periods_ns[sfc];
+    mr = (raw[IEEE_1722_VERSION_OFFSET] & IEEE_1722_MR_MASK) != 0;
+    if (mr != clock->mr || period_ns != clock->period_ns)
+        clock->timestamps = 0;
+    clock->mr = mr;
+    clock->period_ns = period_ns;
+
+    /* The timestamp belongs to the first block with DBC mod SYT_INTERVAL == 0 */
+    syt_interval_mask = (1 << am824_syt_interval_shifts[sfc]) - 1;
+    first_event_block = -dbc & syt_interval_mask;
+    if (!(raw[IEEE_1722_VERSION_OFFSET] & IEEE_1722_TV_MASK) || first_event_block >= blocks)
+        return;
+    event = (am->block + first_event_block) >> am824_syt_interval_shifts[sfc];
+    timestamp = pntohl(raw + IEEE_1722_TIMESTAMP_OFFSET);
+
+    if (clock->timestamps == 0) {
+        /* Start above 2^32 so that unwrapping never goes below zero */
+        ts = G_GUINT64_CONSTANT(0x100000000) + timestamp;
+        media_clock_reset(clock, ts, event, period_ns);
+    }
+    else {
+        ts = clock->last_ts + (gint32)(timestamp - (guint32)clock->last_ts);
+        if (ts <= clock->last_ts || event <= clock->last_event) {
+            /* Restart from the next timestamp in case this one is the odd one out */
+            clock->timestamps = 0;
+            return;
+        }
+    }
+    media_clock_add(clock, ts, event);
+    media_clock_report(clock, frame);
+}
+
+/* Bytes per AAF sample */
+static guint aaf_sample_size(guint8 format)
+{
+    switch (format) {
+        case AAF_FORMAT_INT_16BIT:
+            return 2;
+        case AAF_FORMAT_INT_24BIT:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+/* Audio frames (one sample per channel) carried by an AAF packet */
+static guint aaf_audio_frames(tvbuff_t *tvb)
+{
+    guint channels = tvb_get_ntohs(tvb, AAF_CHANNELS_OFFSET) & AAF_CHANNELS_MASK;
+    guint16 datalen = tvb_get_ntohs(tvb, AVTP_STREAM_DATA_LENGTH_OFFSET);
+    gint remaining = tvb_length_remaining(tvb, AVTP_STREAM_PAYLOAD_OFFSET);
+
+    if (channels == 0)
+        return 0;
+    return MIN(datalen, MAX(remaining, 0)) /
+           (channels * aaf_sample_size(tvb_get_guint8(tvb, AAF_FORMAT_OFFSET)));
+}
+
+/* Packet rates implied by the stream formats: samples per second over
+ * samples per packet, or CRF timestamps per second over timestamps per PDU
+ */
+static gdouble ieee1722_61883_packet_rate(tvbuff_t *tvb)
+{
+    guint8 fdf = tvb_get_guint8(tvb, IEEE_1722_FDF_OFFSET);
+    guint8 dbs = tvb_get_guint8(tvb, IEEE_1722_DBS_OFFSET);
+    guint blocks;
+
+    if ((tvb_get_guint8(tvb, IEEE_1722_FMT_OFFSET) & IEEE_1722_FMT_MASK) != IEEE_1722_FMT_AM824 ||
+        fdf == IEEE_1722_FDF_NO_DATA || dbs == 0)
+        return 0.0;
+    blocks = ieee1722_61883_datalen(tvb, tvb_get_ntohs(tvb, IEEE_1722_PKT_DATA_LENGTH_OFFSET)) / (dbs * 4);
+    if (blocks == 0)
+        return 0.0;
+    return (gdouble)am824_sfc_rates[fdf & IEEE_1722_FDF_SFC_MASK] / blocks;
+}
+
+static gdouble ieee1722_aaf_packet_rate(tvbuff_t *tvb)
+{
+    guint frames = aaf_audio_frames(tvb);
+
+    if (frames == 0)
+        return 0.0;
+    return (gdouble)aaf_nsr_rates[(tvb_get_guint8(tvb, AAF_NSR_OFFSET) & AAF_NSR_MASK) >> 4] / frames;
+}
+
+static gdouble ieee1722_crf_packet_rate(tvbuff_t *tvb)
+{
+    guint32 pull_freq = tvb_get_ntohl(tvb, CRF_PULL_FREQ_OFFSET);
+    guint16 interval = tvb_get_ntohs(tvb, CRF_TIMESTAMP_INTERVAL_OFFSET);
+    guint count = tvb_get_ntohs(tvb, CRF_DATA_LENGTH_OFFSET) / 8;
+
+    if (interval == 0 || count == 0)
+        return 0.0;
+    return (pull_freq & CRF_BASE_FREQ_MASK) * crf_pull_factors[pull_freq >> 29] / ((gdouble)interval * count);
+}
+
+/* Take the SR class and reservation of a stream afresh */
+static void bw_track_refresh(bw_track_t *bw, tvbuff_t *tvb, const avtp_subtype_entry_t *entry,
+                             guint64 stream_id)
+{
+    const ieee17221_stream_talker_t *talker = ieee17221_stream_talker(stream_id);
+    gdouble rate;
+
+    bw->class_known = talker != NULL;
+    bw->class_b = talker != NULL && talker->class_b;
+    bw->interval_ns = bw->class_b ? BW_CLASS_B_INTERVAL_NS : BW_CLASS_A_INTERVAL_NS;
+    rate = entry->packet_rate ? entry->packet_rate(tvb) : 0.0;
+    /* Allow for the rate being a hair over a whole number of frames */
+    if (rate > 0.0)
+        bw->reserved_frames = (guint16)MIN(ceil(rate * bw->interval_ns / 1e9 - 1e-6), 0xffff);
+}
+
+/* Count a frame in its SR class interval and check the stream keeps to its
+ * reservation.  One frame over, in an interval or across the window, is
+ * let through as capture timestamp jitter; a window over its reservation
+ * is reported once until it drops back.
+ */
+static void ieee1722_track_bandwidth(tvbuff_t *tvb, packet_info *pinfo, const avtp_subtype_entry_t *entry,
+                                     avtp_stream_t *stream, avtp_frame_info_t *frame)
+{
+    bw_track_t *bw = stream->bw;
+    gint64 capture_ns;
+    gint64 interval;
+    guint slot;
+
+    capture_ns = (gint64)pinfo->fd->abs_ts.secs * 1000000000 + pinfo->fd->abs_ts.nsecs;
+
+    if (bw == NULL) {
+        bw = stream->bw = ieee1722_state_alloc0(stream, sizeof(bw_track_t));
+        bw_track_refresh(bw, tvb, entry, stream->stream_id);
+        bw->interval = capture_ns / bw->interval_ns;
+        bw->interval_end_ns = (bw->interval + 1) * bw->interval_ns;
+        bw->intervals = 1;
+    }
+    else if (capture_ns >= bw->interval_end_ns) {
+        /* Usually the next interval; divide only after a gap */
+        if (capture_ns < bw->interval_end_ns + bw->interval_ns)
+            interval = bw->interval + 1;
+        else
+            interval = capture_ns / bw->interval_ns;
+
+        {
+            gint64 steps = MIN(interval - bw->interval, BW_WINDOW_INTERVALS);
+            gint64 i;
+
+            /* Drop the intervals that leave the window */
+            for (i = 1; i <= steps; i++) {
+                slot = (guint)(bw->interval + i) & (BW_WINDOW_INTERVALS - 1);
+                bw->window_frames -= bw->frames[slot];
+                bw->window_bytes -= bw->bytes[slot];
+                bw->frames[slot] = 0;
+                bw->bytes[slot] = 0;
+            }
+            bw->intervals = (guint16)MIN(bw->intervals + steps, BW_WINDOW_INTERVALS);
+
+            if (interval / BW_WINDOW_INTERVALS != bw->interval / BW_WINDOW_INTERVALS) {
+                gboolean class_b = bw->class_b;
+
+                bw_track_refresh(bw, tvb, entry, stream->stream_id);
+                if (bw->class_b != class_b) {
+                    /* New interval length: start the window over */
+                    memset(bw->frames, 0, sizeof(bw->frames));
+                    memset(bw->bytes, 0, sizeof(bw->bytes));
+                    bw->window_frames = 0;
+                    bw->window_bytes = 0;
+                    bw->intervals = 1;
+                    bw->oversubscribed = FALSE;
+                    interval = capture_ns / bw->interval_ns;
+                }
+            }
+        }
+        bw->interval = interval;
+        bw->interval_end_ns = (interval + 1) * bw->interval_ns;
+    }
+    /* else still the current interval, or capture time went back: count it there */
+
+    slot = (guint)bw->interval & (BW_WINDOW_INTERVALS - 1);
+    bw->frames[slot]++;
+    bw->bytes[slot] += pinfo->fd->pkt_len;
+    bw->window_frames++;
+    bw->window_bytes += pinfo->fd->pkt_len;
+
+    if (bw->reserved_frames == 0)
+        return;
+
+    if (bw->frames[slot] == bw->reserved_frames + 2)
+        frame->bw_faults |= IEEE1722_BW_BURST;
+    if (bw->intervals == BW_WINDOW_INTERVALS) {
+        if (bw->window_frames <= (guint32)bw->reserved_frames * BW_WINDOW_INTERVALS) {
+            bw->oversubscribed = FALSE;
+        }
+        else if (!bw->oversubscribed &&
+                 bw->window_frames > (guint32)bw->reserved_frames * BW_WINDOW_INTERVALS + 1) {
+            bw->oversubscribed = TRUE;
+            frame->bw_faults |= IEEE1722_BW_OVERSUBSCRIBED;
+        }
+    }
+    if (frame->bw_faults == 0)
+        return;
+
+    frame->class_b = bw->class_b;
+    frame->class_known = bw->class_known;
+    frame->interval_frames = bw->frames[slot];
+    frame->reserved_frames = bw->reserved_frames;
+    frame->window_kbps = (guint32)((gdouble)bw->window_bytes * 8e6 /
+                                   ((gdouble)bw->intervals * bw->interval_ns));
+    frame->reserved_kbps = (guint32)((gdouble)bw->reserved_frames * pinfo->fd->pkt_len * 8e6 /
+                                     bw->interval_ns);
+}
+
+/* Run the per-stream analysis on the first pass, in *frame, and return
+ * it if the frame has something to show; later passes return what was
+ * kept.  Only frames with a warning keep a copy, unless
+ * ieee1722_state_revisit asks for every frame with something to show.
+ */
+static avtp_frame_info_t *ieee1722_analyze_stream(tvbuff_t *tvb, packet_info *pinfo,
+                                                  const avtp_subtype_entry_t *entry,
+                                                  guint64 stream_id, guint8 seqnum,
+                                                  avtp_frame_info_t *frame)
+{
+    avtp_frame_info_t *finfo;
+    avtp_stream_t *stream;
+    gboolean finding;
+
+    if (pinfo->fd->flags.visited) {
+        finfo = p_get_proto_data(pinfo->fd, proto_1722);
+        return finfo && finfo->analyzed ? finfo : NULL;
+    }
+
+    stream = ieee1722_stream_lookup(stream_id);
+    if (stream == NULL)
+        return NULL;
+
+    memset(frame, 0, sizeof(*frame));
+    if (ieee1722_analyze_seqnum)
+        ieee1722_track_seqnum(stream, seqnum, frame);
+    if (ieee1722_analyze_pt && entry->has_timestamp &&
+        (tvb_get_guint8(tvb, IEEE_1722_VERSION_OFFSET) & IEEE_1722_TV_MASK))
+        ieee1722_track_presentation_time(stream, pinfo, tvb_get_ntohl(tvb, IEEE_1722_TIMESTAMP_OFFSET), frame);
+    if (entry->analyze)
+        entry->analyze(tvb, stream, frame);
+    if (ieee1722_analyze_bandwidth)
+        ieee1722_track_bandwidth(tvb, pinfo, entry, stream, frame);
+    stream->packets++;
+
+    /* The drift and margin estimates alone are no warning */
+    finding = frame->seq_status != IEEE1722_SEQ_OK || frame->dbc_status != IEEE1722_DBC_OK ||
+              frame->clock_faults || frame->bw_faults ||
+              (frame->has_pt && (frame->pt_margin_ns < 0 ||
+                                 frame->pt_margin_ns > (gint64)ieee1722_latency_budget_us * 1000));
+    if (!finding && !frame->has_pt && !frame->has_clock)
+        return NULL;
+    frame->analyzed = TRUE;
+    if (!finding && !ieee1722_state_revisit)
+        return frame;
+
+    finfo = se_alloc(sizeof(avtp_frame_info_t));
+    *finfo = *frame;
+    p_add_proto_data(pinfo->fd, proto_1722, finfo);
+    return finfo;
+}
+
+static void ieee1722_add_stream_analysis(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
+                                         avtp_frame_info_t *finfo)
+{
+    proto_item *ti = NULL;
+    proto_tree *analysis_tree = NULL;
+
+    ti = proto_tree_add_text(tree, tvb, 0, 0, "[Stream analysis]");
+    PROTO_ITEM_SET_GENERATED(ti);
+    analysis_tree = proto_item_add_subtree(ti, ett_1722_analysis);
+
+    switch (finfo->seq_status) {
+        case IEEE1722_SEQ_LOST:
+            ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_expected_seqnum, tvb,
+                                     IEEE_1722_SEQ_NUM_OFFSET, 1, finfo->expected_seqnum);
+            PROTO_ITEM_SET_GENERATED(ti);
+            ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_lost, tvb,
+                                     IEEE_1722_SEQ_NUM_OFFSET, 1, finfo->lost);
+            PROTO_ITEM_SET_GENERATED(ti);
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "%u AVTP packet%s lost before this one",
+                                   finfo->lost, finfo->lost == 1 ? "" : "s");
+            break;
+        case IEEE1722_SEQ_DUPLICATE:
+            ti = proto_tree_add_boolean(analysis_tree, hf_1722_analysis_duplicate, tvb,
+                                        IEEE_1722_SEQ_NUM_OFFSET, 1, TRUE);
+            PROTO_ITEM_SET_GENERATED(ti);
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN, "Duplicate AVTP packet");
+            break;
+        case IEEE1722_SEQ_OUT_OF_ORDER:
+            ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_expected_seqnum, tvb,
+                                     IEEE_1722_SEQ_NUM_OFFSET, 1, finfo->expected_seqnum);
+            PROTO_ITEM_SET_GENERATED(ti);
+            ti = proto_tree_add_boolean(analysis_tree, hf_1722_analysis_out_of_order, tvb,
+                                        IEEE_1722_SEQ_NUM_OFFSET, 1, TRUE);
+            PROTO_ITEM_SET_GENERATED(ti);
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN, "Out-of-order AVTP packet");
+            break;
+        default:
+            break;
+    }
+
+    if (finfo->has_pt) {
+        ti = proto_tree_add_int64(analysis_tree, hf_1722_analysis_pt_margin, tvb,
+                                  IEEE_1722_TIMESTAMP_OFFSET, 4, finfo->pt_margin_ns);
+        PROTO_ITEM_SET_GENERATED(ti);
+        if (finfo->pt_margin_ns < 0)
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "Presentation time passed %" G_GINT64_MODIFIER "d ns before capture",
+                                   -finfo->pt_margin_ns);
+        else if (finfo->pt_margin_ns > (gint64)ieee1722_latency_budget_us * 1000)
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_NOTE,
+                                   "Presentation time is beyond the %u us latency budget",
+                                   ieee1722_latency_budget_us);
+
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_transit_jitter, tvb,
+                                 IEEE_1722_TIMESTAMP_OFFSET, 4, finfo->transit_jitter_ns);
+        PROTO_ITEM_SET_GENERATED(ti);
+    }
+
+    if (finfo->dbc_status != IEEE1722_DBC_OK) {
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_expected_dbc, tvb,
+                                 IEEE_1722_DBC_OFFSET, 1, finfo->expected_dbc);
+        PROTO_ITEM_SET_GENERATED(ti);
+        ti = proto_tree_add_uint(analysis_tree,
+                                 finfo->dbc_status == IEEE1722_DBC_REPEATED ?
+                                 hf_1722_analysis_blocks_repeated : hf_1722_analysis_blocks_lost,
+                                 tvb, IEEE_1722_DBC_OFFSET, 1, finfo->dbc_blocks);
+        PROTO_ITEM_SET_GENERATED(ti);
+        /* Blocks carried by lost packets are already covered by the sequence number */
+        if (finfo->dbc_status == IEEE1722_DBC_SKIPPED)
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "%u data block%s missing although no AVTP packet was lost",
+                                   finfo->dbc_blocks, finfo->dbc_blocks == 1 ? "" : "s");
+        else if (finfo->dbc_status == IEEE1722_DBC_REPEATED)
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "%u data block%s repeated",
+                                   finfo->dbc_blocks, finfo->dbc_blocks == 1 ? "" : "s");
+    }
+
+    if (finfo->clock_faults & IEEE1722_CLOCK_SYT_BACKWARDS) {
+        ti = proto_tree_add_boolean(analysis_tree, hf_1722_analysis_syt_backwards, tvb,
+                                    IEEE_1722_SYT_OFFSET, 2, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                               "SYT went back %u ticks (%.2f us)", finfo->syt_backwards_ticks,
+                               finfo->syt_backwards_ticks / 24.576);
+    }
+
+    if (finfo->bw_faults) {
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_sr_class, tvb, 0, 0, finfo->class_b);
+        PROTO_ITEM_SET_GENERATED(ti);
+        if (!finfo->class_known)
+            proto_item_append_text(ti, " (assumed)");
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_reserved_frames, tvb, 0, 0,
+                                 finfo->reserved_frames);
+        PROTO_ITEM_SET_GENERATED(ti);
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_interval_frames, tvb, 0, 0,
+                                 finfo->interval_frames);
+        PROTO_ITEM_SET_GENERATED(ti);
+        if (finfo->bw_faults & IEEE1722_BW_BURST)
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "Burst: %u frames in one class %c interval, %u reserved",
+                                   finfo->interval_frames, finfo->class_b ? 'B' : 'A',
+                                   finfo->reserved_frames);
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_reserved_bandwidth, tvb, 0, 0,
+                                 finfo->reserved_kbps);
+        PROTO_ITEM_SET_GENERATED(ti);
+        ti = proto_tree_add_uint(analysis_tree, hf_1722_analysis_window_bandwidth, tvb, 0, 0,
+                                 finfo->window_kbps);
+        PROTO_ITEM_SET_GENERATED(ti);
+        if (finfo->bw_faults & IEEE1722_BW_OVERSUBSCRIBED)
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "Stream exceeds its reservation: %u kbit/s against %u kbit/s reserved",
+                                   finfo->window_kbps, finfo->reserved_kbps);
+    }
+
+    if (finfo->has_clock) {
+        ti = proto_tree_add_double(analysis_tree, hf_1722_analysis_clock_drift, tvb,
+                                   0, 0, finfo->clock_drift_ppm);
+        PROTO_ITEM_SET_GENERATED(ti);
+        ti = proto_tree_add_double(analysis_tree, hf_1722_analysis_clock_jitter, tvb,
+                                   0, 0, finfo->clock_jitter_ns);
+        PROTO_ITEM_SET_GENERATED(ti);
+    }
+}
+
+/* Add the "Sample N" subtrees for the first nblocks data blocks */
+static void dissect_1722_samples(tvbuff_t *tvb, proto_tree *audio_tree, guint nblocks, guint8 dbs)
+{
+    proto_item *ti = NULL;
+    proto_tree *sample_tree = NULL;
+    gint offset = IEEE_1722_DATA_OFFSET;
+    guint i, j;
+
+    for (j = 0; j < nblocks; j++) {
+        ti = proto_tree_add_text(audio_tree, tvb, offset, 1, "Sample %d", j+1);
+        sample_tree = proto_item_add_subtree(ti, ett_1722_sample);
+        for (i = 0; i < dbs; i++) {
+            proto_tree_add_item(sample_tree, hf_1722_label, tvb, offset, 1, FALSE);
+            offset += 1;
+
+            proto_tree_add_item(sample_tree, hf_1722_sample, tvb, offset, 3, FALSE);
+            offset += 3;
+        }
+    }
+}
+
+/* Summarise the AM824 payload on the Audio Data item and only build the
+ * per-sample subtree when the user has it expanded or a filter needs it.
+ */
+static void dissect_1722_audio_data(tvbuff_t *tvb, proto_item *data_ti, guint nblocks, guint8 dbs)
+{
+    proto_tree *audio_tree = NULL;
+    const guint8 *quadlets;
+    guint16 label_count[256];
+    guint8 labels_seen[256];
+    guint nlabels = 0;
+    guint shown;
+    guint i;
+
+    audio_tree = proto_item_add_subtree(data_ti, ett_1722_audio);
+
+    shown = nblocks;
+    if (ieee1722_max_sample_blocks != 0 && shown > ieee1722_max_sample_blocks)
+        shown = ieee1722_max_sample_blocks;
+
+    if (ieee1722_sample_tree_mode == SAMPLE_TREE_FULL ||
+        tree_is_expanded[ett_1722_audio] ||
+        proto_field_is_referenced(audio_tree, hf_1722_label) ||
+        proto_field_is_referenced(audio_tree, hf_1722_sample)) {
+        dissect_1722_samples(tvb, audio_tree, shown, dbs);
+        if (shown < nblocks)
+            proto_tree_add_text(audio_tree, tvb, IEEE_1722_DATA_OFFSET + shown*dbs*4,
+                                (nblocks - shown)*dbs*4, "%u more data blocks not shown",
+                                nblocks - shown);
+        return;
+    }
+
+    /* Summary mode: one pass over the labels with a single bounds check */
+    quadlets = tvb_get_ptr(tvb, IEEE_1722_DATA_OFFSET, nblocks*dbs*4);
+    memset(label_count, 0, sizeof(label_count));
+    for (i = 0; i < nblocks*dbs; i++) {
+        guint8 label = quadlets[i*4];
+
+        if (label_count[label]++ == 0)
+            labels_seen[nlabels++] = label;
+    }
+
+    proto_item_append_text(data_ti, " (%u blocks, %u channels)", nblocks, dbs);
+    for (i = 0; i < nlabels; i++) {
+        proto_tree_add_text(audio_tree, tvb, IEEE_1722_DATA_OFFSET, nblocks*dbs*4,
+                            "Label 0x%02x (%s): %u quadlets", labels_seen[i],
+                            val_to_str(labels_seen[i], am824_label_vals, "Unknown"),
+                            label_count[labels_seen[i]]);
+    }
+}
+
+/* Payload length claimed by pkt_data_length, checked against the frame.
+ * A length shorter than the CIP header or longer than the captured data
+ * is reported once and clamped, so a corrupt frame never drives the
+ * sample loops past the end of the buffer.
+ */
+static guint dissect_1722_61883_datalen(tvbuff_t *tvb, packet_info *pinfo, proto_item *len_ti,
+                                        guint16 pkt_data_length)
+{
+    guint datalen = ieee1722_61883_datalen(tvb, pkt_data_length);
+
+    if (pkt_data_length < IEEE_1722_CIP_HEADER_SIZE)
+        expert_add_info_format(pinfo, len_ti, PI_MALFORMED, PI_ERROR,
+                               "Packet data length %u is shorter than the %u byte CIP header",
+                               pkt_data_length, IEEE_1722_CIP_HEADER_SIZE);
+    else if (datalen < (guint)(pkt_data_length - IEEE_1722_CIP_HEADER_SIZE))
+        expert_add_info_format(pinfo, len_ti, PI_MALFORMED, PI_WARN,
+                               "Packet data length %u exceeds the %u bytes of CIP payload in the frame",
+                               pkt_data_length, datalen);
+    return datalen;
+}
+
+/* IEC 61883/IIDC: 1394 CIP header and AM824 audio.
+ *
+ * The fixed header is fetched with one bounds check and decoded into a
+ * struct; fields that share an octet with others are added from the raw
+ * octet so that the hf bitmasks still show their bit positions.
+ */
+static void dissect_1722_61883(tvbuff_t *tvb, packet_info *pinfo, proto_tree *ieee1722_tree,
+                               ieee1722_tap_info_t *tap_info)
+{
+    proto_item *ti = NULL;
+    proto_item *len_ti = NULL;
+    proto_tree *syt_tree = NULL;
+    const guint8 *raw;
+    ieee1722_61883_hdr_t hdr;
+    guint datalen;
+
+    raw = tvb_get_ptr(tvb, 0, IEEE_1722_DATA_OFFSET);
+    ieee1722_decode_61883(raw, IEEE_1722_DATA_OFFSET, &hdr);
+
+    if (ieee1722_tree) {
+        proto_tree_add_uint(ieee1722_tree, hf_1722_mrfield, tvb, IEEE_1722_VERSION_OFFSET, 1,
+                            raw[IEEE_1722_VERSION_OFFSET]);
+        proto_tree_add_boolean(ieee1722_tree, hf_1722_gvfield, tvb, IEEE_1722_VERSION_OFFSET, 1,
+                               raw[IEEE_1722_VERSION_OFFSET]);
+        proto_tree_add_boolean(ieee1722_tree, hf_1722_tvfield, tvb, IEEE_1722_VERSION_OFFSET, 1, hdr.tv);
+
+        /* Add the rest of the packet fields */
+        proto_tree_add_uint(ieee1722_tree, hf_1722_seqnum, tvb, IEEE_1722_SEQ_NUM_OFFSET, 1, hdr.seqnum);
+        proto_tree_add_boolean(ieee1722_tree, hf_1722_tufield, tvb, IEEE_1722_TU_FIELD_OFFSET, 1, hdr.tu);
+        proto_tree_add_uint64(ieee1722_tree, hf_1722_stream_id, tvb, IEEE_1722_STREAM_ID_OFFSET, 8,
+                              hdr.stream_id);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_avbtp_timestamp, tvb, IEEE_1722_TIMESTAMP_OFFSET, 4,
+                            hdr.avtp_timestamp);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_gateway_info, tvb, IEEE_1722_GW_INFO_OFFSET, 4,
+                            hdr.gateway_info);
+        len_ti = proto_tree_add_uint(ieee1722_tree, hf_1722_packet_data_length, tvb,
+                                     IEEE_1722_PKT_DATA_LENGTH_OFFSET, 2, hdr.packet_data_length);
+
+        proto_tree_add_uint(ieee1722_tree, hf_1722_tag, tvb, IEEE_1722_TAG_OFFSET, 1,
+                            raw[IEEE_1722_TAG_OFFSET]);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_channel, tvb, IEEE_1722_TAG_OFFSET, 1, hdr.channel);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_tcode, tvb, IEEE_1722_TCODE_OFFSET, 1,
+                            raw[IEEE_1722_TCODE_OFFSET]);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_sy, tvb, IEEE_1722_TCODE_OFFSET, 1, hdr.sy);
+
+        proto_tree_add_uint(ieee1722_tree, hf_1722_sid, tvb, IEEE_1722_SID_OFFSET, 1, hdr.sid);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_dbs, tvb, IEEE_1722_DBS_OFFSET, 1, hdr.dbs);
+
+        proto_tree_add_uint(ieee1722_tree, hf_1722_fn, tvb, IEEE_1722_FN_OFFSET, 1,
+                            raw[IEEE_1722_FN_OFFSET]);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_qpc, tvb, IEEE_1722_FN_OFFSET, 1,
+                            raw[IEEE_1722_FN_OFFSET]);
+        proto_tree_add_boolean(ieee1722_tree, hf_1722_sph, tvb, IEEE_1722_FN_OFFSET, 1,
+                               raw[IEEE_1722_FN_OFFSET]);
+
+        proto_tree_add_uint(ieee1722_tree, hf_1722_dbc, tvb, IEEE_1722_DBC_OFFSET, 1, hdr.dbc);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_fmt, tvb, IEEE_1722_FMT_OFFSET, 1, hdr.fmt);
+        proto_tree_add_uint(ieee1722_tree, hf_1722_fdf, tvb, IEEE_1722_FDF_OFFSET, 1, hdr.fdf);
+        ti = proto_tree_add_uint(ieee1722_tree, hf_1722_syt, tvb, IEEE_1722_SYT_OFFSET, 2, hdr.syt);
+        if (hdr.syt == IEEE_1722_SYT_NO_INFO) {
+            proto_item_append_text(ti, " (no information)");
+        }
+        else {
+            syt_tree = proto_item_add_subtree(ti, ett_1722_syt);
+            proto_item_append_text(ti, " (cycle %u, offset %u)",
+                                   hdr.syt >> 12, hdr.syt & IEEE_1722_SYT_CYCLE_OFFSET_MASK);
+            proto_tree_add_uint(syt_tree, hf_1722_syt_cycle, tvb, IEEE_1722_SYT_OFFSET, 2, hdr.syt);
+            proto_tree_add_uint(syt_tree, hf_1722_syt_cycle_offset, tvb, IEEE_1722_SYT_OFFSET, 2, hdr.syt);
+        }
+    }
+
+    /* The remaining size is the packet data length less the CIP header */
+    datalen = dissect_1722_61883_datalen(tvb, pinfo, len_ti, hdr.packet_data_length);
+
+    if (ieee1722_tree) {
+        /* Make the Audio sample tree. */
+        ti = proto_tree_add_item(ieee1722_tree, hf_1722_data, tvb,
+                                 IEEE_1722_DATA_OFFSET, datalen, FALSE);
+
+        /* If the DBS is ever 0 for whatever reason, then just add the rest of packet as unknown */
+        if (hdr.dbs == 0)
+            proto_tree_add_text(ieee1722_tree, tvb, IEEE_1722_DATA_OFFSET, datalen, "Incorrect DBS");
+        else
+            dissect_1722_audio_data(tvb, ti, datalen / (hdr.dbs*4), hdr.dbs);
+    }
+
+    if (tap_info) {
+        tap_info->dbs = hdr.dbs;
+        tap_info->fmt = hdr.fmt;
+        tap_info->fdf = hdr.fdf;
+        if (hdr.fmt == IEEE_1722_FMT_AM824 && hdr.fdf != IEEE_1722_FDF_NO_DATA)
+            tap_info->clock_nominal_hz = am824_sfc_rates[hdr.fdf & IEEE_1722_FDF_SFC_MASK];
+        if (hdr.dbs != 0)
+            tap_info->data_blocks = datalen / (hdr.dbs*4);
+
+        /* Hand the captured AM824 quadlets to exporters without copying */
+        if (tap_info->fmt == IEEE_1722_FMT_AM824 && tap_info->data_blocks != 0 &&
+            tvb_length_remaining(tvb, IEEE_1722_DATA_OFFSET) >= tap_info->data_blocks*hdr.dbs*4)
+            tap_info->am824 = tvb_get_ptr(tvb, IEEE_1722_DATA_OFFSET, tap_info->data_blocks*hdr.dbs*4);
+    }
+}
+
+/* Sequence number, stream ID and timestamp shared by the stream formats */
+static void dissect_1722_stream_id_fields(tvbuff_t *tvb, proto_tree *ieee1722_tree)
+{
+    proto_tree_add_item(ieee1722_tree, hf_1722_mrfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_tvfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_seqnum, tvb, IEEE_1722_SEQ_NUM_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_tufield, tvb, IEEE_1722_TU_FIELD_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_stream_id, tvb, IEEE_1722_STREAM_ID_OFFSET, 8, FALSE);
+}
+
+/* Common stream header (TSCF, SVF, RVF) with an opaque payload */
+static void dissect_1722_common_stream(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *ieee1722_tree,
+                                       ieee1722_tap_info_t *tap_info _U_)
+{
+    gint remaining;
+
+    if (!ieee1722_tree)
+        return;
+
+    dissect_1722_stream_id_fields(tvb, ieee1722_tree);
+    proto_tree_add_item(ieee1722_tree, hf_1722_avbtp_timestamp, tvb, IEEE_1722_TIMESTAMP_OFFSET, 4, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_format_info, tvb, AVTP_STREAM_FORMAT_INFO_OFFSET, 4, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_stream_data_length, tvb, AVTP_STREAM_DATA_LENGTH_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_format_info2, tvb, AVTP_STREAM_FORMAT_INFO2_OFFSET, 2, FALSE);
+
+    remaining = tvb_length_remaining(tvb, AVTP_STREAM_PAYLOAD_OFFSET);
+    if (remaining > 0)
+        proto_tree_add_item(ieee1722_tree, hf_1722_payload, tvb, AVTP_STREAM_PAYLOAD_OFFSET, remaining, FALSE);
+}
+
+static cvf_chunk_t *cvf_chunk_get(avtp_stream_t *stream)
+{
+    cvf_reassembly_t *r = stream->cvf;
+    cvf_chunk_t *chunk = r->spare;
+
+    if (chunk)
+        r->spare = chunk->next;
+    else
+        chunk = ieee1722_state_alloc0(stream, sizeof(cvf_chunk_t));
+    chunk->next = NULL;
+    chunk->len = 0;
+    return chunk;
+}
+
+static void cvf_free_chunks(cvf_chunk_t *chunk)
+{
+    while (chunk) {
+        cvf_chunk_t *next = chunk->next;
+
+        g_free(chunk);
+        chunk = next;
+    }
+}
+
+/* Keep the chunks of the NAL being gathered for the next one; see
+ * cvf_trim() */
+static void cvf_release(cvf_reassembly_t *r)
+{
+    if (r->head) {
+        r->tail->next = r->spare;
+        r->spare = r->head;
+    }
+    r->head = r->tail = NULL;
+    r->nal = NULL;
+}
+
+static void cvf_abandon(cvf_reassembly_t *r)
+{
+    if (r->nal)
+        r->nal->incomplete = TRUE;
+    cvf_release(r);
+}
+
+/* Give back all spare chunks but one */
+static void cvf_trim(avtp_stream_t *stream)
+{
+    cvf_reassembly_t *r = stream->cvf;
+    cvf_chunk_t *chunk;
+
+    if (r->spare == NULL)
+        return;
+    while ((chunk = r->spare->next) != NULL) {
+        r->spare->next = chunk->next;
+        ieee1722_state_free(stream, chunk, sizeof(cvf_chunk_t));
+    }
+}
+
+static gboolean cvf_append(avtp_stream_t *stream, const guint8 *data, guint len)
+{
+    cvf_reassembly_t *r = stream->cvf;
+    guint64 max_length = MIN((guint64)ieee1722_cvf_max_nal_kb * 1024, ieee1722_state_budget() / 4);
+
+    if (r->nal->length + len > max_length)
+        return FALSE;
+
+    r->nal->length += len;
+    while (len > 0) {
+        guint n;
+
+        if (r->tail == NULL || r->tail->len == CVF_CHUNK_SIZE) {
+            cvf_chunk_t *chunk = cvf_chunk_get(stream);
+
+            if (r->tail)
+                r->tail->next = chunk;
+            else
+                r->head = chunk;
+            r->tail = chunk;
+        }
+        n = MIN(len, CVF_CHUNK_SIZE - r->tail->len);
+        memcpy(r->tail->data + r->tail->len, data, n);
+        r->tail->len += n;
+        data += n;
+        len -= n;
+    }
+    return TRUE;
+}
+
+/* First pass: add one FU-A fragment (FU indicator onwards) to its stream
+ * and return the NAL it belongs to.  Unless it is kept for revisiting, the
+ * NAL is only good for this frame. */
+static cvf_nal_t *cvf_add_fragment(packet_info *pinfo, guint64 stream_id, guint8 seqnum,
+                                   const guint8 *fu, guint len)
+{
+    avtp_stream_t *stream;
+    cvf_reassembly_t *r;
+    cvf_nal_t *nal;
+    guint8 nal_header;
+
+    stream = ieee1722_stream_lookup(stream_id);
+    if (stream == NULL)
+        return &cvf_lost_nal;
+    if (stream->cvf == NULL)
+        stream->cvf = ieee1722_state_alloc0(stream, sizeof(cvf_reassembly_t));
+    r = stream->cvf;
+
+    if (fu[1] & H264_FU_START) {
+        /* A new NAL while another is open means its end was lost */
+        cvf_abandon(r);
+        cvf_trim(stream);
+        if (ieee1722_state_revisit) {
+            r->nal = se_alloc0(sizeof(cvf_nal_t));
+        }
+        else {
+            memset(&r->current, 0, sizeof(r->current));
+            r->nal = &r->current;
+        }
+        r->nal->first_frame = pinfo->fd->num;
+        nal_header = (fu[0] & H264_NAL_FNRI_MASK) | (fu[1] & H264_NAL_TYPE_MASK);
+        cvf_append(stream, &nal_header, 1);
+    }
+    else if (r->nal == NULL || seqnum != r->next_seqnum) {
+        cvf_abandon(r);
+        cvf_trim(stream);
+        return &cvf_lost_nal;
+    }
+
+    nal = r->nal;
+    nal->fragments++;
+    r->next_seqnum = seqnum + 1;
+
+    if (!cvf_append(stream, fu + 2, len - 2)) {
+        cvf_abandon(r);
+        cvf_trim(stream);
+        return nal;
+    }
+
+    if (fu[1] & H264_FU_END) {
+        cvf_chunk_t *chunk;
+        guint8 *p;
+
+        p = nal->data = ieee1722_state_revisit ? se_alloc(nal->length) : ep_alloc(nal->length);
+        for (chunk = r->head; chunk; chunk = chunk->next) {
+            memcpy(p, chunk->data, chunk->len);
+            p += chunk->len;
+        }
+        nal->reassembled_in = pinfo->fd->num;
+        cvf_release(r);
+        cvf_trim(stream);
+    }
+    return nal;
+}
+
+/* H.264 payload: single NALs and STAP-A go straight to the H.264
+ * dissector, FU-A fragments are reassembled first.
+ */
+static void dissect_1722_cvf_h264(tvbuff_t *tvb, packet_info *pinfo, proto_tree *ieee1722_tree,
+                                  proto_tree *tree, gint payload_len)
+{
+    proto_item *ti = NULL;
+    proto_tree *fragment_tree = NULL;
+    avtp_frame_info_t *finfo;
+    tvbuff_t *nal_tvb;
+    cvf_nal_t *nal;
+    guint8 indicator;
+
+    indicator = tvb_get_guint8(tvb, CVF_H264_PAYLOAD_OFFSET);
+    if ((indicator & H264_NAL_TYPE_MASK) != H264_NAL_TYPE_FU_A || payload_len < 2 ||
+        !ieee1722_reassemble_cvf) {
+        nal_tvb = tvb_new_subset(tvb, CVF_H264_PAYLOAD_OFFSET, payload_len, payload_len);
+        if (h264_handle)
+            call_dissector(h264_handle, nal_tvb, pinfo, tree);
+        else
+            proto_tree_add_item(ieee1722_tree, hf_1722_cvf_nal, tvb, CVF_H264_PAYLOAD_OFFSET, payload_len, FALSE);
+        return;
+    }
+
+    /* NULL on a revisit when the first pass kept nothing */
+    if (!pinfo->fd->flags.visited) {
+        nal = &cvf_lost_nal;
+        if (tvb_get_guint8(tvb, IEEE_1722_VERSION_OFFSET) & IEEE_1722_SV_MASK)
+            nal = cvf_add_fragment(pinfo, tvb_get_ntoh64(tvb, IEEE_1722_STREAM_ID_OFFSET),
+                                   tvb_get_guint8(tvb, IEEE_1722_SEQ_NUM_OFFSET),
+                                   tvb_get_ptr(tvb, CVF_H264_PAYLOAD_OFFSET, payload_len), payload_len);
+        if (ieee1722_state_revisit) {
+            finfo = p_get_proto_data(pinfo->fd, proto_1722);
+            if (finfo == NULL) {
+                finfo = se_alloc0(sizeof(avtp_frame_info_t));
+                p_add_proto_data(pinfo->fd, proto_1722, finfo);
+            }
+            finfo->cvf_nal = nal;
+        }
+    }
+    else {
+        finfo = p_get_proto_data(pinfo->fd, proto_1722);
+        nal = finfo ? finfo->cvf_nal : NULL;
+    }
+
+    ti = proto_tree_add_item(ieee1722_tree, hf_1722_cvf_fragment, tvb, CVF_H264_PAYLOAD_OFFSET, payload_len, FALSE);
+    if (nal == NULL || nal->reassembled_in != pinfo->fd->num) {
+        col_append_str(pinfo->cinfo, COL_INFO, " [H.264 NAL fragment]");
+        if (nal && nal->reassembled_in) {
+            fragment_tree = proto_item_add_subtree(ti, ett_1722_cvf_fragment);
+            ti = proto_tree_add_uint(fragment_tree, hf_1722_cvf_reassembled_in, tvb, 0, 0, nal->reassembled_in);
+            PROTO_ITEM_SET_GENERATED(ti);
+        }
+        else if (nal && nal->incomplete) {
+            expert_add_info_format(pinfo, ti, PI_REASSEMBLE, PI_WARN,
+                                   "Incomplete H.264 NAL unit: fragments lost");
+        }
+        return;
+    }
+
+    fragment_tree = proto_item_add_subtree(ti, ett_1722_cvf_fragment);
+    ti = proto_tree_add_uint(fragment_tree, hf_1722_cvf_reassembled_length, tvb, 0, 0, nal->length);
+    PROTO_ITEM_SET_GENERATED(ti);
+    proto_item_append_text(ti, " (%u fragments from frame %u)", nal->fragments, nal->first_frame);
+
+    nal_tvb = tvb_new_child_real_data(tvb, nal->data, nal->length, nal->length);
+    add_new_data_source(pinfo, nal_tvb, "Reassembled H.264 NAL");
+    if (h264_handle)
+        call_dissector(h264_handle, nal_tvb, pinfo, tree);
+    else
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_nal, nal_tvb, 0, -1, FALSE);
+}
+
+/* Compressed Video Format */
+static void dissect_1722_cvf(tvbuff_t *tvb, packet_info *pinfo, proto_tree *ieee1722_tree,
+                             ieee1722_tap_info_t *tap_info _U_)
+{
+    proto_tree *tree;
+    guint8 format;
+    guint8 format_subtype;
+    guint16 datalen;
+    gint payload_len;
+
+    if (ieee1722_tree) {
+        dissect_1722_stream_id_fields(tvb, ieee1722_tree);
+        proto_tree_add_item(ieee1722_tree, hf_1722_avbtp_timestamp, tvb, IEEE_1722_TIMESTAMP_OFFSET, 4, FALSE);
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_format, tvb, CVF_FORMAT_OFFSET, 1, FALSE);
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_format_subtype, tvb, CVF_FORMAT_SUBTYPE_OFFSET, 1, FALSE);
+        proto_tree_add_item(ieee1722_tree, hf_1722_stream_data_length, tvb, AVTP_STREAM_DATA_LENGTH_OFFSET, 2, FALSE);
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_ptv, tvb, CVF_FLAGS_OFFSET, 1, FALSE);
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_m, tvb, CVF_FLAGS_OFFSET, 1, FALSE);
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_evt, tvb, CVF_FLAGS_OFFSET, 1, FALSE);
+    }
+
+    format = tvb_get_guint8(tvb, CVF_FORMAT_OFFSET);
+    format_subtype = tvb_get_guint8(tvb, CVF_FORMAT_SUBTYPE_OFFSET);
+    datalen = tvb_get_ntohs(tvb, AVTP_STREAM_DATA_LENGTH_OFFSET);
+
+    if (format != CVF_FORMAT_RFC || format_subtype != CVF_FORMAT_SUBTYPE_H264 || datalen < 4) {
+        payload_len = MIN(datalen, tvb_length_remaining(tvb, AVTP_STREAM_PAYLOAD_OFFSET));
+        if (ieee1722_tree && payload_len > 0)
+            proto_tree_add_item(ieee1722_tree, hf_1722_payload, tvb, AVTP_STREAM_PAYLOAD_OFFSET, payload_len, FALSE);
+        return;
+    }
+
+    if (ieee1722_tree)
+        proto_tree_add_item(ieee1722_tree, hf_1722_cvf_h264_timestamp, tvb, CVF_H264_TIMESTAMP_OFFSET, 4, FALSE);
+
+    /* stream_data_length covers the h264_timestamp as well */
+    payload_len = MIN(datalen - 4, tvb_length_remaining(tvb, CVF_H264_PAYLOAD_OFFSET));
+    if (payload_len <= 0)
+        return;
+
+    /* The H.264 dissector attaches to the top of the packet tree */
+    tree = proto_item_get_parent(proto_tree_get_parent(ieee1722_tree));
+    dissect_1722_cvf_h264(tvb, pinfo, ieee1722_tree, tree, payload_len);
+}
+
+/* Convert n big-endian AAF samples to floats in [-1, 1) */
+static void aaf_load_samples(float *dst, const guint8 *src, guint n, guint8 format)
+{
+    guint i = 0;
+
+    switch (format) {
+        case AAF_FORMAT_INT_16BIT:
+#ifdef __SSE2__
+            for (; i + 8 <= n; i += 8) {
+                __m128i x = _mm_loadu_si128((const __m128i *)(src + i*2));
+                __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+
+                /* Byte swap, then put each sample in the top half of an int32 */
+                x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+                _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(
+                              _mm_unpacklo_epi16(_mm_setzero_si128(), x)), scale));
+                _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(
+                              _mm_unpackhi_epi16(_mm_setzero_si128(), x)), scale));
+            }
+#endif
+            for (; i < n; i++)
+                dst[i] = (gint16)(src[i*2] << 8 | src[i*2+1]) / 32768.0f;
+            break;
+        case AAF_FORMAT_INT_24BIT:
+            for (; i < n; i++)
+                dst[i] = (gint32)((guint32)src[i*3] << 24 | src[i*3+1] << 16 | src[i*3+2] << 8) /
+                         2147483648.0f;
+            break;
+        case AAF_FORMAT_INT_32BIT:
+        case AAF_FORMAT_FLOAT_32BIT:
+#ifdef __SSE2__
+            for (; i + 4 <= n; i += 4) {
+                __m128i x = _mm_loadu_si128((const __m128i *)(src + i*4));
+
+                x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+                x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+                x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+                if (format == AAF_FORMAT_FLOAT_32BIT)
+                    _mm_storeu_ps(dst + i, _mm_castsi128_ps(x));
+                else
+                    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x),
+                                                      _mm_set1_ps(1.0f / 2147483648.0f)));
+            }
+#endif
+            for (; i < n; i++) {
+                guint32 v = (guint32)src[i*4] << 24 | src[i*4+1] << 16 | src[i*4+2] << 8 | src[i*4+3];
+
+                if (format == AAF_FORMAT_FLOAT_32BIT) {
+                    union { guint32 u; float f; } conv;
+
+                    conv.u = v;
+                    dst[i] = conv.f;
+                }
+                else {
+                    dst[i] = (gint32)v / 2147483648.0f;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Per-channel peak and sum of squares of n interleaved samples.
+ *
+ * The vector loop takes four samples at a time.  Lane j of the a-th
+ * accumulator always holds channel (4a + j) % channels, which needs
+ * channels / gcd(channels, 4) accumulators to cover every channel.
+ */
+static void aaf_channel_summary(const float *x, guint n, guint channels, float *peak, float *sumsq)
+{
+    guint i = 0;
+    guint c;
 
-/* 1722 Offsets */
-#define IEEE_1722_CD_OFFSET                  0
-#define IEEE_1722_VERSION_OFFSET             1
-#define IEEE_1722_SEQ_NUM_OFFSET             2
-#define IEEE_1722_TU_FIELD_OFFSET            3
-#define IEEE_1722_STREAM_ID_OFFSET           4
-#define IEEE_1722_TIMESTAMP_OFFSET          12
-#define IEEE_1722_GW_INFO_OFFSET            16
-#define IEEE_1722_PKT_DATA_LENGTH_OFFSET    20
-#define IEEE_1722_TAG_OFFSET                22
-#define IEEE_1722_TCODE_OFFSET              23
-#define IEEE_1722_SID_OFFSET                24
-#define IEEE_1722_DBS_OFFSET                25
-#define IEEE_1722_FN_OFFSET                 26
-#define IEEE_1722_DBC_OFFSET                27
-#define IEEE_1722_FMT_OFFSET                28
-#define IEEE_1722_FDF_OFFSET                29
-#define IEEE_1722_SYT_OFFSET                30
-#define IEEE_1722_DATA_OFFSET               32
-
-#define IEEE_1722_CIP_HEADER_SIZE    8
-
-/* Bit Field Masks */
-#define IEEE_1722_CD_MASK       0x80
-#define IEEE_1722_SUBTYPE_MASK  0x7f
-#define IEEE_1722_SV_MASK       0x80
-#define IEEE_1722_VER_MASK      0x70
-#define IEEE_1722_MR_MASK       0x08
-#define IEEE_1722_GV_MASK       0x02
-#define IEEE_1722_TV_MASK       0x01
-#define IEEE_1722_TU_MASK       0x01
-#define IEEE_1722_TAG_MASK      0xc0
-#define IEEE_1722_CHANNEL_MASK  0x3f
-#define IEEE_1722_TCODE_MASK    0xf0
-#define IEEE_1722_SY_MASK       0x0f
-#define IEEE_1722_SID_MASK      0x3f
-#define IEEE_1722_FN_MASK       0xc0
-#define IEEE_1722_QPC_MASK      0x38
-#define IEEE_1722_SPH_MASK      0x04
-#define IEEE_1722_FMT_MASK      0x3f
+    for (c = 0; c < channels; c++) {
+        peak[c] = 0.0f;
+        sumsq[c] = 0.0f;
+    }
 
-/**********************************************************/
-/* Initialize the protocol and registered fields          */
-/**********************************************************/
-static int proto_1722 = -1;
-static int hf_1722_cdfield = -1;
-static int hf_1722_subtype = -1;
-static int hf_1722_svfield = -1;
-static int hf_1722_verfield = -1;
-static int hf_1722_mrfield = -1;
-static int hf_1722_gvfield = -1;
-static int hf_1722_tvfield = -1;
-static int hf_1722_seqnum = -1;
-static int hf_1722_tufield = -1;
-static int hf_1722_stream_id = -1;
-static int hf_1722_avbtp_timestamp = -1;
-static int hf_1722_gateway_info = -1;
-static int hf_1722_packet_data_length = -1;
-static int hf_1722_tag = -1;
-static int hf_1722_channel = -1;
-static int hf_1722_tcode = -1;
-static int hf_1722_sy = -1;
-static int hf_1722_sid = -1;
-static int hf_1722_dbs = -1;
-static int hf_1722_fn = -1;
-static int hf_1722_qpc = -1;
-static int hf_1722_sph = -1;
-static int hf_1722_dbc = -1;
-static int hf_1722_fmt = -1;
-static int hf_1722_fdf = -1;
-static int hf_1722_syt = -1;
-static int hf_1722_data = -1;
-static int hf_1722_label = -1;
-static int hf_1722_sample = -1;
+#ifdef __SSE2__
+    {
+        __m128 vpeak[AAF_MAX_SUMMARY_CHANNELS];
+        __m128 vsum[AAF_MAX_SUMMARY_CHANNELS];
+        __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        float lanes[4];
+        guint nacc = channels / (channels % 4 == 0 ? 4 : channels % 2 == 0 ? 2 : 1);
+        guint a, j;
 
-/* Initialize the subtree pointers */
-static int ett_1722 = -1;
-static int ett_1722_audio = -1;
-static int ett_1722_sample = -1;
+        for (a = 0; a < nacc; a++) {
+            vpeak[a] = _mm_setzero_ps();
+            vsum[a] = _mm_setzero_ps();
+        }
 
-static dissector_table_t avb_dissector_table;
-static dissector_handle_t avb17221_handle;
+        for (a = 0; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(x + i);
 
-static void dissect_1722(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+            vpeak[a] = _mm_max_ps(vpeak[a], _mm_and_ps(v, absmask));
+            vsum[a] = _mm_add_ps(vsum[a], _mm_mul_ps(v, v));
+            if (++a == nacc)
+                a = 0;
+        }
+
+        for (a = 0; a < nacc; a++) {
+            _mm_storeu_ps(lanes, vpeak[a]);
+            for (j = 0; j < 4; j++) {
+                c = (4*a + j) % channels;
+                if (lanes[j] > peak[c])
+                    peak[c] = lanes[j];
+            }
+            _mm_storeu_ps(lanes, vsum[a]);
+            for (j = 0; j < 4; j++)
+                sumsq[(4*a + j) % channels] += lanes[j];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        float v = x[i];
+
+        c = i % channels;
+        if (fabsf(v) > peak[c])
+            peak[c] = fabsf(v);
+        sumsq[c] += v * v;
+    }
+}
+
+/* Summarise the AAF payload on the Audio Data item and only compute the
+ * per-channel levels when the subtree is shown or a filter needs them.
+ */
+static void dissect_1722_aaf_audio(tvbuff_t *tvb, proto_item *data_ti, guint8 format,
+                                   guint channels, guint frames, guint sample_size)
+{
+    proto_tree *audio_tree = NULL;
+    proto_tree *channel_tree = NULL;
+    proto_item *ti = NULL;
+    float peak[AAF_MAX_SUMMARY_CHANNELS];
+    float sumsq[AAF_MAX_SUMMARY_CHANNELS];
+    float *samples;
+    guint n = frames * channels;
+    guint c;
+
+    audio_tree = proto_item_add_subtree(data_ti, ett_1722_aaf_audio);
+    proto_item_append_text(data_ti, " (%u frames, %u channels)", frames, channels);
+
+    if (format == AAF_FORMAT_USER || format == AAF_FORMAT_AES3_32BIT ||
+        channels > AAF_MAX_SUMMARY_CHANNELS || n == 0)
+        return;
+
+    if (ieee1722_sample_tree_mode != SAMPLE_TREE_FULL &&
+        !tree_is_expanded[ett_1722_aaf_audio] &&
+        !proto_field_is_referenced(audio_tree, hf_1722_aaf_peak) &&
+        !proto_field_is_referenced(audio_tree, hf_1722_aaf_rms))
+        return;
+
+    samples = ep_alloc(n * sizeof(float));
+    aaf_load_samples(samples, tvb_get_ptr(tvb, AVTP_STREAM_PAYLOAD_OFFSET, n * sample_size), n, format);
+    aaf_channel_summary(samples, n, channels, peak, sumsq);
+
+    for (c = 0; c < channels; c++) {
+        float peak_db = peak[c] > 0.0f ? 20.0f * log10f(peak[c]) : -HUGE_VALF;
+        float rms_db = sumsq[c] > 0.0f ? 10.0f * log10f(sumsq[c] / frames) : -HUGE_VALF;
+
+        ti = proto_tree_add_text(audio_tree, tvb, AVTP_STREAM_PAYLOAD_OFFSET + c * sample_size,
+                                 n * sample_size - c * sample_size,
+                                 "Channel %u: peak %.1f dBFS, RMS %.1f dBFS", c + 1, peak_db, rms_db);
+        channel_tree = proto_item_add_subtree(ti, ett_1722_aaf_channel);
+        ti = proto_tree_add_float(channel_tree, hf_1722_aaf_peak, tvb, 0, 0, peak_db);
+        PROTO_ITEM_SET_GENERATED(ti);
+        ti = proto_tree_add_float(channel_tree, hf_1722_aaf_rms, tvb, 0, 0, rms_db);
+        PROTO_ITEM_SET_GENERATED(ti);
+    }
+}
+
+/* AVTP Audio Format */
+static void dissect_1722_aaf(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *ieee1722_tree,
+                             ieee1722_tap_info_t *tap_info)
+{
+    proto_item *ti = NULL;
+    guint8 format;
+    guint channels;
+    guint sample_size;
+    guint frames;
+    guint16 datalen;
+    gint remaining;
+
+    format = tvb_get_guint8(tvb, AAF_FORMAT_OFFSET);
+    channels = tvb_get_ntohs(tvb, AAF_CHANNELS_OFFSET) & AAF_CHANNELS_MASK;
+    datalen = tvb_get_ntohs(tvb, AVTP_STREAM_DATA_LENGTH_OFFSET);
+    remaining = tvb_length_remaining(tvb, AVTP_STREAM_PAYLOAD_OFFSET);
+    sample_size = aaf_sample_size(format);
+    frames = aaf_audio_frames(tvb);
+
+    if (tap_info) {
+        tap_info->dbs = MIN(channels, G_MAXUINT8);
+        tap_info->fmt = format;
+        tap_info->fdf = (tvb_get_guint8(tvb, AAF_NSR_OFFSET) & AAF_NSR_MASK) >> 4;
+        tap_info->data_blocks = frames;
+    }
+
+    if (!ieee1722_tree)
+        return;
+
+    dissect_1722_stream_id_fields(tvb, ieee1722_tree);
+    proto_tree_add_item(ieee1722_tree, hf_1722_avbtp_timestamp, tvb, IEEE_1722_TIMESTAMP_OFFSET, 4, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_aaf_format, tvb, AAF_FORMAT_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_aaf_nsr, tvb, AAF_NSR_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_aaf_channels, tvb, AAF_CHANNELS_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_aaf_bit_depth, tvb, AAF_BIT_DEPTH_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_stream_data_length, tvb, AVTP_STREAM_DATA_LENGTH_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_aaf_sp, tvb, AAF_SP_EVT_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_aaf_evt, tvb, AAF_SP_EVT_OFFSET, 1, FALSE);
+
+    if (remaining <= 0)
+        return;
+
+    ti = proto_tree_add_item(ieee1722_tree, hf_1722_aaf_data, tvb, AVTP_STREAM_PAYLOAD_OFFSET,
+                             MIN(datalen, remaining), FALSE);
+    dissect_1722_aaf_audio(tvb, ti, format, channels, frames, sample_size);
+}
+
+/* Clock Reference Format */
+static void dissect_1722_crf(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *ieee1722_tree,
+                             ieee1722_tap_info_t *tap_info)
+{
+    proto_item *ti = NULL;
+    proto_tree *data_tree = NULL;
+    guint32 pull_freq;
+    gdouble nominal_hz;
+    guint16 datalen;
+    gint remaining;
+    gint offset;
+
+    pull_freq = tvb_get_ntohl(tvb, CRF_PULL_FREQ_OFFSET);
+    nominal_hz = (pull_freq & CRF_BASE_FREQ_MASK) * crf_pull_factors[pull_freq >> 29];
+    if (tap_info)
+        tap_info->clock_nominal_hz = nominal_hz;
+
+    if (!ieee1722_tree)
+        return;
+
+    proto_tree_add_item(ieee1722_tree, hf_1722_mrfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_crf_fs, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_tufield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_seqnum, tvb, IEEE_1722_SEQ_NUM_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_crf_type, tvb, CRF_TYPE_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_stream_id, tvb, IEEE_1722_STREAM_ID_OFFSET, 8, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_crf_pull, tvb, CRF_PULL_FREQ_OFFSET, 4, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_crf_base_frequency, tvb, CRF_PULL_FREQ_OFFSET, 4, FALSE);
+    ti = proto_tree_add_double(ieee1722_tree, hf_1722_crf_nominal_frequency, tvb,
+                               CRF_PULL_FREQ_OFFSET, 4, nominal_hz);
+    PROTO_ITEM_SET_GENERATED(ti);
+    proto_tree_add_item(ieee1722_tree, hf_1722_crf_data_length, tvb, CRF_DATA_LENGTH_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_crf_timestamp_interval, tvb, CRF_TIMESTAMP_INTERVAL_OFFSET, 2, FALSE);
+
+    datalen = tvb_get_ntohs(tvb, CRF_DATA_LENGTH_OFFSET);
+    remaining = MIN(datalen, tvb_length_remaining(tvb, CRF_DATA_OFFSET));
+    if (remaining <= 0)
+        return;
+
+    /* One 64-bit gPTP timestamp per timestamp_interval media clock events */
+    ti = proto_tree_add_item(ieee1722_tree, hf_1722_crf_data, tvb, CRF_DATA_OFFSET, remaining, FALSE);
+    data_tree = proto_item_add_subtree(ti, ett_1722_crf_data);
+    for (offset = CRF_DATA_OFFSET; remaining >= 8; remaining -= 8, offset += 8)
+        proto_tree_add_item(data_tree, hf_1722_crf_timestamp, tvb, offset, 8, FALSE);
+}
+
+/* Non-Time-Synchronous Control Format */
+static void dissect_1722_ntscf(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *ieee1722_tree,
+                               ieee1722_tap_info_t *tap_info _U_)
+{
+    gint remaining;
+
+    if (!ieee1722_tree)
+        return;
+
+    proto_tree_add_item(ieee1722_tree, hf_1722_ntscf_data_length, tvb, NTSCF_DATA_LENGTH_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_seqnum, tvb, NTSCF_SEQ_NUM_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_stream_id, tvb, NTSCF_STREAM_ID_OFFSET, 8, FALSE);
+
+    remaining = tvb_length_remaining(tvb, NTSCF_PAYLOAD_OFFSET);
+    if (remaining > 0)
+        proto_tree_add_item(ieee1722_tree, hf_1722_payload, tvb, NTSCF_PAYLOAD_OFFSET, remaining, FALSE);
+}
+
+/* MAC Address Acquisition Protocol */
+static void dissect_1722_maap(tvbuff_t *tvb, packet_info *pinfo, proto_tree *ieee1722_tree,
+                              ieee1722_tap_info_t *tap_info _U_)
+{
+    guint8 message_type;
+
+    message_type = tvb_get_guint8(tvb, MAAP_MSG_TYPE_OFFSET) & MAAP_MSG_TYPE_MASK;
+    col_add_fstr(pinfo->cinfo, COL_INFO, "MAAP %s",
+                 val_to_str(message_type, maap_message_type_vals, "Unknown (%u)"));
+
+    if (!ieee1722_tree)
+        return;
+
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_message_type, tvb, MAAP_MSG_TYPE_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_version, tvb, MAAP_CD_LENGTH_OFFSET, 1, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_cd_length, tvb, MAAP_CD_LENGTH_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_stream_id, tvb, MAAP_STREAM_ID_OFFSET, 8, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_req_start_addr, tvb, MAAP_REQ_START_ADDR_OFFSET, 6, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_req_count, tvb, MAAP_REQ_COUNT_OFFSET, 2, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_conflict_start_addr, tvb, MAAP_CONFLICT_START_ADDR_OFFSET, 6, FALSE);
+    proto_tree_add_item(ieee1722_tree, hf_1722_maap_conflict_count, tvb, MAAP_CONFLICT_COUNT_OFFSET, 2, FALSE);
+}
+
+/* Name the talker of a stream data frame, if 1722.1 has learned it */
+static void ieee1722_add_talker(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint64 stream_id)
+{
+    const ieee17221_stream_talker_t *talker;
+    proto_item *ti;
+
+    talker = ieee17221_stream_talker(stream_id);
+    if (talker == NULL)
+        return;
+
+    if (talker->entity_name && talker->stream_name)
+        col_append_fstr(pinfo->cinfo, COL_INFO, ", Talker \"%s\" \"%s\"",
+                        talker->entity_name, talker->stream_name);
+    else if (talker->entity_name)
+        col_append_fstr(pinfo->cinfo, COL_INFO, ", Talker \"%s\"[%u]",
+                        talker->entity_name, talker->talker_unique_id);
+    else
+        col_append_fstr(pinfo->cinfo, COL_INFO, ", Talker 0x%016" G_GINT64_MODIFIER "x[%u]",
+                        talker->talker_guid, talker->talker_unique_id);
+
+    if (tree == NULL)
+        return;
+    ti = proto_tree_add_uint64(tree, hf_1722_talker_guid, tvb, IEEE_1722_STREAM_ID_OFFSET, 8,
+                               talker->talker_guid);
+    PROTO_ITEM_SET_GENERATED(ti);
+    ti = proto_tree_add_uint(tree, hf_1722_talker_unique_id, tvb, IEEE_1722_STREAM_ID_OFFSET, 8,
+                             talker->talker_unique_id);
+    PROTO_ITEM_SET_GENERATED(ti);
+    if (talker->entity_name) {
+        ti = proto_tree_add_string(tree, hf_1722_talker_name, tvb, IEEE_1722_STREAM_ID_OFFSET, 8,
+                                   talker->entity_name);
+        PROTO_ITEM_SET_GENERATED(ti);
+    }
+    if (talker->stream_name) {
+        ti = proto_tree_add_string(tree, hf_1722_talker_stream_name, tvb, IEEE_1722_STREAM_ID_OFFSET, 8,
+                                   talker->stream_name);
+        PROTO_ITEM_SET_GENERATED(ti);
+    }
+}
+
+/* encap_tvb is the UDP payload when the AVTPDU came over UDP, else NULL */
+static void dissect_1722_avtpdu(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, tvbuff_t *encap_tvb)
 {
     proto_item *ti = NULL;
     proto_tree *ieee1722_tree = NULL;
-    proto_tree *audio_tree = NULL;
-    proto_tree *sample_tree = NULL;
-    gint offset = 0;
-    guint16 datalen = 0;
-    guint8 dbs = 0;
+    avtp_frame_info_t frame;
+    avtp_frame_info_t *finfo = NULL;
+    ieee1722_tap_info_t *tap_info = NULL;
+    const avtp_subtype_entry_t *entry;
+    ieee1722_common_hdr_t common;
+    const gchar *name;
     guint8 subtype = 0;
-    int i, j;
+    gint remaining;
 
     col_set_str(pinfo->cinfo, COL_PROTOCOL, "IEEE1722");
 
-    col_set_str(pinfo->cinfo, COL_INFO, "AVB Transportation Protocol");
+    if (!pinfo->fd->flags.visited)
+        ieee17221_adp_advance(pinfo);
+
+    ieee1722_decode_common(tvb_get_ptr(tvb, 0, IEEE_1722_COMMON_HEADER_SIZE),
+                           IEEE_1722_COMMON_HEADER_SIZE, &common);
+    subtype = common.subtype;
+    entry = &avtp_subtypes[subtype];
+
+    name = match_strval(subtype, avtp_subtype_vals);
+    if (name)
+        col_set_str(pinfo->cinfo, COL_INFO, name);
+    else
+        col_add_fstr(pinfo->cinfo, COL_INFO, "Unknown AVTP subtype 0x%02x", subtype);
+
+    /* Stream data frames are tracked and tapped whether or not a tree is being built */
+    if (entry->seqnum_offset >= 0 && common.sv) {
+        tap_info = ep_alloc0(sizeof(ieee1722_tap_info_t));
+        tap_info->subtype = subtype;
+        tap_info->seqnum = tvb_get_guint8(tvb, entry->seqnum_offset);
+        tap_info->stream_id = tvb_get_ntoh64(tvb, IEEE_1722_STREAM_ID_OFFSET);
+
+        if (ieee1722_analyze_seqnum || ieee1722_analyze_pt || entry->analyze || ieee1722_analyze_bandwidth)
+            finfo = ieee1722_analyze_stream(tvb, pinfo, entry, tap_info->stream_id, tap_info->seqnum,
+                                            &frame);
+        if (finfo) {
+            tap_info->seq_status = finfo->seq_status;
+            tap_info->lost = finfo->lost;
+            tap_info->has_pt = finfo->has_pt;
+            tap_info->pt_margin_ns = finfo->pt_margin_ns;
+            tap_info->transit_jitter_ns = finfo->transit_jitter_ns;
+            tap_info->has_clock = finfo->has_clock;
+            tap_info->clock_drift_ppm = finfo->clock_drift_ppm;
+            tap_info->clock_jitter_ns = finfo->clock_jitter_ns;
+            tap_info->clock_faults = finfo->clock_faults;
+            tap_info->dbc_status = finfo->dbc_status;
+            tap_info->dbc_blocks = finfo->dbc_blocks;
+            tap_info->bw_faults = finfo->bw_faults;
+            tap_info->class_b = finfo->class_b;
+            tap_info->interval_frames = finfo->interval_frames;
+            tap_info->reserved_frames = finfo->reserved_frames;
+            tap_info->window_kbps = finfo->window_kbps;
+            tap_info->reserved_kbps = finfo->reserved_kbps;
+        }
+    }
 
     if (tree) {
         ti = proto_tree_add_item(tree, proto_1722, tvb, 0, -1, FALSE);
 
         ieee1722_tree = proto_item_add_subtree(ti, ett_1722);
 
+        if (encap_tvb)
+            proto_tree_add_item(ieee1722_tree, hf_1722_udp_encap_seqnum, encap_tvb,
+                                AVTP_UDP_ENCAP_SEQ_NUM_OFFSET, 4, FALSE);
+
         /* Add the CD and Subtype fields 
-         * CD field is 1 bit
-         * Subtype field is 7 bits
+         * CD field is the top bit of the subtype octet
+         * Subtype field is the whole octet since 1722-2016
          */
         proto_tree_add_item(ieee1722_tree, hf_1722_cdfield, tvb, IEEE_1722_CD_OFFSET, 1, FALSE);
         proto_tree_add_item(ieee1722_tree, hf_1722_subtype, tvb, IEEE_1722_CD_OFFSET, 1, FALSE);
         
         proto_tree_add_item(ieee1722_tree, hf_1722_svfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
         proto_tree_add_item(ieee1722_tree, hf_1722_verfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
-        
-        /* Version field ends the common AVTPDU. Now parse the specfic packet type */
-        subtype = tvb_get_guint8(tvb, IEEE_1722_CD_OFFSET);
-        subtype &= 0x7F;
-        
-        // fprintf(stderr, "subtype: %d\n", subtype);
-        
-        switch (subtype)
-        {
-            case 0x7A:
-            {
-                if (dissector_try_uint(avb_dissector_table, 0x7A, tvb, pinfo, tree))
-                {
-                    return;
-                }
-            }
-            case 0x7B:
-            {
-                if (dissector_try_uint(avb_dissector_table, 0x7B, tvb, pinfo, tree))
-                {
-                    return;
-                }
-            }
-            case 0x7C:
-            {
-                if (dissector_try_uint(avb_dissector_table, 0x7C, tvb, pinfo, tree))
-                {
-                    return;
-                }
-            }
-            default:
-                break;
-        }
-        
-        proto_tree_add_item(ieee1722_tree, hf_1722_mrfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
-        proto_tree_add_item(ieee1722_tree, hf_1722_gvfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
-        proto_tree_add_item(ieee1722_tree, hf_1722_tvfield, tvb, IEEE_1722_VERSION_OFFSET, 1, FALSE);
-
-        /* Add the rest of the packet fields */
-        proto_tree_add_item(ieee1722_tree, hf_1722_seqnum, tvb,
-                            IEEE_1722_SEQ_NUM_OFFSET, 1, FALSE);
-
-        proto_tree_add_item(ieee1722_tree, hf_1722_tufield, tvb,
-                            IEEE_1722_TU_FIELD_OFFSET, 1, FALSE);
-
-        proto_tree_add_item(ieee1722_tree, hf_1722_stream_id, tvb, 
-                            IEEE_1722_STREAM_ID_OFFSET, 8, FALSE);
-                            
-
-        proto_tree_add_item(ieee1722_tree, hf_1722_avbtp_timestamp, tvb,
-                            IEEE_1722_TIMESTAMP_OFFSET, 4, FALSE);
-
-        proto_tree_add_item(ieee1722_tree, hf_1722_gateway_info, tvb,
-                            IEEE_1722_GW_INFO_OFFSET, 4, FALSE);
-
-        proto_tree_add_item(ieee1722_tree, hf_1722_packet_data_length, tvb,
-                            IEEE_1722_PKT_DATA_LENGTH_OFFSET, 2, FALSE);
-
-        proto_tree_add_item(ieee1722_tree, hf_1722_tag, tvb,
-                            IEEE_1722_TAG_OFFSET, 1, FALSE);
-        proto_tree_add_item(ieee1722_tree, hf_1722_channel, tvb, 
-                            IEEE_1722_TAG_OFFSET, 1, FALSE);
+    }
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_tcode, tvb, 
-                            IEEE_1722_TCODE_OFFSET, 1, FALSE);
-        proto_tree_add_item(ieee1722_tree, hf_1722_sy, tvb,
-                            IEEE_1722_TCODE_OFFSET, 1, FALSE);
+    /* Version field ends the common AVTPDU. Now parse the specfic packet type */
+    if (entry->dissect) {
+        entry->dissect(tvb, pinfo, ieee1722_tree, tap_info);
+    }
+    else if (entry->handle) {
+        call_dissector(entry->handle, tvb, pinfo, tree);
+    }
+    else if (ieee1722_tree) {
+        remaining = tvb_length_remaining(tvb, IEEE_1722_SEQ_NUM_OFFSET);
+        if (remaining > 0)
+            proto_tree_add_item(ieee1722_tree, hf_1722_payload, tvb, IEEE_1722_SEQ_NUM_OFFSET, remaining, FALSE);
+    }
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_sid, tvb,
-                            IEEE_1722_SID_OFFSET, 1, FALSE);
+    if (tap_info)
+        ieee1722_add_talker(tvb, pinfo, ieee1722_tree, tap_info->stream_id);
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_dbs, tvb,
-                            IEEE_1722_DBS_OFFSET, 1, FALSE);
+    if (finfo)
+        ieee1722_add_stream_analysis(tvb, pinfo, ieee1722_tree, finfo);
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_fn, tvb,
-                            IEEE_1722_FN_OFFSET, 1, FALSE);
-        proto_tree_add_item(ieee1722_tree, hf_1722_qpc, tvb,
-                            IEEE_1722_FN_OFFSET, 1, FALSE);
-        proto_tree_add_item(ieee1722_tree, hf_1722_sph, tvb,
-                            IEEE_1722_FN_OFFSET, 1, FALSE);
+    if (tap_info)
+        tap_queue_packet(ieee1722_tap, pinfo, tap_info);
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_dbc, tvb,
-                            IEEE_1722_DBC_OFFSET, 1, FALSE);
+    ieee17221_adp_add_expiries(tvb, pinfo, ieee1722_tree);
+}
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_fmt, tvb,
-                            IEEE_1722_FMT_OFFSET, 1, FALSE);
+static void dissect_1722(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    dissect_1722_avtpdu(tvb, pinfo, tree, NULL);
+}
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_fdf, tvb,
-                            IEEE_1722_FDF_OFFSET, 1, FALSE);
+static void dissect_1722_udp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    tvbuff_t *next_tvb;
 
-        proto_tree_add_item(ieee1722_tree, hf_1722_syt, tvb,
-                            IEEE_1722_SYT_OFFSET, 2, FALSE);
+    next_tvb = tvb_new_subset(tvb, AVTP_UDP_ENCAP_SIZE, -1, -1);
+    dissect_1722_avtpdu(next_tvb, pinfo, tree, tvb);
+}
 
-        /* Calculate the remaining size by subtracting the CIP header size 
-           from the value in the packet data length field */
-        datalen = tvb_get_ntohs(tvb, IEEE_1722_PKT_DATA_LENGTH_OFFSET);
-        datalen -= IEEE_1722_CIP_HEADER_SIZE;
+/* Heuristic for AVTP over UDP on ports other than the configured one.
+ *
+ * This runs on every UDP payload nobody else claimed, so it only reads a
+ * few octets of the header and allocates nothing until it has accepted the
+ * datagram.  To be accepted, the subtype must have a dissector and the
+ * version must be 0.  The format's own length field, plus its header, must
+ * also account for exactly the rest of the datagram.  Annex J has no
+ * padding, so random data almost never gets past that last check.
+ */
+static gboolean dissect_1722_udp_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    const avtp_subtype_entry_t *entry;
+    guint captured, length;
+    guint header_size, data_length;
+    guint8 subtype, octet;
 
-        /* Make the Audio sample tree. */
-        ti = proto_tree_add_item(ieee1722_tree, hf_1722_data, tvb, 
-                                 IEEE_1722_DATA_OFFSET, datalen, FALSE);
+    if (!ieee1722_udp_heuristic)
+        return FALSE;
 
-        audio_tree = proto_item_add_subtree(ti, ett_1722_audio);
+    captured = tvb_length(tvb);
+    if (captured < AVTP_UDP_ENCAP_SIZE + AVTP_CONTROL_HEADER_SIZE)
+        return FALSE;
 
-        /* Need to get the offset of where the audio data starts */
-        offset = IEEE_1722_DATA_OFFSET;
-        dbs = tvb_get_guint8(tvb, IEEE_1722_DBS_OFFSET);
+    subtype = tvb_get_guint8(tvb, AVTP_UDP_ENCAP_SIZE + IEEE_1722_CD_OFFSET);
+    entry = &avtp_subtypes[subtype];
+    if (entry->dissect == NULL && entry->handle == NULL)
+        return FALSE;
 
-        /* If the DBS is ever 0 for whatever reason, then just add the rest of packet as unknown */
-        if(dbs == 0)
-            proto_tree_add_text(ieee1722_tree, tvb, IEEE_1722_DATA_OFFSET, datalen, "Incorrect DBS");
+    octet = tvb_get_guint8(tvb, AVTP_UDP_ENCAP_SIZE + IEEE_1722_VERSION_OFFSET);
+    if (octet & IEEE_1722_VER_MASK)
+        return FALSE;
 
+    if (subtype == AVTP_SUBTYPE_NTSCF) {
+        header_size = NTSCF_PAYLOAD_OFFSET;
+        data_length = tvb_get_ntohs(tvb, AVTP_UDP_ENCAP_SIZE + NTSCF_DATA_LENGTH_OFFSET) &
+                      NTSCF_DATA_LENGTH_MASK;
+    }
+    else if (subtype & IEEE_1722_CD_MASK) {
+        header_size = AVTP_CONTROL_HEADER_SIZE;
+        data_length = tvb_get_ntohs(tvb, AVTP_UDP_ENCAP_SIZE + AVTP_CONTROL_DATA_LENGTH_OFFSET) &
+                      AVTP_CONTROL_DATA_LENGTH_MASK;
+    }
+    else {
+        /* Stream formats always carry a stream_id */
+        if (!(octet & IEEE_1722_SV_MASK))
+            return FALSE;
+        if (subtype == AVTP_SUBTYPE_CRF) {
+            header_size = CRF_DATA_OFFSET;
+            if (captured < AVTP_UDP_ENCAP_SIZE + header_size)
+                return FALSE;
+            data_length = tvb_get_ntohs(tvb, AVTP_UDP_ENCAP_SIZE + CRF_DATA_LENGTH_OFFSET);
+        }
         else {
-            /* Loop through all samples and add them to the audio tree. */
-            for (j = 0; j < (datalen / (dbs*4)); j++) {
-                ti = proto_tree_add_text(audio_tree, tvb, offset, 1, "Sample %d", j+1);
-                sample_tree = proto_item_add_subtree(ti, ett_1722_sample);
-                for (i = 0; i < dbs; i++) {
-                    proto_tree_add_item(sample_tree, hf_1722_label, tvb, offset, 1, FALSE);
-                    offset += 1;
-
-                    proto_tree_add_item(sample_tree, hf_1722_sample, tvb, offset, 3, FALSE);
-                    offset += 3;
-                }
-            }
+            header_size = AVTP_STREAM_PAYLOAD_OFFSET;
+            if (captured < AVTP_UDP_ENCAP_SIZE + header_size)
+                return FALSE;
+            data_length = tvb_get_ntohs(tvb, AVTP_UDP_ENCAP_SIZE + AVTP_STREAM_DATA_LENGTH_OFFSET);
         }
     }
+
+    length = tvb_reported_length(tvb);
+    if (AVTP_UDP_ENCAP_SIZE + header_size + data_length != length)
+        return FALSE;
+
+    dissect_1722_udp(tvb, pinfo, tree);
+    return TRUE;
 }
 
+void proto_reg_handoff_1722(void);
+
 /* Register the protocol with Wireshark */
 void proto_register_1722(void) 
 {
+    module_t *ieee1722_module;
+
     static hf_register_info hf[] = {
         { &hf_1722_cdfield,
             { "Control/Data Indicator", "ieee1722.cdfield", 
@@ -291,7 +2523,7 @@ void proto_register_1722(void)
         },
         { &hf_1722_subtype,
             { "AVBTP Subtype", "ieee1722.subtype",
-              FT_UINT8, BASE_HEX, NULL, IEEE_1722_SUBTYPE_MASK, NULL, HFILL } 
+              FT_UINT8, BASE_HEX, VALS(avtp_subtype_vals), 0x00, NULL, HFILL } 
         },
         { &hf_1722_svfield,
             { "AVBTP Stream ID Valid", "ieee1722.svfield",
@@ -327,7 +2559,8 @@ void proto_register_1722(void)
         },
         { &hf_1722_avbtp_timestamp,
             { "AVBTP Timestamp", "ieee1722.avbtp_timestamp",
-              FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL }
+              FT_UINT32, BASE_DEC, NULL, 0x00,
+              "Presentation time: the low 32 bits of gPTP time in ns", HFILL }
         },
         { &hf_1722_gateway_info,
             { "Gateway Info", "ieee1722.gateway_info",
@@ -389,24 +2622,312 @@ void proto_register_1722(void)
             { "SYT", "ieee1722.syt",
               FT_UINT16, BASE_HEX, NULL, 0x00, NULL, HFILL }
         },
+        { &hf_1722_syt_cycle,
+            { "SYT Cycle Count", "ieee1722.syt.cycle",
+              FT_UINT16, BASE_DEC, NULL, IEEE_1722_SYT_CYCLE_MASK,
+              "1394 cycle (of 125 us) within the 2 ms SYT range", HFILL }
+        },
+        { &hf_1722_syt_cycle_offset,
+            { "SYT Cycle Offset", "ieee1722.syt.cycle_offset",
+              FT_UINT16, BASE_DEC, NULL, IEEE_1722_SYT_CYCLE_OFFSET_MASK,
+              "Offset into the cycle in 24.576 MHz ticks (0-3071)", HFILL }
+        },
         { &hf_1722_data,
             { "Audio Data", "ieee1722.data",
               FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
         },
         { &hf_1722_label,
             { "Label", "ieee1722.data.sample.label",
-              FT_UINT8, BASE_HEX, NULL, 0x00, NULL, HFILL }
+              FT_UINT8, BASE_HEX, VALS(am824_label_vals), 0x00, NULL, HFILL }
         },
         { &hf_1722_sample,
             { "Sample", "ieee1722.data.sample.sampledata",
               FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
         },
+        { &hf_1722_analysis_expected_seqnum,
+            { "Expected Sequence Number", "ieee1722.analysis.expected_seqnum",
+              FT_UINT8, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_analysis_lost,
+            { "Packets Lost", "ieee1722.analysis.lost",
+              FT_UINT8, BASE_DEC, NULL, 0x00,
+              "Number of stream packets missing before this one", HFILL }
+        },
+        { &hf_1722_analysis_duplicate,
+            { "Duplicate Packet", "ieee1722.analysis.duplicate",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "Sequence number already seen within the tracking window", HFILL }
+        },
+        { &hf_1722_analysis_out_of_order,
+            { "Out-of-Order Packet", "ieee1722.analysis.out_of_order",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "Sequence number older than the highest seen on this stream", HFILL }
+        },
+        { &hf_1722_analysis_pt_margin,
+            { "Presentation Time Margin (ns)", "ieee1722.analysis.pt_margin",
+              FT_INT64, BASE_DEC, NULL, 0x00,
+              "Presentation time minus capture time; negative means the frame was late", HFILL }
+        },
+        { &hf_1722_format_info,
+            { "Format Specific Data", "ieee1722.format_info",
+              FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_stream_data_length,
+            { "Stream Data Length", "ieee1722.stream_data_length",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_format_info2,
+            { "Format Specific Data 2", "ieee1722.format_info2",
+              FT_UINT16, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_payload,
+            { "Payload", "ieee1722.payload",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_udp_encap_seqnum,
+            { "Encapsulation Sequence Number", "ieee1722.udp.encap_seqnum",
+              FT_UINT32, BASE_DEC, NULL, 0x00,
+              "Sequence number of the IEEE 1722-2016 Annex J UDP encapsulation", HFILL }
+        },
+        { &hf_1722_talker_guid,
+            { "Talker GUID", "ieee1722.talker.guid",
+              FT_UINT64, BASE_HEX, NULL, 0x00,
+              "Talker entity of the stream, from 1722.1 ACMP", HFILL }
+        },
+        { &hf_1722_talker_unique_id,
+            { "Talker Unique ID", "ieee1722.talker.unique_id",
+              FT_UINT16, BASE_DEC, NULL, 0x00,
+              "Talker's stream output index, from 1722.1 ACMP", HFILL }
+        },
+        { &hf_1722_talker_name,
+            { "Talker Name", "ieee1722.talker.name",
+              FT_STRING, BASE_NONE, NULL, 0x00,
+              "Entity name of the talker, from 1722.1 AECP", HFILL }
+        },
+        { &hf_1722_talker_stream_name,
+            { "Talker Stream Name", "ieee1722.talker.stream_name",
+              FT_STRING, BASE_NONE, NULL, 0x00,
+              "Name of the talker's STREAM_OUTPUT, from 1722.1 AECP", HFILL }
+        },
+        { &hf_1722_aaf_format,
+            { "Format", "ieee1722.aaf.format",
+              FT_UINT8, BASE_DEC, VALS(aaf_format_vals), 0x00, NULL, HFILL }
+        },
+        { &hf_1722_aaf_nsr,
+            { "Nominal Sample Rate", "ieee1722.aaf.nsr",
+              FT_UINT8, BASE_HEX, VALS(aaf_nsr_vals), AAF_NSR_MASK, NULL, HFILL }
+        },
+        { &hf_1722_aaf_channels,
+            { "Channels per Frame", "ieee1722.aaf.channels_per_frame",
+              FT_UINT16, BASE_DEC, NULL, AAF_CHANNELS_MASK, NULL, HFILL }
+        },
+        { &hf_1722_aaf_bit_depth,
+            { "Bit Depth", "ieee1722.aaf.bit_depth",
+              FT_UINT8, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_aaf_sp,
+            { "Sparse Timestamp Mode", "ieee1722.aaf.sp",
+              FT_BOOLEAN, 8, NULL, AAF_SP_MASK, NULL, HFILL }
+        },
+        { &hf_1722_aaf_evt,
+            { "Event", "ieee1722.aaf.evt",
+              FT_UINT8, BASE_HEX, NULL, AAF_EVT_MASK, NULL, HFILL }
+        },
+        { &hf_1722_aaf_data,
+            { "Audio Data", "ieee1722.aaf.data",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_aaf_peak,
+            { "Peak (dBFS)", "ieee1722.aaf.peak",
+              FT_FLOAT, BASE_NONE, NULL, 0x00, "Largest absolute sample of the channel in this packet", HFILL }
+        },
+        { &hf_1722_aaf_rms,
+            { "RMS (dBFS)", "ieee1722.aaf.rms",
+              FT_FLOAT, BASE_NONE, NULL, 0x00, "RMS level of the channel in this packet", HFILL }
+        },
+        { &hf_1722_cvf_format,
+            { "CVF Format", "ieee1722.cvf.format",
+              FT_UINT8, BASE_HEX, VALS(cvf_format_vals), 0x00, NULL, HFILL }
+        },
+        { &hf_1722_cvf_format_subtype,
+            { "CVF Format Subtype", "ieee1722.cvf.format_subtype",
+              FT_UINT8, BASE_HEX, VALS(cvf_format_subtype_vals), 0x00, NULL, HFILL }
+        },
+        { &hf_1722_cvf_ptv,
+            { "H.264 Timestamp Valid", "ieee1722.cvf.ptv",
+              FT_BOOLEAN, 8, NULL, CVF_PTV_MASK, NULL, HFILL }
+        },
+        { &hf_1722_cvf_m,
+            { "Marker", "ieee1722.cvf.m",
+              FT_BOOLEAN, 8, NULL, CVF_M_MASK, "Last packet of a video frame", HFILL }
+        },
+        { &hf_1722_cvf_evt,
+            { "Event", "ieee1722.cvf.evt",
+              FT_UINT8, BASE_HEX, NULL, CVF_EVT_MASK, NULL, HFILL }
+        },
+        { &hf_1722_cvf_h264_timestamp,
+            { "H.264 Timestamp", "ieee1722.cvf.h264_timestamp",
+              FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_cvf_fragment,
+            { "H.264 FU-A Fragment", "ieee1722.cvf.fragment",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_cvf_reassembled_in,
+            { "Reassembled In", "ieee1722.cvf.reassembled_in",
+              FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+              "Frame holding the last fragment of this NAL unit", HFILL }
+        },
+        { &hf_1722_cvf_reassembled_length,
+            { "Reassembled NAL Length", "ieee1722.cvf.reassembled_length",
+              FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_cvf_nal,
+            { "H.264 NAL Unit", "ieee1722.cvf.nal",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_crf_fs,
+            { "Frame Sync", "ieee1722.crf.fs",
+              FT_BOOLEAN, 8, NULL, CRF_FS_MASK, NULL, HFILL }
+        },
+        { &hf_1722_crf_type,
+            { "CRF Type", "ieee1722.crf.type",
+              FT_UINT8, BASE_DEC, VALS(crf_type_vals), 0x00, NULL, HFILL }
+        },
+        { &hf_1722_crf_pull,
+            { "Pull", "ieee1722.crf.pull",
+              FT_UINT32, BASE_DEC, VALS(crf_pull_vals), CRF_PULL_MASK, NULL, HFILL }
+        },
+        { &hf_1722_crf_base_frequency,
+            { "Base Frequency", "ieee1722.crf.base_frequency",
+              FT_UINT32, BASE_DEC, NULL, CRF_BASE_FREQ_MASK, NULL, HFILL }
+        },
+        { &hf_1722_crf_data_length,
+            { "CRF Data Length", "ieee1722.crf.data_length",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_crf_timestamp_interval,
+            { "Timestamp Interval", "ieee1722.crf.timestamp_interval",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_crf_data,
+            { "CRF Data", "ieee1722.crf.data",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_crf_timestamp,
+            { "CRF Timestamp", "ieee1722.crf.timestamp",
+              FT_UINT64, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_crf_nominal_frequency,
+            { "Nominal Frequency (Hz)", "ieee1722.crf.nominal_frequency",
+              FT_DOUBLE, BASE_NONE, NULL, 0x00,
+              "Base frequency multiplied by the pull factor", HFILL }
+        },
+        { &hf_1722_ntscf_data_length,
+            { "NTSCF Data Length", "ieee1722.ntscf.data_length",
+              FT_UINT16, BASE_DEC, NULL, NTSCF_DATA_LENGTH_MASK, NULL, HFILL }
+        },
+        { &hf_1722_maap_message_type,
+            { "Message Type", "ieee1722.maap.message_type",
+              FT_UINT8, BASE_DEC, VALS(maap_message_type_vals), MAAP_MSG_TYPE_MASK, NULL, HFILL }
+        },
+        { &hf_1722_maap_version,
+            { "MAAP Version", "ieee1722.maap.version",
+              FT_UINT8, BASE_DEC, NULL, MAAP_VERSION_MASK, NULL, HFILL }
+        },
+        { &hf_1722_maap_cd_length,
+            { "Control Data Length", "ieee1722.maap.control_data_length",
+              FT_UINT16, BASE_DEC, NULL, MAAP_CD_LENGTH_MASK, NULL, HFILL }
+        },
+        { &hf_1722_maap_req_start_addr,
+            { "Requested Start Address", "ieee1722.maap.requested_start_address",
+              FT_ETHER, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_maap_req_count,
+            { "Requested Count", "ieee1722.maap.requested_count",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_maap_conflict_start_addr,
+            { "Conflict Start Address", "ieee1722.maap.conflict_start_address",
+              FT_ETHER, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_maap_conflict_count,
+            { "Conflict Count", "ieee1722.maap.conflict_count",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_analysis_transit_jitter,
+            { "Transit Jitter (ns)", "ieee1722.analysis.transit_jitter",
+              FT_UINT32, BASE_DEC, NULL, 0x00,
+              "Smoothed variation of capture time minus presentation time", HFILL }
+        },
+        { &hf_1722_analysis_clock_drift,
+            { "Media Clock Drift (ppm)", "ieee1722.analysis.clock_drift",
+              FT_DOUBLE, BASE_NONE, NULL, 0x00,
+              "Frequency offset of the CRF or 61883-6 media clock from its nominal rate; "
+              "positive is fast", HFILL }
+        },
+        { &hf_1722_analysis_clock_jitter,
+            { "Media Clock Phase Jitter (ns)", "ieee1722.analysis.clock_jitter",
+              FT_DOUBLE, BASE_NONE, NULL, 0x00,
+              "RMS deviation of the timestamps from the fitted media clock", HFILL }
+        },
+        { &hf_1722_analysis_expected_dbc,
+            { "Expected DBC", "ieee1722.analysis.expected_dbc",
+              FT_UINT8, BASE_DEC, NULL, 0x00,
+              "DBC of the previous packet plus its data blocks", HFILL }
+        },
+        { &hf_1722_analysis_blocks_lost,
+            { "Data Blocks Lost", "ieee1722.analysis.blocks_lost",
+              FT_UINT8, BASE_DEC, NULL, 0x00,
+              "Data blocks between the expected and the actual DBC", HFILL }
+        },
+        { &hf_1722_analysis_blocks_repeated,
+            { "Data Blocks Repeated", "ieee1722.analysis.blocks_repeated",
+              FT_UINT8, BASE_DEC, NULL, 0x00,
+              "Data blocks this packet repeats from the previous one", HFILL }
+        },
+        { &hf_1722_analysis_syt_backwards,
+            { "SYT Went Backwards", "ieee1722.analysis.syt_backwards",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_1722_analysis_sr_class,
+            { "SR Class", "ieee1722.analysis.sr_class",
+              FT_UINT8, BASE_DEC, VALS(sr_class_vals), 0x00,
+              "From the ACMP connection of the stream; class A if none was seen", HFILL }
+        },
+        { &hf_1722_analysis_interval_frames,
+            { "Frames In Class Interval", "ieee1722.analysis.interval_frames",
+              FT_UINT16, BASE_DEC, NULL, 0x00,
+              "Frames of the stream captured in this SR class interval so far", HFILL }
+        },
+        { &hf_1722_analysis_reserved_frames,
+            { "Reserved Frames Per Interval", "ieee1722.analysis.reserved_frames",
+              FT_UINT16, BASE_DEC, NULL, 0x00,
+              "Frames per SR class interval the stream format needs", HFILL }
+        },
+        { &hf_1722_analysis_window_bandwidth,
+            { "Window Bandwidth (kbit/s)", "ieee1722.analysis.window_bandwidth",
+              FT_UINT32, BASE_DEC, NULL, 0x00,
+              "Bandwidth of the stream over the last 32 SR class intervals, on captured frame lengths",
+              HFILL }
+        },
+        { &hf_1722_analysis_reserved_bandwidth,
+            { "Reserved Bandwidth (kbit/s)", "ieee1722.analysis.reserved_bandwidth",
+              FT_UINT32, BASE_DEC, NULL, 0x00,
+              "Reserved frames per interval at the length of this frame", HFILL }
+        },
     };
 
     static gint *ett[] = {
         &ett_1722,
         &ett_1722_audio,
-        &ett_1722_sample
+        &ett_1722_sample,
+        &ett_1722_syt,
+        &ett_1722_analysis,
+        &ett_1722_aaf_audio,
+        &ett_1722_aaf_channel,
+        &ett_1722_crf_data,
+        &ett_1722_cvf_fragment
     };
 
     /* Register the protocol name and description */
@@ -415,6 +2936,91 @@ void proto_register_1722(void)
     /* Required function calls to register the header fields and subtrees used */
     proto_register_field_array(proto_1722, hf, array_length(hf));
     proto_register_subtree_array(ett, array_length(ett));
+
+    ieee1722_module = prefs_register_protocol(proto_1722, proto_reg_handoff_1722);
+    prefs_register_enum_preference(ieee1722_module, "sample_tree",
+        "Audio sample tree",
+        "How the 61883-6 audio samples are shown. In summary mode the Audio Data item "
+        "lists the block count and label histogram, and the per-sample subtree is only "
+        "built when it is expanded or a filter references ieee1722.data.sample.*",
+        &ieee1722_sample_tree_mode, sample_tree_modes, FALSE);
+    prefs_register_uint_preference(ieee1722_module, "max_sample_blocks",
+        "Maximum data blocks shown",
+        "Maximum number of data blocks rendered in the audio sample tree (0 = no limit)",
+        10, &ieee1722_max_sample_blocks);
+    prefs_register_bool_preference(ieee1722_module, "analyze_seqnum",
+        "Analyze stream sequence numbers",
+        "Track sequence numbers per stream ID and flag lost, duplicate and out-of-order packets",
+        &ieee1722_analyze_seqnum);
+    prefs_register_bool_preference(ieee1722_module, "analyze_presentation_time",
+        "Analyze presentation time",
+        "Compare the AVTP timestamp of each stream with the capture time and report the "
+        "presentation time margin and transit jitter. Needs a gPTP-synchronised capture clock",
+        &ieee1722_analyze_pt);
+    prefs_register_uint_preference(ieee1722_module, "latency_budget",
+        "Latency budget (us)",
+        "Presentation time margins above this are flagged (2000 us for SR Class A)",
+        10, &ieee1722_latency_budget_us);
+    prefs_register_uint_preference(ieee1722_module, "capture_clock_offset",
+        "Capture clock offset (s)",
+        "Seconds to add to the capture time to get gPTP time, e.g. 37 when the capture "
+        "clock runs on UTC",
+        10, &ieee1722_capture_clock_offset);
+    prefs_register_uint_preference(ieee1722_module, "state_memory",
+        "Analysis state memory (KiB)",
+        "Memory for the per-stream and per-entity state of the 1722 and 1722.1 analyses. "
+        "When it runs out, the streams, entities and transactions unused the longest are "
+        "forgotten, so a long live capture runs in constant memory (at least 64 KiB)",
+        10, &ieee1722_state_budget_kb);
+    prefs_register_bool_preference(ieee1722_module, "keep_frame_results",
+        "Keep per-frame results for revisiting",
+        "Keep what the first pass found for every frame, such as the H.264 NAL a CVF "
+        "fragment belongs to or the command an ACMP response answers, so frames show the "
+        "same when dissected again. Turn off for one-pass tshark runs over long captures: "
+        "only frames with a warning then keep anything",
+        &ieee1722_state_revisit);
+    prefs_register_bool_preference(ieee1722_module, "analyze_dbc",
+        "Check 61883-6 DBC continuity",
+        "Flag data blocks skipped or repeated within a 61883-6 stream, even when no AVTP "
+        "packet was lost, and count the data blocks lost with missing packets",
+        &ieee1722_analyze_dbc);
+    prefs_register_bool_preference(ieee1722_module, "analyze_media_clock",
+        "Analyze media clocks",
+        "Estimate the drift and phase jitter of the media clock of each CRF stream from its "
+        "timestamps and of each 61883-6 stream from its AVTP timestamps and DBC, and flag "
+        "SYT discontinuities",
+        &ieee1722_analyze_clock);
+    prefs_register_uint_preference(ieee1722_module, "media_clock_window",
+        "Media clock averaging window (s)",
+        "Time constant of the media clock drift and jitter estimates",
+        10, &ieee1722_clock_window_s);
+    prefs_register_bool_preference(ieee1722_module, "analyze_bandwidth",
+        "Check SR class bandwidth",
+        "Count the frames of each stream per SR class interval (125 us class A, 250 us "
+        "class B, as set up by ACMP) and flag bursts and windows over the reservation "
+        "its audio or CRF format implies",
+        &ieee1722_analyze_bandwidth);
+    prefs_register_bool_preference(ieee1722_module, "reassemble_cvf",
+        "Reassemble fragmented H.264 NAL units",
+        "Join CVF H.264 FU-A fragments of a stream and pass whole NAL units to the H.264 dissector",
+        &ieee1722_reassemble_cvf);
+    prefs_register_uint_preference(ieee1722_module, "cvf_max_nal_size",
+        "Maximum reassembled NAL size (KiB)",
+        "NAL units growing beyond this, or beyond a quarter of the analysis state memory, "
+        "are dropped as incomplete",
+        10, &ieee1722_cvf_max_nal_kb);
+    prefs_register_uint_preference(ieee1722_module, "udp.port",
+        "AVTP UDP port",
+        "UDP port of AVTP over UDP (IEEE 1722-2016 Annex J), 0 to disable",
+        10, &ieee1722_udp_port);
+    prefs_register_bool_preference(ieee1722_module, "udp_heuristic",
+        "Try to detect AVTP over UDP on other ports",
+        "Check every otherwise undissected UDP payload for an Annex J encapsulated AVTPDU",
+        &ieee1722_udp_heuristic);
+
+    register_init_routine(ieee1722_init);
+
+    ieee1722_tap = register_tap("ieee1722");
     
     /* Sub-dissector for 1772.1 */
 	avb_dissector_table = register_dissector_table("ieee1722.subtype",
@@ -422,11 +3028,68 @@ void proto_register_1722(void)
         
 }
 
+static void avtp_subtype_add(guint8 subtype, avtp_subtype_dissector_t dissect,
+                             gint seqnum_offset, gboolean has_timestamp)
+{
+    avtp_subtypes[subtype].dissect = dissect;
+    avtp_subtypes[subtype].seqnum_offset = seqnum_offset;
+    avtp_subtypes[subtype].has_timestamp = has_timestamp;
+}
+
+/* Hook up the per-subtype analyzers the preferences ask for */
+static void avtp_subtypes_set_analyzers(void)
+{
+    avtp_subtypes[AVTP_SUBTYPE_61883_IIDC].analyze =
+        (ieee1722_analyze_dbc || ieee1722_analyze_clock) ? ieee1722_track_61883 : NULL;
+    avtp_subtypes[AVTP_SUBTYPE_CRF].analyze = ieee1722_analyze_clock ? ieee1722_track_crf : NULL;
+}
+
 void proto_reg_handoff_1722(void) 
 {
+    static gboolean initialized = FALSE;
+    static dissector_handle_t avtp_udp_handle;
+    static guint current_udp_port = 0;
     dissector_handle_t avbtp_handle;
+    guint i;
+
+    /* Called again whenever the preferences change */
+    if (initialized) {
+        if (current_udp_port != 0)
+            dissector_delete_uint("udp.port", current_udp_port, avtp_udp_handle);
+        current_udp_port = ieee1722_udp_port;
+        if (current_udp_port != 0)
+            dissector_add_uint("udp.port", current_udp_port, avtp_udp_handle);
+        avtp_subtypes_set_analyzers();
+        return;
+    }
+    initialized = TRUE;
 
     avbtp_handle = create_dissector_handle(dissect_1722, proto_1722);
     dissector_add_uint("ethertype", ETHERTYPE_AVBTP, avbtp_handle);
-    avb17221_handle = find_dissector("ieee17221");
+
+    avtp_udp_handle = create_dissector_handle(dissect_1722_udp, proto_1722);
+    current_udp_port = ieee1722_udp_port;
+    if (current_udp_port != 0)
+        dissector_add_uint("udp.port", current_udp_port, avtp_udp_handle);
+    heur_dissector_add("udp", dissect_1722_udp_heur, proto_1722);
+
+    for (i = 0; i < G_N_ELEMENTS(avtp_subtypes); i++)
+        avtp_subtypes[i].seqnum_offset = -1;
+
+    avtp_subtype_add(AVTP_SUBTYPE_61883_IIDC, dissect_1722_61883, IEEE_1722_SEQ_NUM_OFFSET, TRUE);
+    avtp_subtype_add(AVTP_SUBTYPE_AAF, dissect_1722_aaf, IEEE_1722_SEQ_NUM_OFFSET, TRUE);
+    avtp_subtype_add(AVTP_SUBTYPE_CVF, dissect_1722_cvf, IEEE_1722_SEQ_NUM_OFFSET, TRUE);
+    avtp_subtype_add(AVTP_SUBTYPE_CRF, dissect_1722_crf, IEEE_1722_SEQ_NUM_OFFSET, FALSE);
+    avtp_subtype_add(AVTP_SUBTYPE_TSCF, dissect_1722_common_stream, IEEE_1722_SEQ_NUM_OFFSET, TRUE);
+    avtp_subtype_add(AVTP_SUBTYPE_SVF, dissect_1722_common_stream, IEEE_1722_SEQ_NUM_OFFSET, TRUE);
+    avtp_subtype_add(AVTP_SUBTYPE_RVF, dissect_1722_common_stream, IEEE_1722_SEQ_NUM_OFFSET, TRUE);
+    avtp_subtype_add(AVTP_SUBTYPE_NTSCF, dissect_1722_ntscf, NTSCF_SEQ_NUM_OFFSET, FALSE);
+    avtp_subtype_add(AVTP_SUBTYPE_MAAP, dissect_1722_maap, -1, FALSE);
+
+    avtp_subtypes_set_analyzers();
+    avtp_subtypes[AVTP_SUBTYPE_61883_IIDC].packet_rate = ieee1722_61883_packet_rate;
+    avtp_subtypes[AVTP_SUBTYPE_AAF].packet_rate = ieee1722_aaf_packet_rate;
+    avtp_subtypes[AVTP_SUBTYPE_CRF].packet_rate = ieee1722_crf_packet_rate;
+
+    h264_handle = find_dissector("h264");
 }
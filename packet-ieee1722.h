@@ -0,0 +1,75 @@
+/* packet-ieee1722.h
+ * Definitions shared by the IEEE 1722 (AVB-TP) dissector and its taps
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __PACKET_IEEE1722_H__
+#define __PACKET_IEEE1722_H__
+
+/* Outcome of the per-stream sequence number analysis */
+#define IEEE1722_SEQ_OK             0
+#define IEEE1722_SEQ_LOST           1
+#define IEEE1722_SEQ_DUPLICATE      2
+#define IEEE1722_SEQ_OUT_OF_ORDER   3
+
+/* Outcome of the per-stream 61883-6 DBC continuity check */
+#define IEEE1722_DBC_OK             0
+#define IEEE1722_DBC_SKIPPED        1   /* blocks missing, no packet lost */
+#define IEEE1722_DBC_REPEATED       2
+#define IEEE1722_DBC_LOST           3   /* blocks carried by lost packets */
+
+/* Media clock discontinuities, ORed together */
+#define IEEE1722_CLOCK_SYT_BACKWARDS    0x01
+
+/* SR class reservation faults, ORed together */
+#define IEEE1722_BW_BURST               0x01    /* too many frames in one class interval */
+#define IEEE1722_BW_OVERSUBSCRIBED      0x02    /* too many frames over the window */
+
+/* Queued on the "ieee1722" tap for every stream data frame */
+typedef struct _ieee1722_tap_info {
+    guint64 stream_id;
+    guint8  subtype;
+    guint8  seqnum;
+    guint8  seq_status;     /* IEEE1722_SEQ_xxx */
+    guint8  lost;           /* packets missing before this one */
+    guint8  dbs;            /* 61883 CIP fields; for AAF channels_per_frame, */
+    guint8  fmt;            /* format and nsr, with one data block per */
+    guint8  fdf;            /* audio frame */
+    guint16 data_blocks;
+    const guint8 *am824;    /* data_blocks*dbs AM824 quadlets, or NULL */
+    gboolean has_pt;        /* presentation time analysed */
+    gint64  pt_margin_ns;   /* presentation time minus capture time */
+    guint32 transit_jitter_ns;
+    gdouble clock_nominal_hz;   /* CRF nominal frequency or 61883-6 sample rate */
+    gboolean has_clock;         /* media clock estimate available */
+    gfloat  clock_drift_ppm;
+    gfloat  clock_jitter_ns;
+    guint8  clock_faults;       /* IEEE1722_CLOCK_xxx */
+    guint8  dbc_status;         /* IEEE1722_DBC_xxx */
+    guint8  dbc_blocks;         /* data blocks skipped, repeated or lost */
+    guint8  bw_faults;          /* IEEE1722_BW_xxx */
+    gboolean class_b;           /* SR class B, else A; with bw_faults */
+    guint16 interval_frames;    /* frames in this class interval */
+    guint16 reserved_frames;    /* per class interval, implied by the format */
+    guint32 window_kbps;        /* over the bandwidth window */
+    guint32 reserved_kbps;
+} ieee1722_tap_info_t;
+
+#endif /* __PACKET_IEEE1722_H__ */
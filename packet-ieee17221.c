@@ -28,39 +28,21 @@
 #endif
 
 #include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
 
 #include <epan/packet.h>
 #include <epan/etypes.h>
+#include <epan/emem.h>
+#include <epan/expert.h>
+#include <epan/tap.h>
 
-/* 1722.1 ADP Offsets */
-#define ADP_CD_OFFSET                       0
-#define ADP_VERSION_OFFSET                  1
-#define ADP_VALID_TIME_OFFSET               2
-#define ADP_CD_LENGTH_OFFSET                3
-#define ADP_ENTITY_GUID_OFFSET              4
-#define ADP_VENDOR_ID_OFFSET                12
-#define ADP_MODEL_ID_OFFSET                 16
-#define ADP_ENTITY_CAP_OFFSET               20
-#define ADP_TALKER_STREAM_SRCS_OFFSET       24
-#define ADP_TALKER_CAP_OFFSET               26
-#define ADP_LISTENER_STREAM_SINKS_OFFSET    28
-#define ADP_LISTENER_CAP_OFFSET             30
-#define ADP_CONTROLLER_CAP_OFFSET           32
-#define ADP_AVAIL_INDEX_OFFSET              36
-#define ADP_AS_GM_ID_OFFSET                 40
-#define ADP_DEF_AUDIO_FORMAT_OFFSET         48
-#define ADP_CHAN_FORMAT_OFFSET              50
-#define ADP_DEF_VIDEO_FORMAT_OFFSET         52
-#define ADP_ASSOC_ID_OFFSET                 56
-#define ADP_ENTITY_TYPE_OFFSET              64
-
-/* Bit Field Masks */
-
-#define ADP_MSG_TYPE_MASK                   0x0f
-#define ADP_VALID_TIME_MASK                 0xf8
-#define ADP_CD_LENGTH_MASK                  0x07ff
+#include "packet-ieee17221.h"
+#include "ieee1722-decode.h"
+#include "ieee1722-state.h"
 
-/* message_type */
+/* ADP message_type */
 
 #define ADP_ENTITY_AVAILABLE_MESSAGE        0x00
 #define ADP_ENTITY_DEPARTING_MESSAGE        0x01
@@ -133,30 +115,7 @@
 #define ADP_CHAN_FORMAT_24CH                        (0x00008000)
 
 /******************************************************************************/
-/* 1722.1 ACMP Offsets */
-#define ACMP_CD_OFFSET                      0
-#define ACMP_VERSION_OFFSET                 1
-#define ACMP_STATUS_FIELD_OFFSET            2
-#define ACMP_CD_LENGTH_OFFSET               3
-#define ACMP_STREAM_ID_OFFSET               4
-#define ACMP_CONTROLLER_GUID_OFFSET         12
-#define ACMP_TALKER_GUID_OFFSET             20
-#define ACMP_LISTENER_GUID_OFFSET           28
-#define ACMP_TALKER_UNIQUE_ID_OFFSET        36
-#define ACMP_LISTENER_UNIQUE_ID_OFFSET      38
-#define ACMP_DEST_MAC_OFFSET                40
-#define ACMP_CONNECTION_COUNT_OFFSET        46
-#define ACMP_SEQUENCE_ID_OFFSET             48
-#define ACMP_FLAGS_OFFSET                   50
-#define ACMP_DEFAULT_FORMAT_OFFSET          52
-
-/* Bit Field Masks */
-
-#define ACMP_MSG_TYPE_MASK                  0x0f
-#define ACMP_STATUS_FIELD_MASK              0xf8
-#define ACMP_CD_LENGTH_MASK                 0x07ff
-
-/* message_type */
+/* ACMP message_type */
 
 #define ACMP_CONNECT_TX_COMMAND             0
 #define ACMP_CONNECT_TX_RESPONSE            1
@@ -199,6 +158,165 @@
 #define ACMP_FLAG_SAVED_STATE_BITMASK           0x0004
 #define ACMP_FLAG_STREAMING_WAIT_BITMASK        0x0008
 
+/******************************************************************************/
+/* 1722.1 AECP Offsets */
+#define AECP_CD_OFFSET                      0
+#define AECP_VERSION_OFFSET                 1
+#define AECP_STATUS_FIELD_OFFSET            2
+#define AECP_CD_LENGTH_OFFSET               2
+#define AECP_TARGET_GUID_OFFSET             4
+#define AECP_CONTROLLER_GUID_OFFSET         12
+#define AECP_SEQUENCE_ID_OFFSET             20
+#define AECP_COMMAND_TYPE_OFFSET            22
+#define AECP_PAYLOAD_OFFSET                 24
+
+/* Bit Field Masks */
+
+#define AECP_MSG_TYPE_MASK                  0x0f
+#define AECP_STATUS_FIELD_MASK              0xf8
+#define AECP_CD_LENGTH_MASK                 0x07ff
+#define AECP_UNSOLICITED_MASK               0x8000
+#define AECP_COMMAND_TYPE_MASK              0x7fff
+
+/* message_type */
+
+#define AECP_AEM_COMMAND                    0
+#define AECP_AEM_RESPONSE                   1
+#define AECP_ADDRESS_ACCESS_COMMAND         2
+#define AECP_ADDRESS_ACCESS_RESPONSE        3
+#define AECP_AVC_COMMAND                    4
+#define AECP_AVC_RESPONSE                   5
+#define AECP_VENDOR_UNIQUE_COMMAND          6
+#define AECP_VENDOR_UNIQUE_RESPONSE         7
+#define AECP_EXTENDED_COMMAND               14
+#define AECP_EXTENDED_RESPONSE              15
+
+/* AEM status */
+
+#define AEM_STATUS_SUCCESS                  0
+#define AEM_STATUS_NOT_IMPLEMENTED          1
+#define AEM_STATUS_NO_SUCH_DESCRIPTOR       2
+#define AEM_STATUS_ENTITY_LOCKED            3
+#define AEM_STATUS_ENTITY_ACQUIRED          4
+#define AEM_STATUS_NOT_AUTHENTICATED        5
+#define AEM_STATUS_AUTHENTICATION_DISABLED  6
+#define AEM_STATUS_BAD_ARGUMENTS            7
+#define AEM_STATUS_NO_RESOURCES             8
+#define AEM_STATUS_IN_PROGRESS              9
+#define AEM_STATUS_ENTITY_MISBEHAVING       10
+#define AEM_STATUS_NOT_SUPPORTED            11
+#define AEM_STATUS_STREAM_IS_RUNNING        12
+
+/* AEM command_type */
+
+#define AEM_ACQUIRE_ENTITY                  0x0000
+#define AEM_LOCK_ENTITY                     0x0001
+#define AEM_ENTITY_AVAILABLE                0x0002
+#define AEM_CONTROLLER_AVAILABLE            0x0003
+#define AEM_READ_DESCRIPTOR                 0x0004
+#define AEM_WRITE_DESCRIPTOR                0x0005
+#define AEM_SET_CONFIGURATION               0x0006
+#define AEM_GET_CONFIGURATION               0x0007
+#define AEM_SET_STREAM_FORMAT               0x0008
+#define AEM_GET_STREAM_FORMAT               0x0009
+#define AEM_SET_VIDEO_FORMAT                0x000a
+#define AEM_GET_VIDEO_FORMAT                0x000b
+#define AEM_SET_SENSOR_FORMAT               0x000c
+#define AEM_GET_SENSOR_FORMAT               0x000d
+#define AEM_SET_STREAM_INFO                 0x000e
+#define AEM_GET_STREAM_INFO                 0x000f
+#define AEM_SET_NAME                        0x0010
+#define AEM_GET_NAME                        0x0011
+#define AEM_SET_ASSOCIATION_ID              0x0012
+#define AEM_GET_ASSOCIATION_ID              0x0013
+#define AEM_SET_SAMPLING_RATE               0x0014
+#define AEM_GET_SAMPLING_RATE               0x0015
+#define AEM_SET_CLOCK_SOURCE                0x0016
+#define AEM_GET_CLOCK_SOURCE                0x0017
+#define AEM_SET_CONTROL                     0x0018
+#define AEM_GET_CONTROL                     0x0019
+#define AEM_START_STREAMING                 0x0022
+#define AEM_STOP_STREAMING                  0x0023
+#define AEM_REGISTER_UNSOLICITED_NOTIFICATION   0x0024
+#define AEM_DEREGISTER_UNSOLICITED_NOTIFICATION 0x0025
+#define AEM_IDENTIFY_NOTIFICATION           0x0026
+#define AEM_GET_AVB_INFO                    0x0027
+#define AEM_GET_AS_PATH                     0x0028
+#define AEM_GET_COUNTERS                    0x0029
+#define AEM_REBOOT                          0x002a
+#define AEM_GET_AUDIO_MAP                   0x002b
+#define AEM_ADD_AUDIO_MAPPINGS              0x002c
+#define AEM_REMOVE_AUDIO_MAPPINGS           0x002d
+
+/* AEM descriptor_type */
+
+#define AEM_DESC_ENTITY                     0x0000
+#define AEM_DESC_CONFIGURATION              0x0001
+#define AEM_DESC_AUDIO_UNIT                 0x0002
+#define AEM_DESC_VIDEO_UNIT                 0x0003
+#define AEM_DESC_SENSOR_UNIT                0x0004
+#define AEM_DESC_STREAM_INPUT               0x0005
+#define AEM_DESC_STREAM_OUTPUT              0x0006
+#define AEM_DESC_JACK_INPUT                 0x0007
+#define AEM_DESC_JACK_OUTPUT                0x0008
+#define AEM_DESC_AVB_INTERFACE              0x0009
+#define AEM_DESC_CLOCK_SOURCE               0x000a
+#define AEM_DESC_MEMORY_OBJECT              0x000b
+#define AEM_DESC_LOCALE                     0x000c
+#define AEM_DESC_STRINGS                    0x000d
+#define AEM_DESC_STREAM_PORT_INPUT          0x000e
+#define AEM_DESC_STREAM_PORT_OUTPUT         0x000f
+#define AEM_DESC_EXTERNAL_PORT_INPUT        0x0010
+#define AEM_DESC_EXTERNAL_PORT_OUTPUT       0x0011
+#define AEM_DESC_INTERNAL_PORT_INPUT        0x0012
+#define AEM_DESC_INTERNAL_PORT_OUTPUT       0x0013
+#define AEM_DESC_AUDIO_CLUSTER              0x0014
+#define AEM_DESC_VIDEO_CLUSTER              0x0015
+#define AEM_DESC_SENSOR_CLUSTER             0x0016
+#define AEM_DESC_AUDIO_MAP                  0x0017
+#define AEM_DESC_VIDEO_MAP                  0x0018
+#define AEM_DESC_SENSOR_MAP                 0x0019
+#define AEM_DESC_CONTROL                    0x001a
+#define AEM_DESC_SIGNAL_SELECTOR            0x001b
+#define AEM_DESC_MIXER                      0x001c
+#define AEM_DESC_MATRIX                     0x001d
+#define AEM_DESC_MATRIX_SIGNAL              0x001e
+#define AEM_DESC_SIGNAL_SPLITTER            0x001f
+#define AEM_DESC_SIGNAL_COMBINER            0x0020
+#define AEM_DESC_SIGNAL_DEMULTIPLEXER       0x0021
+#define AEM_DESC_SIGNAL_MULTIPLEXER         0x0022
+#define AEM_DESC_SIGNAL_TRANSCODER          0x0023
+#define AEM_DESC_CLOCK_DOMAIN               0x0024
+#define AEM_DESC_CONTROL_BLOCK              0x0025
+
+/* AEM command payload offsets */
+#define AEM_DESCRIPTOR_TYPE_OFFSET          24
+#define AEM_DESCRIPTOR_INDEX_OFFSET         26
+#define AEM_ACQUIRE_FLAGS_OFFSET            24
+#define AEM_ACQUIRE_OWNER_GUID_OFFSET       28
+#define AEM_ACQUIRE_DESC_TYPE_OFFSET        36
+#define AEM_ACQUIRE_DESC_INDEX_OFFSET       38
+#define AEM_READ_CONFIGURATION_OFFSET       24
+#define AEM_READ_DESC_TYPE_OFFSET           28
+#define AEM_READ_DESC_INDEX_OFFSET          30
+#define AEM_READ_DESCRIPTOR_OFFSET          28
+#define AEM_CONFIGURATION_INDEX_OFFSET      26
+#define AEM_STREAM_FORMAT_OFFSET            28
+#define AEM_NAME_INDEX_OFFSET               28
+#define AEM_NAME_CONFIGURATION_OFFSET       30
+#define AEM_NAME_OFFSET                     32
+#define AEM_SAMPLING_RATE_OFFSET            28
+#define AEM_CLOCK_SOURCE_INDEX_OFFSET       28
+#define AEM_COUNTERS_VALID_OFFSET           28
+#define AEM_COUNTERS_BLOCK_OFFSET           32
+
+/* Offsets of object_name within a descriptor */
+#define AEM_ENTITY_NAME_OFFSET              52
+#define AEM_OBJECT_NAME_OFFSET              4
+#define AEM_NAME_LENGTH                     64
+
+#define AEM_COUNTERS_BLOCK_LENGTH           128
+
 
 static const value_string adp_message_type_vals[] = {
     {ADP_ENTITY_AVAILABLE_MESSAGE,       "ENTITY_AVAILABLE"},
@@ -246,6 +364,121 @@ static const value_string acmp_status_field_vals[] = {
     {0,                                  NULL }
 };
 
+static const value_string aecp_message_type_vals[] = {
+    {AECP_AEM_COMMAND,                  "AEM_COMMAND"},
+    {AECP_AEM_RESPONSE,                 "AEM_RESPONSE"},
+    {AECP_ADDRESS_ACCESS_COMMAND,       "ADDRESS_ACCESS_COMMAND"},
+    {AECP_ADDRESS_ACCESS_RESPONSE,      "ADDRESS_ACCESS_RESPONSE"},
+    {AECP_AVC_COMMAND,                  "AVC_COMMAND"},
+    {AECP_AVC_RESPONSE,                 "AVC_RESPONSE"},
+    {AECP_VENDOR_UNIQUE_COMMAND,        "VENDOR_UNIQUE_COMMAND"},
+    {AECP_VENDOR_UNIQUE_RESPONSE,       "VENDOR_UNIQUE_RESPONSE"},
+    {AECP_EXTENDED_COMMAND,             "EXTENDED_COMMAND"},
+    {AECP_EXTENDED_RESPONSE,            "EXTENDED_RESPONSE"},
+    {0,                                  NULL }
+};
+
+static const value_string aem_status_vals[] = {
+    {AEM_STATUS_SUCCESS,                "SUCCESS"},
+    {AEM_STATUS_NOT_IMPLEMENTED,        "NOT_IMPLEMENTED"},
+    {AEM_STATUS_NO_SUCH_DESCRIPTOR,     "NO_SUCH_DESCRIPTOR"},
+    {AEM_STATUS_ENTITY_LOCKED,          "ENTITY_LOCKED"},
+    {AEM_STATUS_ENTITY_ACQUIRED,        "ENTITY_ACQUIRED"},
+    {AEM_STATUS_NOT_AUTHENTICATED,      "NOT_AUTHENTICATED"},
+    {AEM_STATUS_AUTHENTICATION_DISABLED, "AUTHENTICATION_DISABLED"},
+    {AEM_STATUS_BAD_ARGUMENTS,          "BAD_ARGUMENTS"},
+    {AEM_STATUS_NO_RESOURCES,           "NO_RESOURCES"},
+    {AEM_STATUS_IN_PROGRESS,            "IN_PROGRESS"},
+    {AEM_STATUS_ENTITY_MISBEHAVING,     "ENTITY_MISBEHAVING"},
+    {AEM_STATUS_NOT_SUPPORTED,          "NOT_SUPPORTED"},
+    {AEM_STATUS_STREAM_IS_RUNNING,      "STREAM_IS_RUNNING"},
+    {0,                                  NULL }
+};
+
+static const value_string aem_command_type_vals[] = {
+    {AEM_ACQUIRE_ENTITY,                "ACQUIRE_ENTITY"},
+    {AEM_LOCK_ENTITY,                   "LOCK_ENTITY"},
+    {AEM_ENTITY_AVAILABLE,              "ENTITY_AVAILABLE"},
+    {AEM_CONTROLLER_AVAILABLE,          "CONTROLLER_AVAILABLE"},
+    {AEM_READ_DESCRIPTOR,               "READ_DESCRIPTOR"},
+    {AEM_WRITE_DESCRIPTOR,              "WRITE_DESCRIPTOR"},
+    {AEM_SET_CONFIGURATION,             "SET_CONFIGURATION"},
+    {AEM_GET_CONFIGURATION,             "GET_CONFIGURATION"},
+    {AEM_SET_STREAM_FORMAT,             "SET_STREAM_FORMAT"},
+    {AEM_GET_STREAM_FORMAT,             "GET_STREAM_FORMAT"},
+    {AEM_SET_VIDEO_FORMAT,              "SET_VIDEO_FORMAT"},
+    {AEM_GET_VIDEO_FORMAT,              "GET_VIDEO_FORMAT"},
+    {AEM_SET_SENSOR_FORMAT,             "SET_SENSOR_FORMAT"},
+    {AEM_GET_SENSOR_FORMAT,             "GET_SENSOR_FORMAT"},
+    {AEM_SET_STREAM_INFO,               "SET_STREAM_INFO"},
+    {AEM_GET_STREAM_INFO,               "GET_STREAM_INFO"},
+    {AEM_SET_NAME,                      "SET_NAME"},
+    {AEM_GET_NAME,                      "GET_NAME"},
+    {AEM_SET_ASSOCIATION_ID,            "SET_ASSOCIATION_ID"},
+    {AEM_GET_ASSOCIATION_ID,            "GET_ASSOCIATION_ID"},
+    {AEM_SET_SAMPLING_RATE,             "SET_SAMPLING_RATE"},
+    {AEM_GET_SAMPLING_RATE,             "GET_SAMPLING_RATE"},
+    {AEM_SET_CLOCK_SOURCE,              "SET_CLOCK_SOURCE"},
+    {AEM_GET_CLOCK_SOURCE,              "GET_CLOCK_SOURCE"},
+    {AEM_SET_CONTROL,                   "SET_CONTROL"},
+    {AEM_GET_CONTROL,                   "GET_CONTROL"},
+    {AEM_START_STREAMING,               "START_STREAMING"},
+    {AEM_STOP_STREAMING,                "STOP_STREAMING"},
+    {AEM_REGISTER_UNSOLICITED_NOTIFICATION,   "REGISTER_UNSOLICITED_NOTIFICATION"},
+    {AEM_DEREGISTER_UNSOLICITED_NOTIFICATION, "DEREGISTER_UNSOLICITED_NOTIFICATION"},
+    {AEM_IDENTIFY_NOTIFICATION,         "IDENTIFY_NOTIFICATION"},
+    {AEM_GET_AVB_INFO,                  "GET_AVB_INFO"},
+    {AEM_GET_AS_PATH,                   "GET_AS_PATH"},
+    {AEM_GET_COUNTERS,                  "GET_COUNTERS"},
+    {AEM_REBOOT,                        "REBOOT"},
+    {AEM_GET_AUDIO_MAP,                 "GET_AUDIO_MAP"},
+    {AEM_ADD_AUDIO_MAPPINGS,            "ADD_AUDIO_MAPPINGS"},
+    {AEM_REMOVE_AUDIO_MAPPINGS,         "REMOVE_AUDIO_MAPPINGS"},
+    {0,                                  NULL }
+};
+
+static const value_string aem_descriptor_type_vals[] = {
+    {AEM_DESC_ENTITY,                   "ENTITY"},
+    {AEM_DESC_CONFIGURATION,            "CONFIGURATION"},
+    {AEM_DESC_AUDIO_UNIT,               "AUDIO_UNIT"},
+    {AEM_DESC_VIDEO_UNIT,               "VIDEO_UNIT"},
+    {AEM_DESC_SENSOR_UNIT,              "SENSOR_UNIT"},
+    {AEM_DESC_STREAM_INPUT,             "STREAM_INPUT"},
+    {AEM_DESC_STREAM_OUTPUT,            "STREAM_OUTPUT"},
+    {AEM_DESC_JACK_INPUT,               "JACK_INPUT"},
+    {AEM_DESC_JACK_OUTPUT,              "JACK_OUTPUT"},
+    {AEM_DESC_AVB_INTERFACE,            "AVB_INTERFACE"},
+    {AEM_DESC_CLOCK_SOURCE,             "CLOCK_SOURCE"},
+    {AEM_DESC_MEMORY_OBJECT,            "MEMORY_OBJECT"},
+    {AEM_DESC_LOCALE,                   "LOCALE"},
+    {AEM_DESC_STRINGS,                  "STRINGS"},
+    {AEM_DESC_STREAM_PORT_INPUT,        "STREAM_PORT_INPUT"},
+    {AEM_DESC_STREAM_PORT_OUTPUT,       "STREAM_PORT_OUTPUT"},
+    {AEM_DESC_EXTERNAL_PORT_INPUT,      "EXTERNAL_PORT_INPUT"},
+    {AEM_DESC_EXTERNAL_PORT_OUTPUT,     "EXTERNAL_PORT_OUTPUT"},
+    {AEM_DESC_INTERNAL_PORT_INPUT,      "INTERNAL_PORT_INPUT"},
+    {AEM_DESC_INTERNAL_PORT_OUTPUT,     "INTERNAL_PORT_OUTPUT"},
+    {AEM_DESC_AUDIO_CLUSTER,            "AUDIO_CLUSTER"},
+    {AEM_DESC_VIDEO_CLUSTER,            "VIDEO_CLUSTER"},
+    {AEM_DESC_SENSOR_CLUSTER,           "SENSOR_CLUSTER"},
+    {AEM_DESC_AUDIO_MAP,                "AUDIO_MAP"},
+    {AEM_DESC_VIDEO_MAP,                "VIDEO_MAP"},
+    {AEM_DESC_SENSOR_MAP,               "SENSOR_MAP"},
+    {AEM_DESC_CONTROL,                  "CONTROL"},
+    {AEM_DESC_SIGNAL_SELECTOR,          "SIGNAL_SELECTOR"},
+    {AEM_DESC_MIXER,                    "MIXER"},
+    {AEM_DESC_MATRIX,                   "MATRIX"},
+    {AEM_DESC_MATRIX_SIGNAL,            "MATRIX_SIGNAL"},
+    {AEM_DESC_SIGNAL_SPLITTER,          "SIGNAL_SPLITTER"},
+    {AEM_DESC_SIGNAL_COMBINER,          "SIGNAL_COMBINER"},
+    {AEM_DESC_SIGNAL_DEMULTIPLEXER,     "SIGNAL_DEMULTIPLEXER"},
+    {AEM_DESC_SIGNAL_MULTIPLEXER,       "SIGNAL_MULTIPLEXER"},
+    {AEM_DESC_SIGNAL_TRANSCODER,        "SIGNAL_TRANSCODER"},
+    {AEM_DESC_CLOCK_DOMAIN,             "CLOCK_DOMAIN"},
+    {AEM_DESC_CONTROL_BLOCK,            "CONTROL_BLOCK"},
+    {0,                                  NULL }
+};
+
 /**********************************************************/
 /* Initialize the protocol and registered fields          */
 /**********************************************************/
@@ -337,6 +570,15 @@ static int hf_adp_chan_format_20ch = -1;
 static int hf_adp_chan_format_22ch = -1;
 static int hf_adp_chan_format_24ch = -1;
 
+/* ADP entity analysis */
+static int hf_adp_analysis_new_entity = -1;
+static int hf_adp_analysis_previous_index = -1;
+static int hf_adp_analysis_reboot = -1;
+static int hf_adp_analysis_guid_collision = -1;
+static int hf_adp_analysis_caps_changed = -1;
+static int hf_adp_analysis_reappeared = -1;
+static int hf_adp_analysis_expired_guid = -1;
+
 /******************************************************************* */
 /* AVDECC Connection Management Protocol Data Unit (ACMPDU) */
 static int hf_acmp_message_type = -1;
@@ -359,9 +601,47 @@ static int hf_acmp_flags_class_b = -1;
 static int hf_acmp_flags_fast_connect = -1;
 static int hf_acmp_flags_saved_state = -1;
 static int hf_acmp_flags_streaming_wait = -1;
+static int hf_acmp_response_in = -1;
+static int hf_acmp_response_to = -1;
+static int hf_acmp_response_time = -1;
+static int hf_acmp_retransmission_of = -1;
+static int hf_acmp_duplicate_of = -1;
+static int hf_acmp_no_response = -1;
+static int hf_acmp_no_command = -1;
+static int hf_acmp_late_response = -1;
+
+/******************************************************************* */
+/* AVDECC Enumeration and Control Protocol Data Unit (AECPDU) */
+static int hf_aecp_message_type = -1;
+static int hf_aecp_status_field = -1;
+static int hf_aecp_cd_length = -1;
+static int hf_aecp_target_guid = -1;
+static int hf_aecp_controller_guid = -1;
+static int hf_aecp_sequence_id = -1;
+static int hf_aecp_unsolicited = -1;
+static int hf_aecp_command_type = -1;
+static int hf_aecp_payload = -1;
+
+/* AEM command payloads */
+static int hf_aem_descriptor_type = -1;
+static int hf_aem_descriptor_index = -1;
+static int hf_aem_acquire_flags = -1;
+static int hf_aem_owner_guid = -1;
+static int hf_aem_configuration_index = -1;
+static int hf_aem_stream_format = -1;
+static int hf_aem_name_index = -1;
+static int hf_aem_name = -1;
+static int hf_aem_sampling_rate = -1;
+static int hf_aem_clock_source_index = -1;
+static int hf_aem_counters_valid = -1;
+static int hf_aem_counters_block = -1;
+static int hf_aem_entity_name = -1;
+static int hf_aem_object_name = -1;
+static int hf_aem_descriptor_data = -1;
 
 /* Initialize the subtree pointers */
 /* ADP */
+static int ett_adp = -1;
 static int ett_adp_ent_cap = -1;
 static int ett_adp_talk_cap = -1;
 static int ett_adp_list_cap = -1;
@@ -369,271 +649,1281 @@ static int ett_adp_cont_cap = -1;
 static int ett_adp_aud_format = -1;
 static int ett_adp_samp_rates = -1;
 static int ett_adp_chan_format = -1;
+static int ett_adp_analysis = -1;
+static int ett_adp_expiry = -1;
 /* ACMP */
+static int ett_acmp = -1;
 static int ett_acmp_flags = -1;
+/* AECP */
+static int ett_aecp = -1;
+static int ett_aem_descriptor = -1;
+
+/* Flag groups rendered with proto_tree_add_bitmask(); the parent item
+ * lists the flags that are set */
+static const int *adp_entity_cap_fields[] = {
+    &hf_adp_entity_cap_avdecc_ip,
+    &hf_adp_entity_cap_zero_conf,
+    &hf_adp_entity_cap_gateway_entity,
+    &hf_adp_entity_cap_avdecc_control,
+    &hf_adp_entity_cap_legacy_avc,
+    &hf_adp_entity_cap_assoc_id_support,
+    &hf_adp_entity_cap_assoc_id_valid,
+    NULL
+};
+
+static const int *adp_talker_cap_fields[] = {
+    &hf_adp_talk_cap_implement,
+    &hf_adp_talk_cap_other_src,
+    &hf_adp_talk_cap_control_src,
+    &hf_adp_talk_cap_media_clk_src,
+    &hf_adp_talk_cap_smpte_src,
+    &hf_adp_talk_cap_midi_src,
+    &hf_adp_talk_cap_audio_src,
+    &hf_adp_talk_cap_video_src,
+    NULL
+};
+
+static const int *adp_listener_cap_fields[] = {
+    &hf_adp_list_cap_implement,
+    &hf_adp_list_cap_other_sink,
+    &hf_adp_list_cap_control_sink,
+    &hf_adp_list_cap_media_clk_sink,
+    &hf_adp_list_cap_smpte_sink,
+    &hf_adp_list_cap_midi_sink,
+    &hf_adp_list_cap_audio_sink,
+    &hf_adp_list_cap_video_sink,
+    NULL
+};
+
+static const int *adp_controller_cap_fields[] = {
+    &hf_adp_cont_cap_implement,
+    &hf_adp_cont_cap_layer3_proxy,
+    NULL
+};
+
+static const int *adp_sample_rate_fields[] = {
+    &hf_adp_samp_rate_44k1,
+    &hf_adp_samp_rate_48k,
+    &hf_adp_samp_rate_88k2,
+    &hf_adp_samp_rate_96k,
+    &hf_adp_samp_rate_176k4,
+    &hf_adp_samp_rate_192k,
+    NULL
+};
+
+static const int *adp_channel_format_fields[] = {
+    &hf_adp_chan_format_mono,
+    &hf_adp_chan_format_2ch,
+    &hf_adp_chan_format_3ch,
+    &hf_adp_chan_format_4ch,
+    &hf_adp_chan_format_5ch,
+    &hf_adp_chan_format_6ch,
+    &hf_adp_chan_format_7ch,
+    &hf_adp_chan_format_8ch,
+    &hf_adp_chan_format_10ch,
+    &hf_adp_chan_format_12ch,
+    &hf_adp_chan_format_14ch,
+    &hf_adp_chan_format_16ch,
+    &hf_adp_chan_format_18ch,
+    &hf_adp_chan_format_20ch,
+    &hf_adp_chan_format_22ch,
+    &hf_adp_chan_format_24ch,
+    NULL
+};
+
+static const int *acmp_flags_fields[] = {
+    &hf_acmp_flags_class_b,
+    &hf_acmp_flags_fast_connect,
+    &hf_acmp_flags_saved_state,
+    &hf_acmp_flags_streaming_wait,
+    NULL
+};
+
+static int adp_tap = -1;
+static int acmp_tap = -1;
+
+/* ADP entity inventory.
+ *
+ * One record per entity GUID, updated on the first pass by every
+ * ENTITY_AVAILABLE and ENTITY_DEPARTING, so reboots (available_index going
+ * backwards without a DEPARTING in between), GUID collisions (the same GUID
+ * from another source MAC, or with another vendor/model when the MAC is not
+ * known) and capability changes are found with one hash lookup per frame.
+ * Announcements from a colliding station do not update the record, so the
+ * original owner is not flagged in turn.  Only frames with a finding get
+ * per-frame data.
+ *
+ * Each announced entity also sits on a hashed timer wheel of capture time,
+ * in the slot of the tick at which its valid_time runs out.  Every AVTPDU,
+ * stream data included, advances the wheel over the ticks since the
+ * previous one and expires what it finds there, so an entity that neither re-announces nor
+ * departs is caught as silently departed without scanning the table.  The
+ * wheel spans more than the largest valid_time (62 s), so each slot holds
+ * only entities due on the current turn.  An entity evicted from the state
+ * table leaves the wheel with it and is new again if it is announced later.
+ */
+#define ADP_WHEEL_SLOTS         256
+#define ADP_WHEEL_TICK_NS       G_GINT64_CONSTANT(250000000)
+
+typedef struct _adp_entity {
+    guint64 entity_guid;
+    guint8  mac[6];
+    gboolean has_mac;
+    gboolean departed;
+    gboolean timed_out;         /* departed without ENTITY_DEPARTING */
+    guint8  valid_time;
+    guint32 last_frame;
+    /* Timer wheel linkage, wheel_pprev is NULL when not armed */
+    struct _adp_entity *wheel_next;
+    struct _adp_entity **wheel_pprev;
+    gint64  expire_tick;
+    guint32 vendor_id;
+    guint32 model_id;
+    guint32 entity_cap;
+    guint16 talker_cap;
+    guint16 listener_cap;
+    guint32 controller_cap;
+    guint32 available_index;
+} adp_entity_t;
+
+/* An entity found expired while dissecting a frame */
+typedef struct _adp_expiry {
+    struct _adp_expiry *next;
+    guint64 entity_guid;
+    guint32 last_frame;
+    guint8  valid_time;
+} adp_expiry_t;
+
+typedef struct _ieee17221_frame_info {
+    guint8  analysis;           /* IEEE17221_ADP_xxx */
+    guint32 previous_index;
+    adp_expiry_t *expired;
+    gboolean acmp_tracked;      /* the ACMP fields below are set */
+    guint8  acmp_analysis;      /* IEEE17221_ACMP_xxx */
+    guint32 acmp_command_frame;     /* responses: the command answered */
+    guint32 acmp_response_frame;    /* commands: the answer; duplicates: the first one */
+    guint32 acmp_retransmission_of; /* commands: earlier unanswered command, or 0 */
+    nstime_t acmp_response_time;    /* responses to a command in the capture */
+} ieee17221_frame_info_t;
+
+static ieee1722_state_table_t *adp_entities = NULL;
+
+static adp_entity_t *adp_wheel[ADP_WHEEL_SLOTS];
+static gint64 adp_wheel_tick;
+static gboolean adp_wheel_started;
+
+static ieee17221_frame_info_t *ieee17221_frame_info(packet_info *pinfo)
+{
+    ieee17221_frame_info_t *finfo = p_get_proto_data(pinfo->fd, proto_17221);
+
+    if (finfo == NULL) {
+        finfo = se_alloc0(sizeof(ieee17221_frame_info_t));
+        p_add_proto_data(pinfo->fd, proto_17221, finfo);
+    }
+    return finfo;
+}
+
+static void adp_wheel_remove(adp_entity_t *entity)
+{
+    if (entity->wheel_pprev == NULL)
+        return;
+    *entity->wheel_pprev = entity->wheel_next;
+    if (entity->wheel_next)
+        entity->wheel_next->wheel_pprev = entity->wheel_pprev;
+    entity->wheel_next = NULL;
+    entity->wheel_pprev = NULL;
+}
+
+/* Take an entity off the wheel before it is evicted */
+static void adp_entity_free(gpointer data)
+{
+    adp_wheel_remove(data);
+}
+
+/* Take every entity off the wheel before the table goes */
+static void adp_wheel_clear(void)
+{
+    guint i;
+
+    for (i = 0; i < ADP_WHEEL_SLOTS; i++) {
+        while (adp_wheel[i])
+            adp_wheel_remove(adp_wheel[i]);
+    }
+    adp_wheel_started = FALSE;
+}
+
+/* (Re)start the validity timer; the entity expires on the first tick
+ * that starts after valid_time has passed, never early.
+ */
+static void adp_wheel_arm(adp_entity_t *entity, gint64 now_ns)
+{
+    adp_entity_t **slot;
+
+    adp_wheel_remove(entity);
+    if (entity->valid_time == 0)
+        return;
+
+    entity->expire_tick = (now_ns + entity->valid_time * G_GINT64_CONSTANT(2000000000)) /
+                          ADP_WHEEL_TICK_NS + 1;
+    slot = &adp_wheel[entity->expire_tick & (ADP_WHEEL_SLOTS - 1)];
+    entity->wheel_next = *slot;
+    if (*slot)
+        (*slot)->wheel_pprev = &entity->wheel_next;
+    entity->wheel_pprev = slot;
+    *slot = entity;
+}
+
+/* First pass: expire every entity due up to the capture time of this frame */
+void ieee17221_adp_advance(packet_info *pinfo)
+{
+    gint64 now_tick;
+    gint64 tick;
+    gint64 last;
+
+    now_tick = ((gint64)pinfo->fd->abs_ts.secs * 1000000000 + pinfo->fd->abs_ts.nsecs) /
+               ADP_WHEEL_TICK_NS;
+    if (!adp_wheel_started) {
+        adp_wheel_started = TRUE;
+        adp_wheel_tick = now_tick;
+        return;
+    }
+    if (now_tick <= adp_wheel_tick)
+        return;
 
-static int ett_1722 = -1;
+    /* After a long gap one turn of the wheel covers everything */
+    last = MIN(now_tick, adp_wheel_tick + ADP_WHEEL_SLOTS);
+    for (tick = adp_wheel_tick + 1; tick <= last; tick++) {
+        adp_entity_t *entity = adp_wheel[tick & (ADP_WHEEL_SLOTS - 1)];
 
-static const value_string avb_bool_vals[] = {
-    {1, "True"},
-    {0, "False"},
-    {0,              NULL          }};
+        while (entity) {
+            adp_entity_t *next = entity->wheel_next;
+
+            if (entity->expire_tick <= now_tick) {
+                ieee17221_frame_info_t *finfo = ieee17221_frame_info(pinfo);
+                adp_expiry_t *expiry = se_alloc(sizeof(adp_expiry_t));
+
+                expiry->entity_guid = entity->entity_guid;
+                expiry->last_frame = entity->last_frame;
+                expiry->valid_time = entity->valid_time;
+                expiry->next = finfo->expired;
+                finfo->expired = expiry;
+
+                adp_wheel_remove(entity);
+                entity->departed = TRUE;
+                entity->timed_out = TRUE;
+            }
+            entity = next;
+        }
+    }
+    adp_wheel_tick = now_tick;
+}
+
+static void adp_track_entity(const ieee17221_adp_pdu_t *pdu, packet_info *pinfo)
+{
+    adp_entity_t *entity;
+    ieee17221_frame_info_t frame;
+    ieee17221_frame_info_t *finfo;
+    gboolean has_mac;
+
+    if (pdu->message_type != ADP_ENTITY_AVAILABLE_MESSAGE &&
+        pdu->message_type != ADP_ENTITY_DEPARTING_MESSAGE)
+        return;
+
+    memset(&frame, 0, sizeof(frame));
+    has_mac = pinfo->dl_src.type == AT_ETHER;
+
+    entity = ieee1722_state_lookup(adp_entities, &pdu->entity_guid);
+    if (entity == NULL) {
+        entity = ieee1722_state_insert(adp_entities, &pdu->entity_guid);
+        frame.analysis = IEEE17221_ADP_NEW_ENTITY;
+    }
+    else if (entity->has_mac && has_mac ?
+                 memcmp(entity->mac, pinfo->dl_src.data, 6) != 0 :
+                 (entity->vendor_id != pdu->vendor_id || entity->model_id != pdu->model_id)) {
+        frame.analysis = IEEE17221_ADP_GUID_COLLISION;
+    }
+    else if (pdu->message_type == ADP_ENTITY_AVAILABLE_MESSAGE && entity->timed_out) {
+        frame.analysis = IEEE17221_ADP_REAPPEARED;
+    }
+    else if (pdu->message_type == ADP_ENTITY_AVAILABLE_MESSAGE && !entity->departed) {
+        /* After a DEPARTING the entity may come back with anything */
+        gint32 delta = (gint32)(pdu->available_index - entity->available_index);
+
+        if (delta < 0) {
+            frame.analysis |= IEEE17221_ADP_REBOOT;
+            frame.previous_index = entity->available_index;
+        }
+        else if (delta == 0) {
+            /* The same announcement again, e.g. seen on two ports */
+        }
+        else if (entity->entity_cap != pdu->entity_cap || entity->talker_cap != pdu->talker_cap ||
+                 entity->listener_cap != pdu->listener_cap ||
+                 entity->controller_cap != pdu->controller_cap) {
+            frame.analysis |= IEEE17221_ADP_CAPS_CHANGED;
+        }
+    }
+
+    if (!(frame.analysis & IEEE17221_ADP_GUID_COLLISION)) {
+        if (has_mac) {
+            memcpy(entity->mac, pinfo->dl_src.data, 6);
+            entity->has_mac = TRUE;
+        }
+        entity->vendor_id = pdu->vendor_id;
+        entity->model_id = pdu->model_id;
+        entity->departed = pdu->message_type == ADP_ENTITY_DEPARTING_MESSAGE;
+        entity->timed_out = FALSE;
+        entity->last_frame = pinfo->fd->num;
+        if (pdu->message_type == ADP_ENTITY_AVAILABLE_MESSAGE) {
+            entity->entity_cap = pdu->entity_cap;
+            entity->talker_cap = pdu->talker_cap;
+            entity->listener_cap = pdu->listener_cap;
+            entity->controller_cap = pdu->controller_cap;
+            entity->available_index = pdu->available_index;
+            entity->valid_time = pdu->valid_time;
+            adp_wheel_arm(entity, (gint64)pinfo->fd->abs_ts.secs * 1000000000 + pinfo->fd->abs_ts.nsecs);
+        }
+        else {
+            adp_wheel_remove(entity);
+        }
+    }
+
+    if (frame.analysis == 0)
+        return;
+
+    finfo = ieee17221_frame_info(pinfo);
+    finfo->analysis = frame.analysis;
+    finfo->previous_index = frame.previous_index;
+}
+
+static void adp_add_analysis(tvbuff_t *tvb, packet_info *pinfo, proto_tree *adp_tree,
+                             const ieee17221_adp_pdu_t *pdu, ieee17221_frame_info_t *finfo)
+{
+    proto_item *ti = NULL;
+    proto_tree *analysis_tree = NULL;
+
+    ti = proto_tree_add_text(adp_tree, tvb, 0, 0, "[Entity analysis]");
+    PROTO_ITEM_SET_GENERATED(ti);
+    analysis_tree = proto_item_add_subtree(ti, ett_adp_analysis);
+
+    if (finfo->analysis & IEEE17221_ADP_NEW_ENTITY) {
+        ti = proto_tree_add_boolean(analysis_tree, hf_adp_analysis_new_entity, tvb,
+                                    ADP_ENTITY_GUID_OFFSET, 8, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+    }
+    if (finfo->analysis & IEEE17221_ADP_REBOOT) {
+        ti = proto_tree_add_uint(analysis_tree, hf_adp_analysis_previous_index, tvb,
+                                 ADP_AVAIL_INDEX_OFFSET, 4, finfo->previous_index);
+        PROTO_ITEM_SET_GENERATED(ti);
+        ti = proto_tree_add_boolean(analysis_tree, hf_adp_analysis_reboot, tvb,
+                                    ADP_AVAIL_INDEX_OFFSET, 4, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_NOTE,
+                               "Entity rebooted: available_index went back from %u to %u",
+                               finfo->previous_index, pdu->available_index);
+    }
+    if (finfo->analysis & IEEE17221_ADP_GUID_COLLISION) {
+        ti = proto_tree_add_boolean(analysis_tree, hf_adp_analysis_guid_collision, tvb,
+                                    ADP_ENTITY_GUID_OFFSET, 8, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_PROTOCOL, PI_WARN,
+                               "Entity GUID is also announced by another station");
+    }
+    if (finfo->analysis & IEEE17221_ADP_REAPPEARED) {
+        ti = proto_tree_add_boolean(analysis_tree, hf_adp_analysis_reappeared, tvb,
+                                    ADP_ENTITY_GUID_OFFSET, 8, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_NOTE,
+                               "Entity announced again after its valid_time ran out");
+    }
+    if (finfo->analysis & IEEE17221_ADP_CAPS_CHANGED) {
+        ti = proto_tree_add_boolean(analysis_tree, hf_adp_analysis_caps_changed, tvb,
+                                    ADP_ENTITY_CAP_OFFSET, 4, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_PROTOCOL, PI_NOTE,
+                               "Entity capabilities changed without a reboot");
+    }
+}
+
+/* Report the entities whose valid_time ran out by the time of this frame,
+ * in a generated subtree of the AVTPDU's tree */
+void ieee17221_adp_add_expiries(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    ieee17221_frame_info_t *finfo = p_get_proto_data(pinfo->fd, proto_17221);
+    ieee17221_adp_tap_info_t *info;
+    adp_expiry_t *expiry;
+    proto_item *ti;
+    proto_tree *expiry_tree;
+
+    if (finfo == NULL || finfo->expired == NULL)
+        return;
+    ti = proto_tree_add_text(tree, tvb, 0, 0, "[ADP entity expiry]");
+    PROTO_ITEM_SET_GENERATED(ti);
+    expiry_tree = proto_item_add_subtree(ti, ett_adp_expiry);
+
+    for (expiry = finfo->expired; expiry; expiry = expiry->next) {
+        ti = proto_tree_add_uint64(expiry_tree, hf_adp_analysis_expired_guid, tvb, 0, 0, expiry->entity_guid);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                               "Entity 0x%016" G_GINT64_MODIFIER "x silently departed: "
+                               "not announced within %u s of frame %u",
+                               expiry->entity_guid, expiry->valid_time * 2, expiry->last_frame);
+
+        info = ep_alloc0(sizeof(ieee17221_adp_tap_info_t));
+        info->message_type = IEEE17221_ADP_ENTITY_TIMEOUT;
+        info->valid_time = expiry->valid_time;
+        info->entity_guid = expiry->entity_guid;
+        tap_queue_packet(adp_tap, pinfo, info);
+    }
+}
+
+static void adp_queue_tap(const ieee17221_adp_pdu_t *pdu, packet_info *pinfo,
+                          ieee17221_frame_info_t *finfo)
+{
+    ieee17221_adp_tap_info_t *info;
+
+    info = ep_alloc(sizeof(ieee17221_adp_tap_info_t));
+    info->message_type = pdu->message_type;
+    info->valid_time = pdu->valid_time;
+    info->analysis = finfo ? finfo->analysis : 0;
+    info->entity_guid = pdu->entity_guid;
+    info->vendor_id = pdu->vendor_id;
+    info->model_id = pdu->model_id;
+    info->entity_cap = pdu->entity_cap;
+    info->talker_stream_sources = pdu->talker_stream_sources;
+    info->talker_cap = pdu->talker_cap;
+    info->listener_stream_sinks = pdu->listener_stream_sinks;
+    info->listener_cap = pdu->listener_cap;
+    info->controller_cap = pdu->controller_cap;
+    info->available_index = pdu->available_index;
+    info->previous_index = finfo ? finfo->previous_index : 0;
+    tap_queue_packet(adp_tap, pinfo, info);
+}
     
 static void dissect_17221_adp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 {
-    proto_item *adp_tree = NULL;
-    proto_item *ent_cap_ti = NULL;
-    proto_item *talk_cap_ti = NULL;
-    proto_item *list_cap_ti = NULL;
-    proto_item *cont_cap_ti = NULL;
+    proto_item *ti = NULL;
+    proto_tree *adp_tree = NULL;
     proto_item *aud_format_ti = NULL;
-    proto_item *samp_rates_ti = NULL;
-    proto_item *chan_format_ti = NULL;
-    
-    proto_tree *ent_cap_flags_tree = NULL;
-    proto_tree *talk_cap_flags_tree = NULL;
-    proto_tree *list_cap_flags_tree = NULL;
-    proto_tree *cont_cap_flags_tree = NULL;
     proto_tree *aud_format_tree = NULL;
-    proto_tree *samp_rates_tree = NULL;
-    proto_tree *chan_format_tree = NULL;
+
+    ieee17221_frame_info_t *finfo;
+    ieee17221_adp_pdu_t pdu;
+    const guint8 *raw;
+
+    /* One bounds check for the whole PDU; the tree is built from the struct */
+    raw = tvb_get_ptr(tvb, 0, ADP_PDU_SIZE);
+    ieee17221_decode_adp(raw, ADP_PDU_SIZE, &pdu);
        
-    adp_tree = proto_item_add_subtree(tree, proto_17221);
-    
-    proto_tree_add_item(adp_tree, hf_adp_message_type, tvb, ADP_VERSION_OFFSET, 1, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_valid_time, tvb, ADP_VALID_TIME_OFFSET, 1, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_cd_length, tvb, ADP_CD_LENGTH_OFFSET, 1, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_entity_guid, tvb, ADP_ENTITY_GUID_OFFSET, 8, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_vendor_id, tvb, ADP_VENDOR_ID_OFFSET, 4, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_model_id, tvb, ADP_MODEL_ID_OFFSET, 4, FALSE);
-    
-    /* Subtree for entity_capabilities field */
-    if (tree)
-    {
-        ent_cap_ti = proto_tree_add_item(adp_tree, hf_adp_entity_cap, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);
-        
-        ent_cap_flags_tree = proto_item_add_subtree(ent_cap_ti, ett_adp_ent_cap);
-    
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_avdecc_ip, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);
-                
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_zero_conf, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);
-        
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_gateway_entity, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);  
-
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_avdecc_control, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);         
-
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_legacy_avc, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);
-                
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_assoc_id_support, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);
-                
-        proto_tree_add_item(ent_cap_flags_tree,
-                hf_adp_entity_cap_assoc_id_valid, tvb, ADP_ENTITY_CAP_OFFSET, 4, FALSE);                 
-    }
-    
-    
-    proto_tree_add_item(adp_tree, hf_adp_talker_stream_srcs, tvb, ADP_TALKER_STREAM_SRCS_OFFSET, 2, FALSE);
-    
-    if (tree)
-    {
-        talk_cap_ti = proto_tree_add_item(adp_tree, hf_adp_talker_cap, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        
-        talk_cap_flags_tree = proto_item_add_subtree(talk_cap_ti, ett_adp_talk_cap);
-        
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_implement, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_other_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_control_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_media_clk_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_smpte_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_midi_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_audio_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(talk_cap_flags_tree, 
-                hf_adp_talk_cap_video_src, tvb, ADP_TALKER_CAP_OFFSET, 2, FALSE);
-                
-    }
-    
-    proto_tree_add_item(adp_tree, hf_adp_listener_stream_sinks, 
-            tvb, ADP_LISTENER_STREAM_SINKS_OFFSET, 2, FALSE);
-            
-    if (tree)
-    {
-        list_cap_ti = proto_tree_add_item(adp_tree, hf_adp_listener_cap, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        
-        list_cap_flags_tree = proto_item_add_subtree(list_cap_ti, ett_adp_list_cap);
-        
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_implement, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_other_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_control_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_media_clk_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_smpte_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_midi_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_audio_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-        proto_tree_add_item(list_cap_flags_tree, 
-                hf_adp_list_cap_video_sink, tvb, ADP_LISTENER_CAP_OFFSET, 2, FALSE);
-                
-    }
+    ti = proto_tree_add_item(tree, proto_17221, tvb, 0, ADP_PDU_SIZE, FALSE);
+    adp_tree = proto_item_add_subtree(ti, ett_adp);
+
+    proto_tree_add_uint(adp_tree, hf_adp_message_type, tvb, ADP_VERSION_OFFSET, 1, pdu.message_type);
+    proto_tree_add_uint(adp_tree, hf_adp_valid_time, tvb, ADP_VALID_TIME_OFFSET, 1, raw[ADP_VALID_TIME_OFFSET]);
+    proto_tree_add_uint(adp_tree, hf_adp_cd_length, tvb, ADP_VALID_TIME_OFFSET, 2, pdu.cd_length);
+    proto_tree_add_uint64(adp_tree, hf_adp_entity_guid, tvb, ADP_ENTITY_GUID_OFFSET, 8, pdu.entity_guid);
+    proto_tree_add_uint(adp_tree, hf_adp_vendor_id, tvb, ADP_VENDOR_ID_OFFSET, 4, pdu.vendor_id);
+    proto_tree_add_uint(adp_tree, hf_adp_model_id, tvb, ADP_MODEL_ID_OFFSET, 4, pdu.model_id);
     
-    if (tree)
-    {
-        cont_cap_ti = proto_tree_add_item(adp_tree, hf_adp_controller_cap, tvb, ADP_CONTROLLER_CAP_OFFSET, 4, FALSE);
-        
-        cont_cap_flags_tree = proto_item_add_subtree(cont_cap_ti, ett_adp_cont_cap);
-        
-        proto_tree_add_item(cont_cap_flags_tree, 
-                hf_adp_cont_cap_implement, tvb, ADP_CONTROLLER_CAP_OFFSET, 4, FALSE);
-        proto_tree_add_item(cont_cap_flags_tree, 
-                hf_adp_cont_cap_layer3_proxy, tvb, ADP_CONTROLLER_CAP_OFFSET, 4, FALSE);
-    }
-        
-    proto_tree_add_item(adp_tree, hf_adp_avail_index, tvb, ADP_AVAIL_INDEX_OFFSET, 4, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_as_gm_id, tvb, ADP_AS_GM_ID_OFFSET, 8, FALSE);
+    proto_tree_add_bitmask(adp_tree, tvb, ADP_ENTITY_CAP_OFFSET, hf_adp_entity_cap,
+                           ett_adp_ent_cap, adp_entity_cap_fields, FALSE);
+    proto_tree_add_uint(adp_tree, hf_adp_talker_stream_srcs, tvb, ADP_TALKER_STREAM_SRCS_OFFSET, 2,
+                        pdu.talker_stream_sources);
+    proto_tree_add_bitmask(adp_tree, tvb, ADP_TALKER_CAP_OFFSET, hf_adp_talker_cap,
+                           ett_adp_talk_cap, adp_talker_cap_fields, FALSE);
+    proto_tree_add_uint(adp_tree, hf_adp_listener_stream_sinks, 
+            tvb, ADP_LISTENER_STREAM_SINKS_OFFSET, 2, pdu.listener_stream_sinks);
+    proto_tree_add_bitmask(adp_tree, tvb, ADP_LISTENER_CAP_OFFSET, hf_adp_listener_cap,
+                           ett_adp_list_cap, adp_listener_cap_fields, FALSE);
+    proto_tree_add_bitmask(adp_tree, tvb, ADP_CONTROLLER_CAP_OFFSET, hf_adp_controller_cap,
+                           ett_adp_cont_cap, adp_controller_cap_fields, FALSE);
+    proto_tree_add_uint(adp_tree, hf_adp_avail_index, tvb, ADP_AVAIL_INDEX_OFFSET, 4, pdu.available_index);
+    proto_tree_add_uint64(adp_tree, hf_adp_as_gm_id, tvb, ADP_AS_GM_ID_OFFSET, 8, pdu.as_grandmaster_id);
     
     if (tree)
     {
-    
-        aud_format_ti = proto_tree_add_item(adp_tree, hf_adp_def_aud_format, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 4, FALSE);
-        
+        aud_format_ti = proto_tree_add_uint(adp_tree, hf_adp_def_aud_format, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 4,
+                                            (guint32)pdu.default_audio_format << 16 | pdu.channel_formats);
         aud_format_tree = proto_item_add_subtree(aud_format_ti, ett_adp_aud_format);
-        
-        if (aud_format_tree)
-        {
-            samp_rates_ti = proto_tree_add_item(aud_format_tree, 
-                                hf_adp_def_aud_sample_rates, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-         
-            samp_rates_tree = proto_item_add_subtree(samp_rates_ti, ett_adp_samp_rates);
-            
-            proto_tree_add_item(samp_rates_tree, 
-                hf_adp_samp_rate_44k1, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-            proto_tree_add_item(samp_rates_tree, 
-                hf_adp_samp_rate_48k, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-            proto_tree_add_item(samp_rates_tree, 
-                hf_adp_samp_rate_88k2, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-            proto_tree_add_item(samp_rates_tree, 
-                hf_adp_samp_rate_96k, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-            proto_tree_add_item(samp_rates_tree, 
-                hf_adp_samp_rate_176k4, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-            proto_tree_add_item(samp_rates_tree, 
-                hf_adp_samp_rate_192k, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 1, FALSE);
-            
-        }
+
+        proto_tree_add_bitmask(aud_format_tree, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, hf_adp_def_aud_sample_rates,
+                               ett_adp_samp_rates, adp_sample_rate_fields, FALSE);
         proto_tree_add_item(aud_format_tree, 
                 hf_adp_def_aud_max_chan, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 2, FALSE);
         proto_tree_add_item(aud_format_tree, 
                 hf_adp_def_aud_saf_flag, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 2, FALSE);
         proto_tree_add_item(aud_format_tree, 
                 hf_adp_def_aud_float_flag, tvb, ADP_DEF_AUDIO_FORMAT_OFFSET, 2, FALSE);
-                
-        if (aud_format_tree)
-        {
-            chan_format_ti = proto_tree_add_item(aud_format_tree, 
-                    hf_adp_def_aud_chan_formats, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-                    
-            chan_format_tree = proto_item_add_subtree(chan_format_ti, ett_adp_chan_format);
-            
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_mono, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_2ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_3ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_4ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_5ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_6ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_7ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_8ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_10ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_12ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_14ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_16ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_18ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_20ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_22ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
-            proto_tree_add_item(chan_format_tree, 
-               hf_adp_chan_format_24ch, tvb, ADP_CHAN_FORMAT_OFFSET, 2, FALSE);
+        proto_tree_add_bitmask(aud_format_tree, tvb, ADP_CHAN_FORMAT_OFFSET, hf_adp_def_aud_chan_formats,
+                               ett_adp_chan_format, adp_channel_format_fields, FALSE);
+    }
+    proto_tree_add_uint(adp_tree, hf_adp_def_vid_format, tvb, ADP_DEF_VIDEO_FORMAT_OFFSET, 4,
+                        pdu.default_video_format);
+    proto_tree_add_uint64(adp_tree, hf_adp_assoc_id, tvb, ADP_ASSOC_ID_OFFSET, 8, pdu.association_id);
+    proto_tree_add_uint(adp_tree, hf_adp_entity_type, tvb, ADP_ENTITY_TYPE_OFFSET, 4, pdu.entity_type);
+
+    col_append_fstr(pinfo->cinfo, COL_INFO, ": %s 0x%016" G_GINT64_MODIFIER "x",
+                    val_to_str(pdu.message_type, adp_message_type_vals, "Unknown (%u)"),
+                    pdu.entity_guid);
+
+    if (!pinfo->fd->flags.visited)
+        adp_track_entity(&pdu, pinfo);
+    finfo = p_get_proto_data(pinfo->fd, proto_17221);
+    if (finfo && finfo->analysis)
+        adp_add_analysis(tvb, pinfo, adp_tree, &pdu, finfo);
+    adp_queue_tap(&pdu, pinfo, finfo);
+}
+
+/* ACMP transactions.
+ *
+ * Commands are paired with their responses by controller GUID,
+ * sequence_id and command type (a response carries its command's type
+ * plus one).  The command type has to be part of the key: a listener
+ * handling CONNECT_RX_COMMAND reuses the controller's GUID and sequence_id
+ * for the CONNECT_TX_COMMAND it sends to the talker.  The table holds
+ * the latest transaction of each key and is only used on the first pass.
+ * What it finds about a frame goes into the frame's per-frame data, so
+ * later passes need no lookup at all, but only for frames with a finding
+ * unless ieee1722_state_revisit asks for every frame.  A command's
+ * transaction points to the command's per-frame data, if it has any, to
+ * fill in the response when it comes.
+ */
+typedef struct _acmp_transaction_key {
+    guint64 controller_guid;
+    guint16 sequence_id;
+    guint8  command_type;
+} acmp_transaction_key_t;
+
+typedef struct _acmp_transaction {
+    acmp_transaction_key_t key;
+    guint32 command_frame;
+    guint32 response_frame;     /* 0 until answered */
+    nstime_t command_ts;
+    ieee17221_frame_info_t *command_finfo;
+} acmp_transaction_t;
+
+static ieee1722_state_table_t *acmp_transactions = NULL;
+
+/* Command timeouts in ms (IEEE 1722.1 table 8.1), indexed by command type / 2 */
+static const guint32 acmp_command_timeouts[] = {
+    2000,   /* CONNECT_TX_COMMAND */
+    200,    /* DISCONNECT_TX_COMMAND */
+    200,    /* GET_TX_STATE_COMMAND */
+    4500,   /* CONNECT_RX_COMMAND */
+    500,    /* DISCONNECT_RX_COMMAND */
+    200,    /* GET_RX_STATE_COMMAND */
+    200     /* GET_TX_CONNECTION_COMMAND */
+};
+
+static guint32 acmp_command_timeout(guint8 message_type)
+{
+    guint index = message_type >> 1;
+
+    return index < array_length(acmp_command_timeouts) ? acmp_command_timeouts[index] : 0;
+}
+
+static guint acmp_transaction_hash(gconstpointer v)
+{
+    const acmp_transaction_key_t *key = v;
+
+    return (guint)key->controller_guid ^ (guint)(key->controller_guid >> 32) ^
+           ((guint)key->command_type << 16 | key->sequence_id);
+}
+
+static gint acmp_transaction_equal(gconstpointer v1, gconstpointer v2)
+{
+    const acmp_transaction_key_t *k1 = v1;
+    const acmp_transaction_key_t *k2 = v2;
+
+    return k1->controller_guid == k2->controller_guid &&
+           k1->sequence_id == k2->sequence_id &&
+           k1->command_type == k2->command_type;
+}
+
+/* Copy the ACMP part of a frame's first-pass results to its per-frame data */
+static ieee17221_frame_info_t *acmp_keep_frame(packet_info *pinfo, const ieee17221_frame_info_t *frame)
+{
+    ieee17221_frame_info_t *finfo = ieee17221_frame_info(pinfo);
+
+    finfo->acmp_tracked = TRUE;
+    finfo->acmp_analysis = frame->acmp_analysis;
+    finfo->acmp_command_frame = frame->acmp_command_frame;
+    finfo->acmp_response_frame = frame->acmp_response_frame;
+    finfo->acmp_retransmission_of = frame->acmp_retransmission_of;
+    finfo->acmp_response_time = frame->acmp_response_time;
+    return finfo;
+}
+
+/* First pass: match a command or response, with the results in *frame */
+static void acmp_track_transaction(const ieee17221_acmp_pdu_t *pdu, packet_info *pinfo,
+                                   ieee17221_frame_info_t *frame)
+{
+    acmp_transaction_key_t key;
+    acmp_transaction_t *trans;
+
+    memset(&key, 0, sizeof(key));
+    key.controller_guid = pdu->controller_guid;
+    key.sequence_id = pdu->sequence_id;
+    key.command_type = pdu->message_type & ~1;
+
+    trans = ieee1722_state_lookup(acmp_transactions, &key);
+
+    if ((pdu->message_type & 1) == 0) {
+        /* A command always starts a new transaction; the sequence_id may
+         * simply have wrapped, or this is a retry of one never answered */
+        if (trans == NULL) {
+            trans = ieee1722_state_insert(acmp_transactions, &key);
         }
+        else if (trans->response_frame == 0) {
+            frame->acmp_retransmission_of = trans->command_frame;
+            frame->acmp_analysis |= IEEE17221_ACMP_RETRANSMISSION;
+        }
+        trans->command_frame = pinfo->fd->num;
+        trans->response_frame = 0;
+        trans->command_ts = pinfo->fd->abs_ts;
+        trans->command_finfo = NULL;
+        if (ieee1722_state_revisit || frame->acmp_analysis)
+            trans->command_finfo = acmp_keep_frame(pinfo, frame);
+        return;
     }
-    proto_tree_add_item(adp_tree, hf_adp_def_vid_format, tvb, ADP_DEF_VIDEO_FORMAT_OFFSET, 4, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_assoc_id, tvb, ADP_ASSOC_ID_OFFSET, 8, FALSE);
-    proto_tree_add_item(adp_tree, hf_adp_entity_type, tvb, ADP_ENTITY_TYPE_OFFSET, 4, FALSE);
 
+    if (trans == NULL) {
+        frame->acmp_analysis |= IEEE17221_ACMP_NO_COMMAND;
+    }
+    else {
+        frame->acmp_command_frame = trans->command_frame;
+        nstime_delta(&frame->acmp_response_time, &pinfo->fd->abs_ts, &trans->command_ts);
+        if (trans->response_frame) {
+            frame->acmp_analysis |= IEEE17221_ACMP_DUPLICATE_RESPONSE;
+            frame->acmp_response_frame = trans->response_frame;
+        }
+        else {
+            trans->response_frame = pinfo->fd->num;
+            if (trans->command_finfo)
+                trans->command_finfo->acmp_response_frame = pinfo->fd->num;
+            if (nstime_to_msec(&frame->acmp_response_time) > acmp_command_timeout(pdu->message_type))
+                frame->acmp_analysis |= IEEE17221_ACMP_LATE_RESPONSE;
+        }
+    }
+    if (ieee1722_state_revisit || frame->acmp_analysis)
+        acmp_keep_frame(pinfo, frame);
 }
 
+/* Show the transaction links and fill in the matching part of the tap
+ * record; frame is NULL on a revisit when the first pass kept nothing */
+static void acmp_add_transaction(tvbuff_t *tvb, packet_info *pinfo, proto_tree *acmp_tree,
+                                 guint8 message_type, ieee17221_acmp_tap_info_t *info,
+                                 const ieee17221_frame_info_t *frame)
+{
+    proto_item *ti;
+    guint32 timeout = acmp_command_timeout(message_type);
+
+    info->timeout_ms = timeout;
+    if (frame == NULL)
+        return;
+    info->analysis = frame->acmp_analysis;
+
+    if ((message_type & 1) == 0) {
+        if (frame->acmp_response_frame) {
+            ti = proto_tree_add_uint(acmp_tree, hf_acmp_response_in, tvb, 0, 0,
+                                     frame->acmp_response_frame);
+            PROTO_ITEM_SET_GENERATED(ti);
+        }
+        else if (pinfo->fd->flags.visited) {
+            /* Only known once the whole capture has been seen */
+            ti = proto_tree_add_boolean(acmp_tree, hf_acmp_no_response, tvb,
+                                        ACMP_SEQUENCE_ID_OFFSET, 2, TRUE);
+            PROTO_ITEM_SET_GENERATED(ti);
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                                   "No response to this command (timeout %u ms)", timeout);
+        }
+        if (frame->acmp_retransmission_of) {
+            ti = proto_tree_add_uint(acmp_tree, hf_acmp_retransmission_of, tvb, 0, 0,
+                                     frame->acmp_retransmission_of);
+            PROTO_ITEM_SET_GENERATED(ti);
+            expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_NOTE,
+                                   "Retransmission of unanswered command in frame %u",
+                                   frame->acmp_retransmission_of);
+        }
+        return;
+    }
+
+    if (frame->acmp_analysis & IEEE17221_ACMP_NO_COMMAND) {
+        ti = proto_tree_add_boolean(acmp_tree, hf_acmp_no_command, tvb,
+                                    ACMP_SEQUENCE_ID_OFFSET, 2, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_NOTE,
+                               "Response to a command not in the capture");
+        return;
+    }
+
+    info->request_frame = frame->acmp_command_frame;
+    info->response_time = frame->acmp_response_time;
+
+    ti = proto_tree_add_uint(acmp_tree, hf_acmp_response_to, tvb, 0, 0, frame->acmp_command_frame);
+    PROTO_ITEM_SET_GENERATED(ti);
+    if (frame->acmp_analysis & IEEE17221_ACMP_DUPLICATE_RESPONSE) {
+        ti = proto_tree_add_uint(acmp_tree, hf_acmp_duplicate_of, tvb, 0, 0,
+                                 frame->acmp_response_frame);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                               "Duplicate response; command already answered in frame %u",
+                               frame->acmp_response_frame);
+        return;
+    }
+
+    ti = proto_tree_add_time(acmp_tree, hf_acmp_response_time, tvb, 0, 0, &info->response_time);
+    PROTO_ITEM_SET_GENERATED(ti);
+    if (frame->acmp_analysis & IEEE17221_ACMP_LATE_RESPONSE) {
+        ti = proto_tree_add_boolean(acmp_tree, hf_acmp_late_response, tvb, 0, 0, TRUE);
+        PROTO_ITEM_SET_GENERATED(ti);
+        expert_add_info_format(pinfo, ti, PI_SEQUENCE, PI_WARN,
+                               "Response after the %u ms command timeout (%.3f ms)",
+                               timeout, nstime_to_msec(&info->response_time));
+    }
+}
+
+static void acmp_queue_tap(const ieee17221_acmp_pdu_t *pdu, packet_info *pinfo,
+                           ieee17221_acmp_tap_info_t *info)
+{
+    info->status = pdu->status;
+    info->stream_id = pdu->stream_id;
+    info->controller_guid = pdu->controller_guid;
+    info->talker_guid = pdu->talker_guid;
+    info->listener_guid = pdu->listener_guid;
+    info->talker_unique_id = pdu->talker_unique_id;
+    info->listener_unique_id = pdu->listener_unique_id;
+    memcpy(info->stream_dest_mac, pdu->stream_dest_mac, 6);
+    info->connection_count = pdu->connection_count;
+    info->sequence_id = pdu->sequence_id;
+    info->flags = pdu->flags;
+    tap_queue_packet(acmp_tap, pinfo, info);
+}
+
+/* Stream ID to talker map, filled from ACMP responses; see "Stream talkers" */
+static ieee1722_state_table_t *stream_talkers = NULL;
+
+static void stream_talker_learn(const ieee17221_acmp_pdu_t *pdu);
+
 static void dissect_17221_acmp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 {
-    proto_item *acmp_tree = NULL;
-    proto_item *flags_ti = NULL;
-    
-    proto_tree *flags_tree = NULL;
-    
-    acmp_tree = proto_item_add_subtree(tree, proto_17221);
+    proto_item *ti = NULL;
+    proto_tree *acmp_tree = NULL;
+
+    ieee17221_acmp_tap_info_t *info;
+    ieee17221_acmp_pdu_t pdu;
+    ieee17221_frame_info_t frame;
+    const ieee17221_frame_info_t *finfo;
+    const guint8 *raw;
+
+    /* One bounds check for the whole PDU; the tree is built from the struct */
+    raw = tvb_get_ptr(tvb, 0, ACMP_PDU_SIZE);
+    ieee17221_decode_acmp(raw, ACMP_PDU_SIZE, &pdu);
     
-    proto_tree_add_item(acmp_tree, hf_acmp_message_type, tvb, ACMP_VERSION_OFFSET, 1, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_status_field, tvb, ACMP_STATUS_FIELD_OFFSET, 1, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_cd_length, tvb, ACMP_CD_LENGTH_OFFSET, 1, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_stream_id, tvb, ACMP_STREAM_ID_OFFSET, 8, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_controller_guid, tvb, ACMP_CONTROLLER_GUID_OFFSET, 8, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_talker_guid, tvb, ACMP_TALKER_GUID_OFFSET, 8, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_listener_guid, tvb, ACMP_LISTENER_GUID_OFFSET, 8, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_talker_unique_id, tvb, ACMP_TALKER_UNIQUE_ID_OFFSET, 2, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_listener_unique_id, tvb, ACMP_LISTENER_UNIQUE_ID_OFFSET, 2, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_stream_dest_mac, tvb, ACMP_DEST_MAC_OFFSET, 6, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_connection_count, tvb, ACMP_CONNECTION_COUNT_OFFSET, 2, FALSE);
-    proto_tree_add_item(acmp_tree, hf_acmp_sequence_id, tvb, ACMP_SEQUENCE_ID_OFFSET, 2, FALSE);
+    ti = proto_tree_add_item(tree, proto_17221, tvb, 0, ACMP_PDU_SIZE, FALSE);
+    acmp_tree = proto_item_add_subtree(ti, ett_acmp);
+
+    proto_tree_add_uint(acmp_tree, hf_acmp_message_type, tvb, ACMP_VERSION_OFFSET, 1, pdu.message_type);
+    proto_tree_add_uint(acmp_tree, hf_acmp_status_field, tvb, ACMP_STATUS_FIELD_OFFSET, 1,
+                        raw[ACMP_STATUS_FIELD_OFFSET]);
+    proto_tree_add_uint(acmp_tree, hf_acmp_cd_length, tvb, ACMP_STATUS_FIELD_OFFSET, 2, pdu.cd_length);
+    proto_tree_add_uint64(acmp_tree, hf_acmp_stream_id, tvb, ACMP_STREAM_ID_OFFSET, 8, pdu.stream_id);
+    proto_tree_add_uint64(acmp_tree, hf_acmp_controller_guid, tvb, ACMP_CONTROLLER_GUID_OFFSET, 8,
+                          pdu.controller_guid);
+    proto_tree_add_uint64(acmp_tree, hf_acmp_talker_guid, tvb, ACMP_TALKER_GUID_OFFSET, 8, pdu.talker_guid);
+    proto_tree_add_uint64(acmp_tree, hf_acmp_listener_guid, tvb, ACMP_LISTENER_GUID_OFFSET, 8,
+                          pdu.listener_guid);
+    proto_tree_add_uint(acmp_tree, hf_acmp_talker_unique_id, tvb, ACMP_TALKER_UNIQUE_ID_OFFSET, 2,
+                        pdu.talker_unique_id);
+    proto_tree_add_uint(acmp_tree, hf_acmp_listener_unique_id, tvb, ACMP_LISTENER_UNIQUE_ID_OFFSET, 2,
+                        pdu.listener_unique_id);
+    proto_tree_add_ether(acmp_tree, hf_acmp_stream_dest_mac, tvb, ACMP_DEST_MAC_OFFSET, 6,
+                         pdu.stream_dest_mac);
+    proto_tree_add_uint(acmp_tree, hf_acmp_connection_count, tvb, ACMP_CONNECTION_COUNT_OFFSET, 2,
+                        pdu.connection_count);
+    proto_tree_add_uint(acmp_tree, hf_acmp_sequence_id, tvb, ACMP_SEQUENCE_ID_OFFSET, 2, pdu.sequence_id);
     
-    if (tree)
+    proto_tree_add_bitmask(acmp_tree, tvb, ACMP_FLAGS_OFFSET, hf_acmp_flags,
+                           ett_acmp_flags, acmp_flags_fields, FALSE);
+    proto_tree_add_uint(acmp_tree, hf_acmp_default_format, tvb, ACMP_DEFAULT_FORMAT_OFFSET, 4,
+                        pdu.default_format);
+
+    if (!pinfo->fd->flags.visited) {
+        memset(&frame, 0, sizeof(frame));
+        acmp_track_transaction(&pdu, pinfo, &frame);
+        stream_talker_learn(&pdu);
+        finfo = &frame;
+    }
+    else {
+        finfo = p_get_proto_data(pinfo->fd, proto_17221);
+        if (finfo && !finfo->acmp_tracked)
+            finfo = NULL;
+    }
+
+    info = ep_alloc0(sizeof(ieee17221_acmp_tap_info_t));
+    info->message_type = pdu.message_type;
+    acmp_add_transaction(tvb, pinfo, acmp_tree, pdu.message_type, info, finfo);
+    acmp_queue_tap(&pdu, pinfo, info);
+}
+
+/* AEM descriptor cache.
+ *
+ * Object names learned from READ_DESCRIPTOR and GET_NAME/SET_NAME
+ * responses, keyed by entity GUID, descriptor type and descriptor index,
+ * so that any later command addressing the same descriptor can show its
+ * name with a single hash lookup.  The cache is filled on the first pass
+ * and keeps the names in its entries, so a descriptor evicted from the
+ * state table leaves nothing behind.
+ */
+typedef struct _aem_descriptor_key {
+    guint64 entity_guid;
+    guint16 descriptor_type;
+    guint16 descriptor_index;
+} aem_descriptor_key_t;
+
+typedef struct _aem_descriptor {
+    aem_descriptor_key_t key;
+    gchar   name[AEM_NAME_LENGTH + 1];  /* empty if not known yet */
+} aem_descriptor_t;
+
+static ieee1722_state_table_t *aem_descriptors = NULL;
+static guint32 aem_descriptors_created = 0;
+
+static guint aem_descriptor_hash(gconstpointer v)
+{
+    const aem_descriptor_key_t *key = v;
+
+    return (guint)key->entity_guid ^ (guint)(key->entity_guid >> 32) ^
+           ((guint)key->descriptor_type << 16 | key->descriptor_index);
+}
+
+static gint aem_descriptor_equal(gconstpointer v1, gconstpointer v2)
+{
+    const aem_descriptor_key_t *k1 = v1;
+    const aem_descriptor_key_t *k2 = v2;
+
+    return k1->entity_guid == k2->entity_guid &&
+           k1->descriptor_type == k2->descriptor_type &&
+           k1->descriptor_index == k2->descriptor_index;
+}
+
+/* Cache entry for a descriptor, or NULL */
+static aem_descriptor_t *aem_descriptor_find(guint64 guid, guint16 type, guint16 index)
+{
+    aem_descriptor_key_t key;
+
+    key.entity_guid = guid;
+    key.descriptor_type = type;
+    key.descriptor_index = index;
+    return ieee1722_state_lookup(aem_descriptors, &key);
+}
+
+static const gchar *aem_descriptor_lookup(guint64 guid, guint16 type, guint16 index)
+{
+    aem_descriptor_t *desc = aem_descriptor_find(guid, type, index);
+
+    return desc && desc->name[0] ? desc->name : NULL;
+}
+
+/* First pass: cache entry for a descriptor, created without a name if not
+ * yet known */
+static aem_descriptor_t *aem_descriptor_get(guint64 guid, guint16 type, guint16 index)
+{
+    aem_descriptor_key_t key;
+    aem_descriptor_t *desc;
+
+    key.entity_guid = guid;
+    key.descriptor_type = type;
+    key.descriptor_index = index;
+    desc = ieee1722_state_lookup(aem_descriptors, &key);
+    if (desc == NULL) {
+        desc = ieee1722_state_insert(aem_descriptors, &key);
+        aem_descriptors_created++;
+    }
+    return desc;
+}
+
+static void aem_descriptor_learn(tvbuff_t *tvb, packet_info *pinfo, guint64 guid,
+                                 guint16 type, guint16 index, gint name_offset)
+{
+    aem_descriptor_t *desc;
+    const guint8 *name;
+
+    if (pinfo->fd->flags.visited || tvb_length_remaining(tvb, name_offset) < AEM_NAME_LENGTH)
+        return;
+
+    name = tvb_get_ptr(tvb, name_offset, AEM_NAME_LENGTH);
+    if (name[0] == '\0')
+        return;
+
+    desc = aem_descriptor_get(guid, type, index);
+    memcpy(desc->name, name, AEM_NAME_LENGTH);
+}
+
+/* Stream talkers.
+ *
+ * Successful ACMP responses name the talker (entity GUID and unique ID) of
+ * the stream ID they carry.  The map from stream ID to talker is built on
+ * the first pass and exported through ieee17221_stream_talker(), so the
+ * 1722 dissector can label stream data frames.  Each record points at the
+ * cache entries of the talker's ENTITY descriptor and of its STREAM_OUTPUT
+ * descriptor.  Names that AECP learns later, or that change, therefore
+ * show up without touching the record.  Learning the talker creates the
+ * entries, without a name, if AECP has not shown them yet, before the
+ * record itself, and then points the record at them by lookup, so no
+ * insert can leave it pointing at an evicted entry.  Whenever the state
+ * tables have evicted anything since, or AECP has added descriptors, the
+ * pointers are looked up again, but only looked up: a descriptor that has
+ * gone is left NULL, so labelling stream frames never allocates or evicts.
+ */
+typedef struct _stream_talker {
+    ieee17221_stream_talker_t pub;
+    aem_descriptor_t *entity;   /* NULL if evicted */
+    aem_descriptor_t *stream;
+    guint32 evictions;          /* state table evictions when they were looked up */
+    guint32 descriptors;        /* aem_descriptors_created then */
+} stream_talker_t;
+
+/* Point the talker at its descriptors, if they are in the cache */
+static void stream_talker_resolve(stream_talker_t *talker)
+{
+    guint64 guid = talker->pub.talker_guid;
+
+    talker->entity = aem_descriptor_find(guid, AEM_DESC_ENTITY, 0);
+    talker->stream = aem_descriptor_find(guid, AEM_DESC_STREAM_OUTPUT, talker->pub.talker_unique_id);
+    talker->evictions = ieee1722_state_evictions();
+    talker->descriptors = aem_descriptors_created;
+}
+
+static void stream_talker_learn(const ieee17221_acmp_pdu_t *pdu)
+{
+    stream_talker_t *talker;
+
+    if (!(pdu->message_type & 1) || pdu->status != ACMP_STATUS_SUCCESS ||
+        pdu->stream_id == 0 || pdu->talker_guid == 0)
+        return;
+
+    talker = ieee1722_state_lookup(stream_talkers, &pdu->stream_id);
+    if (talker && talker->pub.talker_guid == pdu->talker_guid &&
+        talker->pub.talker_unique_id == pdu->talker_unique_id &&
+        talker->entity && talker->stream && talker->evictions == ieee1722_state_evictions()) {
+        talker->pub.class_b = (pdu->flags & ACMP_FLAG_CLASS_B_BITMASK) != 0;
+        return;
+    }
+
+    /* Creating the descriptors may evict the record, or one another */
+    aem_descriptor_get(pdu->talker_guid, AEM_DESC_ENTITY, 0);
+    aem_descriptor_get(pdu->talker_guid, AEM_DESC_STREAM_OUTPUT, pdu->talker_unique_id);
+    talker = ieee1722_state_lookup(stream_talkers, &pdu->stream_id);
+    if (talker == NULL)
+        talker = ieee1722_state_insert(stream_talkers, &pdu->stream_id);
+    talker->pub.class_b = (pdu->flags & ACMP_FLAG_CLASS_B_BITMASK) != 0;
+    talker->pub.talker_guid = pdu->talker_guid;
+    talker->pub.talker_unique_id = pdu->talker_unique_id;
+    stream_talker_resolve(talker);
+}
+
+const ieee17221_stream_talker_t *ieee17221_stream_talker(guint64 stream_id)
+{
+    stream_talker_t *talker;
+
+    if (stream_talkers == NULL)
+        return NULL;
+    talker = ieee1722_state_lookup(stream_talkers, &stream_id);
+    if (talker == NULL)
+        return NULL;
+    /* Either descriptor may have been evicted, or learned again, since */
+    if (talker->evictions != ieee1722_state_evictions() ||
+        talker->descriptors != aem_descriptors_created)
+        stream_talker_resolve(talker);
+    talker->pub.entity_name = talker->entity && talker->entity->name[0] ? talker->entity->name : NULL;
+    talker->pub.stream_name = talker->stream && talker->stream->name[0] ? talker->stream->name : NULL;
+    return &talker->pub;
+}
+
+static void ieee17221_init(void)
+{
+    /* Entities are linked to each other on the wheel */
+    adp_wheel_clear();
+
+    ieee1722_state_table_destroy(aem_descriptors);
+    ieee1722_state_table_destroy(adp_entities);
+    ieee1722_state_table_destroy(acmp_transactions);
+    ieee1722_state_table_destroy(stream_talkers);
+
+    /* The transactions the entries point at are se_alloc()ed and released
+     * with the capture */
+    aem_descriptors = ieee1722_state_table_new("AEM descriptors", sizeof(aem_descriptor_t),
+                                               sizeof(aem_descriptor_key_t), aem_descriptor_hash,
+                                               aem_descriptor_equal, NULL);
+    adp_entities = ieee1722_state_table_new("ADP entities", sizeof(adp_entity_t), sizeof(guint64),
+                                            g_int64_hash, g_int64_equal, adp_entity_free);
+    acmp_transactions = ieee1722_state_table_new("ACMP transactions",
+                                                 sizeof(acmp_transaction_t),
+                                                 sizeof(acmp_transaction_key_t),
+                                                 acmp_transaction_hash, acmp_transaction_equal,
+                                                 NULL);
+    stream_talkers = ieee1722_state_table_new("Stream talkers", sizeof(stream_talker_t),
+                                              sizeof(guint64), g_int64_hash, g_int64_equal, NULL);
+}
+
+/* Offset of object_name within a descriptor of the given type, or -1 */
+static gint aem_object_name_offset(guint16 type)
+{
+    switch (type) {
+        case AEM_DESC_ENTITY:
+            return AEM_ENTITY_NAME_OFFSET;
+        case AEM_DESC_LOCALE:
+        case AEM_DESC_STRINGS:
+        case AEM_DESC_STREAM_PORT_INPUT:
+        case AEM_DESC_STREAM_PORT_OUTPUT:
+        case AEM_DESC_EXTERNAL_PORT_INPUT:
+        case AEM_DESC_EXTERNAL_PORT_OUTPUT:
+        case AEM_DESC_INTERNAL_PORT_INPUT:
+        case AEM_DESC_INTERNAL_PORT_OUTPUT:
+        case AEM_DESC_AUDIO_MAP:
+        case AEM_DESC_VIDEO_MAP:
+        case AEM_DESC_SENSOR_MAP:
+        case AEM_DESC_MATRIX_SIGNAL:
+            return -1;
+        default:
+            return type <= AEM_DESC_CONTROL_BLOCK ? AEM_OBJECT_NAME_OFFSET : -1;
+    }
+}
+
+/* Add the descriptor_type/descriptor_index pair at offset and annotate it
+ * with the cached object name, if any.
+ */
+static void aem_add_descriptor_ref(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
+                                   guint64 guid, gint offset)
+{
+    proto_item *ti = NULL;
+    guint16 type;
+    guint16 index;
+    const gchar *name;
+
+    type = tvb_get_ntohs(tvb, offset);
+    index = tvb_get_ntohs(tvb, offset + 2);
+    name = aem_descriptor_lookup(guid, type, index);
+
+    proto_tree_add_item(tree, hf_aem_descriptor_type, tvb, offset, 2, FALSE);
+    ti = proto_tree_add_item(tree, hf_aem_descriptor_index, tvb, offset + 2, 2, FALSE);
+    if (name) {
+        proto_item_append_text(ti, " (\"%s\")", name);
+        col_append_fstr(pinfo->cinfo, COL_INFO, " %s[%u] \"%s\"",
+                        val_to_str(type, aem_descriptor_type_vals, "0x%04x"), index, name);
+    }
+    else {
+        col_append_fstr(pinfo->cinfo, COL_INFO, " %s[%u]",
+                        val_to_str(type, aem_descriptor_type_vals, "0x%04x"), index);
+    }
+}
+
+static void dissect_aem_read_descriptor(tvbuff_t *tvb, packet_info *pinfo, proto_tree *aecp_tree,
+                                        guint64 guid, gboolean response, guint8 status)
+{
+    proto_item *ti = NULL;
+    proto_tree *desc_tree = NULL;
+    guint16 type;
+    guint16 index;
+    gint name_offset;
+    gint remaining;
+
+    proto_tree_add_item(aecp_tree, hf_aem_configuration_index, tvb, AEM_READ_CONFIGURATION_OFFSET, 2, FALSE);
+    if (!response || status != AEM_STATUS_SUCCESS) {
+        aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_READ_DESC_TYPE_OFFSET);
+        return;
+    }
+
+    /* The response carries the descriptor itself, starting with its type and index */
+    type = tvb_get_ntohs(tvb, AEM_READ_DESCRIPTOR_OFFSET);
+    index = tvb_get_ntohs(tvb, AEM_READ_DESCRIPTOR_OFFSET + 2);
+    name_offset = aem_object_name_offset(type);
+    if (name_offset >= 0)
+        aem_descriptor_learn(tvb, pinfo, guid, type, index, AEM_READ_DESCRIPTOR_OFFSET + name_offset);
+
+    remaining = tvb_length_remaining(tvb, AEM_READ_DESCRIPTOR_OFFSET);
+    ti = proto_tree_add_text(aecp_tree, tvb, AEM_READ_DESCRIPTOR_OFFSET, remaining, "Descriptor");
+    desc_tree = proto_item_add_subtree(ti, ett_aem_descriptor);
+    aem_add_descriptor_ref(tvb, pinfo, desc_tree, guid, AEM_READ_DESCRIPTOR_OFFSET);
+
+    if (name_offset >= 0 && remaining >= name_offset + AEM_NAME_LENGTH) {
+        if (name_offset > AEM_OBJECT_NAME_OFFSET)
+            proto_tree_add_item(desc_tree, hf_aem_descriptor_data, tvb,
+                                AEM_READ_DESCRIPTOR_OFFSET + AEM_OBJECT_NAME_OFFSET,
+                                name_offset - AEM_OBJECT_NAME_OFFSET, FALSE);
+        proto_tree_add_item(desc_tree, type == AEM_DESC_ENTITY ? hf_aem_entity_name : hf_aem_object_name,
+                            tvb, AEM_READ_DESCRIPTOR_OFFSET + name_offset, AEM_NAME_LENGTH, FALSE);
+        if (remaining > name_offset + AEM_NAME_LENGTH)
+            proto_tree_add_item(desc_tree, hf_aem_descriptor_data, tvb,
+                                AEM_READ_DESCRIPTOR_OFFSET + name_offset + AEM_NAME_LENGTH,
+                                remaining - name_offset - AEM_NAME_LENGTH, FALSE);
+    }
+    else if (remaining > AEM_OBJECT_NAME_OFFSET) {
+        proto_tree_add_item(desc_tree, hf_aem_descriptor_data, tvb,
+                            AEM_READ_DESCRIPTOR_OFFSET + AEM_OBJECT_NAME_OFFSET,
+                            remaining - AEM_OBJECT_NAME_OFFSET, FALSE);
+    }
+}
+
+static void dissect_17221_aecp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
+{
+    proto_item *ti = NULL;
+    proto_tree *aecp_tree = NULL;
+    guint8 message_type;
+    guint8 status;
+    guint16 command_type;
+    guint64 guid;
+    gboolean response;
+    gint remaining;
+
+    message_type = tvb_get_guint8(tvb, AECP_VERSION_OFFSET) & AECP_MSG_TYPE_MASK;
+    status = (tvb_get_guint8(tvb, AECP_STATUS_FIELD_OFFSET) & AECP_STATUS_FIELD_MASK) >> 3;
+    guid = tvb_get_ntoh64(tvb, AECP_TARGET_GUID_OFFSET);
+    response = message_type & 1;
+
+    ti = proto_tree_add_item(tree, proto_17221, tvb, 0, -1, FALSE);
+    aecp_tree = proto_item_add_subtree(ti, ett_aecp);
+
+    proto_tree_add_item(aecp_tree, hf_aecp_message_type, tvb, AECP_VERSION_OFFSET, 1, FALSE);
+    proto_tree_add_item(aecp_tree, hf_aecp_status_field, tvb, AECP_STATUS_FIELD_OFFSET, 1, FALSE);
+    proto_tree_add_item(aecp_tree, hf_aecp_cd_length, tvb, AECP_CD_LENGTH_OFFSET, 2, FALSE);
+    proto_tree_add_item(aecp_tree, hf_aecp_target_guid, tvb, AECP_TARGET_GUID_OFFSET, 8, FALSE);
+    proto_tree_add_item(aecp_tree, hf_aecp_controller_guid, tvb, AECP_CONTROLLER_GUID_OFFSET, 8, FALSE);
+    proto_tree_add_item(aecp_tree, hf_aecp_sequence_id, tvb, AECP_SEQUENCE_ID_OFFSET, 2, FALSE);
+
+    if (message_type != AECP_AEM_COMMAND && message_type != AECP_AEM_RESPONSE) {
+        col_add_fstr(pinfo->cinfo, COL_INFO, "AECP %s",
+                     val_to_str(message_type, aecp_message_type_vals, "Unknown (%u)"));
+        remaining = tvb_length_remaining(tvb, AECP_COMMAND_TYPE_OFFSET);
+        if (remaining > 0)
+            proto_tree_add_item(aecp_tree, hf_aecp_payload, tvb, AECP_COMMAND_TYPE_OFFSET, remaining, FALSE);
+        return;
+    }
+
+    command_type = tvb_get_ntohs(tvb, AECP_COMMAND_TYPE_OFFSET) & AECP_COMMAND_TYPE_MASK;
+    proto_tree_add_item(aecp_tree, hf_aecp_unsolicited, tvb, AECP_COMMAND_TYPE_OFFSET, 2, FALSE);
+    proto_tree_add_item(aecp_tree, hf_aecp_command_type, tvb, AECP_COMMAND_TYPE_OFFSET, 2, FALSE);
+
+    if (response && status != AEM_STATUS_SUCCESS)
+        col_add_fstr(pinfo->cinfo, COL_INFO, "AEM %s response (%s)",
+                     val_to_str(command_type, aem_command_type_vals, "0x%04x"),
+                     val_to_str(status, aem_status_vals, "Unknown (%u)"));
+    else
+        col_add_fstr(pinfo->cinfo, COL_INFO, "AEM %s %s",
+                     val_to_str(command_type, aem_command_type_vals, "0x%04x"),
+                     response ? "response" : "command");
+
+    switch (command_type)
     {
-        flags_ti = proto_tree_add_item(acmp_tree, hf_acmp_flags, tvb, ACMP_FLAGS_OFFSET, 2, FALSE);
-        
-        flags_tree = proto_item_add_subtree(flags_ti, ett_acmp_flags);
-        
-        proto_tree_add_item(flags_tree,
-                hf_acmp_flags_class_b, tvb, ACMP_FLAGS_OFFSET, 2, FALSE);
-        proto_tree_add_item(flags_tree,
-                hf_acmp_flags_fast_connect, tvb, ACMP_FLAGS_OFFSET, 2, FALSE);
-        proto_tree_add_item(flags_tree,
-                hf_acmp_flags_saved_state, tvb, ACMP_FLAGS_OFFSET, 2, FALSE);
-        proto_tree_add_item(flags_tree,
-                hf_acmp_flags_streaming_wait, tvb, ACMP_FLAGS_OFFSET, 2, FALSE);
-        
-    }    
-        
-    proto_tree_add_item(acmp_tree, hf_acmp_default_format, tvb, ACMP_DEFAULT_FORMAT_OFFSET, 4, FALSE);
+        case AEM_ACQUIRE_ENTITY:
+        case AEM_LOCK_ENTITY:
+        {
+            proto_tree_add_item(aecp_tree, hf_aem_acquire_flags, tvb, AEM_ACQUIRE_FLAGS_OFFSET, 4, FALSE);
+            proto_tree_add_item(aecp_tree, hf_aem_owner_guid, tvb, AEM_ACQUIRE_OWNER_GUID_OFFSET, 8, FALSE);
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_ACQUIRE_DESC_TYPE_OFFSET);
+            break;
+        }
+        case AEM_READ_DESCRIPTOR:
+        {
+            dissect_aem_read_descriptor(tvb, pinfo, aecp_tree, guid, response, status);
+            break;
+        }
+        case AEM_SET_CONFIGURATION:
+        case AEM_GET_CONFIGURATION:
+        {
+            if (tvb_length_remaining(tvb, AEM_CONFIGURATION_INDEX_OFFSET) >= 2)
+                proto_tree_add_item(aecp_tree, hf_aem_configuration_index, tvb,
+                                    AEM_CONFIGURATION_INDEX_OFFSET, 2, FALSE);
+            break;
+        }
+        case AEM_SET_STREAM_FORMAT:
+        case AEM_GET_STREAM_FORMAT:
+        {
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_DESCRIPTOR_TYPE_OFFSET);
+            if (tvb_length_remaining(tvb, AEM_STREAM_FORMAT_OFFSET) >= 8)
+                proto_tree_add_item(aecp_tree, hf_aem_stream_format, tvb, AEM_STREAM_FORMAT_OFFSET, 8, FALSE);
+            break;
+        }
+        case AEM_SET_NAME:
+        case AEM_GET_NAME:
+        {
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_DESCRIPTOR_TYPE_OFFSET);
+            proto_tree_add_item(aecp_tree, hf_aem_name_index, tvb, AEM_NAME_INDEX_OFFSET, 2, FALSE);
+            proto_tree_add_item(aecp_tree, hf_aem_configuration_index, tvb, AEM_NAME_CONFIGURATION_OFFSET, 2, FALSE);
+            if (tvb_length_remaining(tvb, AEM_NAME_OFFSET) >= AEM_NAME_LENGTH) {
+                proto_tree_add_item(aecp_tree, hf_aem_name, tvb, AEM_NAME_OFFSET, AEM_NAME_LENGTH, FALSE);
+                /* name_index 0 is the object (or entity) name */
+                if (response && status == AEM_STATUS_SUCCESS &&
+                    tvb_get_ntohs(tvb, AEM_NAME_INDEX_OFFSET) == 0)
+                    aem_descriptor_learn(tvb, pinfo, guid,
+                                         tvb_get_ntohs(tvb, AEM_DESCRIPTOR_TYPE_OFFSET),
+                                         tvb_get_ntohs(tvb, AEM_DESCRIPTOR_INDEX_OFFSET),
+                                         AEM_NAME_OFFSET);
+            }
+            break;
+        }
+        case AEM_SET_SAMPLING_RATE:
+        case AEM_GET_SAMPLING_RATE:
+        {
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_DESCRIPTOR_TYPE_OFFSET);
+            if (tvb_length_remaining(tvb, AEM_SAMPLING_RATE_OFFSET) >= 4)
+                proto_tree_add_item(aecp_tree, hf_aem_sampling_rate, tvb, AEM_SAMPLING_RATE_OFFSET, 4, FALSE);
+            break;
+        }
+        case AEM_SET_CLOCK_SOURCE:
+        case AEM_GET_CLOCK_SOURCE:
+        {
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_DESCRIPTOR_TYPE_OFFSET);
+            if (tvb_length_remaining(tvb, AEM_CLOCK_SOURCE_INDEX_OFFSET) >= 2)
+                proto_tree_add_item(aecp_tree, hf_aem_clock_source_index, tvb,
+                                    AEM_CLOCK_SOURCE_INDEX_OFFSET, 2, FALSE);
+            break;
+        }
+        case AEM_GET_COUNTERS:
+        {
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_DESCRIPTOR_TYPE_OFFSET);
+            if (tvb_length_remaining(tvb, AEM_COUNTERS_VALID_OFFSET) >= 4 + AEM_COUNTERS_BLOCK_LENGTH) {
+                proto_tree_add_item(aecp_tree, hf_aem_counters_valid, tvb, AEM_COUNTERS_VALID_OFFSET, 4, FALSE);
+                proto_tree_add_item(aecp_tree, hf_aem_counters_block, tvb,
+                                    AEM_COUNTERS_BLOCK_OFFSET, AEM_COUNTERS_BLOCK_LENGTH, FALSE);
+            }
+            break;
+        }
+        case AEM_SET_VIDEO_FORMAT:
+        case AEM_GET_VIDEO_FORMAT:
+        case AEM_SET_SENSOR_FORMAT:
+        case AEM_GET_SENSOR_FORMAT:
+        case AEM_SET_STREAM_INFO:
+        case AEM_GET_STREAM_INFO:
+        case AEM_SET_CONTROL:
+        case AEM_GET_CONTROL:
+        case AEM_START_STREAMING:
+        case AEM_STOP_STREAMING:
+        case AEM_GET_AVB_INFO:
+        case AEM_GET_AUDIO_MAP:
+        case AEM_ADD_AUDIO_MAPPINGS:
+        case AEM_REMOVE_AUDIO_MAPPINGS:
+        {
+            /* Addressed to a descriptor; the rest is shown as payload */
+            aem_add_descriptor_ref(tvb, pinfo, aecp_tree, guid, AEM_DESCRIPTOR_TYPE_OFFSET);
+            remaining = tvb_length_remaining(tvb, AEM_DESCRIPTOR_TYPE_OFFSET + 4);
+            if (remaining > 0)
+                proto_tree_add_item(aecp_tree, hf_aecp_payload, tvb,
+                                    AEM_DESCRIPTOR_TYPE_OFFSET + 4, remaining, FALSE);
+            break;
+        }
+        default:
+        {
+            remaining = tvb_length_remaining(tvb, AECP_PAYLOAD_OFFSET);
+            if (remaining > 0)
+                proto_tree_add_item(aecp_tree, hf_aecp_payload, tvb, AECP_PAYLOAD_OFFSET, remaining, FALSE);
+            break;
+        }
+    }
 }
 
 static void dissect_17221(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 {
-    
     guint8 subtype = 0;
     subtype = tvb_get_guint8(tvb, 0);
     subtype &= 0x7F;
@@ -654,6 +1944,7 @@ static void dissect_17221(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
         case 0x7B:
         {
             col_set_str(pinfo->cinfo, COL_INFO, "AVDECC Enumeration and Control Protocol");
+            dissect_17221_aecp(tvb, pinfo, tree);
             break;
         }
         case 0x7C:
@@ -666,10 +1957,9 @@ static void dissect_17221(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
         {
             /* Shouldn't get here */
             col_set_str(pinfo->cinfo, COL_INFO, "1722.1 Unknown");
-            return;
+            break;
         }
     }
- 
 }
 
 /* Register the protocol with Wireshark */
@@ -707,31 +1997,31 @@ void proto_register_17221(void)
         /* Entity Capability Flags Begin */
         { &hf_adp_entity_cap_avdecc_ip,
             { "AVDECC_IP", "ieee17221.entity_capabilities.avdecc_ip", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_AVDECC_IP_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_AVDECC_IP_BITMASK, NULL, HFILL } 
         },        
         { &hf_adp_entity_cap_zero_conf,
             { "ZERO_CONF", "ieee17221.entity_capabilities.zero_conf", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_ZERO_CONF_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_ZERO_CONF_BITMASK, NULL, HFILL } 
         },   
         { &hf_adp_entity_cap_gateway_entity,
             { "GATEWAY_ENTITY", "ieee17221.entity_capabilities.gateway_entity", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_GATEWAY_ENTITY_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_GATEWAY_ENTITY_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_entity_cap_avdecc_control,
             { "AVDECC_CONTROL", "ieee17221.entity_capabilities.avdecc_control", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_AVDECC_CONTROL_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_AVDECC_CONTROL_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_entity_cap_legacy_avc,
             { "LEGACY_AVC", "ieee17221.entity_capabilities.legacy_avc", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_LEGACY_AVC_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_LEGACY_AVC_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_entity_cap_assoc_id_support,
             { "ASSOCIATION_ID_SUPPORTED", "ieee17221.entity_capabilities.association_id_supported", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_ASSOC_ID_SUPPORT_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_ASSOC_ID_SUPPORT_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_entity_cap_assoc_id_valid,
             { "ASSOCIATION_ID_VALID", "ieee17221.entity_capabilities.association_id_valid", 
-              FT_UINT32, BASE_DEC, VALS(avb_bool_vals), ADP_ASSOC_ID_VALID_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 32, NULL, ADP_ASSOC_ID_VALID_BITMASK, NULL, HFILL } 
         },
         /* Entity Capability Flags End */
         { &hf_adp_talker_stream_srcs,
@@ -745,35 +2035,35 @@ void proto_register_17221(void)
         /* Talker Capability Flags Begin */
         { &hf_adp_talk_cap_implement,
             { "IMPLEMENTED", "ieee17221.talker_capabilities.implemented",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_IMPLEMENTED_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_IMPLEMENTED_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_other_src,
             { "OTHER_SOURCE", "ieee17221.talker_capabilities.other_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_OTHER_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_OTHER_SRC_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_control_src,
             { "CONTROL_SOURCE", "ieee17221.talker_capabilities.control_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_CONTROL_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_CONTROL_SRC_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_media_clk_src,
             { "MEDIA_CLOCK_SOURCE", "ieee17221.talker_capabilities.media_clock_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_MEDIA_CLK_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_MEDIA_CLK_SRC_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_smpte_src,
             { "SMPTE_SOURCE", "ieee17221.talker_capabilities.smpte_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_SMPTE_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_SMPTE_SRC_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_midi_src,
             { "MIDI_SOURCE", "ieee17221.talker_capabilities.midi_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_MIDI_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_MIDI_SRC_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_audio_src,
             { "AUDIO_SOURCE", "ieee17221.talker_capabilities.audio_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_AUDIO_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_AUDIO_SRC_BITMASK, NULL, HFILL }
         },
         { &hf_adp_talk_cap_video_src,
             { "VIDEO_SOURCE", "ieee17221.talker_capabilities.video_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_TALK_VIDEO_SRC_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_TALK_VIDEO_SRC_BITMASK, NULL, HFILL }
         },
         /* Talker Capability Flags End */
         { &hf_adp_listener_stream_sinks,
@@ -787,35 +2077,35 @@ void proto_register_17221(void)
         /* Listener Capability Flags Begin */
         { &hf_adp_list_cap_implement,
             { "IMPLEMENTED", "ieee17221.listener_capabilities.implemented",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_IMPLEMENTED_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_IMPLEMENTED_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_other_sink,
             { "OTHER_SINK", "ieee17221.listener_capabilities.other_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_OTHER_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_OTHER_SINK_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_control_sink,
             { "CONTROL_SINK", "ieee17221.listener_capabilities.control_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_CONTROL_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_CONTROL_SINK_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_media_clk_sink,
             { "MEDIA_CLOCK_SINK", "ieee17221.listener_capabilities.media_clock_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_MEDIA_CLK_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_MEDIA_CLK_SINK_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_smpte_sink,
             { "SMPTE_SINK", "ieee17221.listener_capabilities.smpte_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_SMPTE_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_SMPTE_SINK_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_midi_sink,
             { "MIDI_SINK", "ieee17221.listener_capabilities.midi_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_MIDI_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_MIDI_SINK_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_audio_sink,
             { "AUDIO_SINK", "ieee17221.listener_capabilities.audio_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_AUDIO_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_AUDIO_SINK_BITMASK, NULL, HFILL }
         },
         { &hf_adp_list_cap_video_sink,
             { "VIDEO_SINK", "ieee17221.listener_capabilities.video_source",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_LIST_VIDEO_SINK_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 16, NULL, ADP_LIST_VIDEO_SINK_BITMASK, NULL, HFILL }
         },
         /* Listener Capability Flags End */
         { &hf_adp_controller_cap,
@@ -825,11 +2115,11 @@ void proto_register_17221(void)
         /* Controller Capability Flags Begin */
         { &hf_adp_cont_cap_implement,
             { "IMPLEMENTED", "ieee17221.controller_capabilities.implemented",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CONT_IMPLEMENTED_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 32, NULL, ADP_CONT_IMPLEMENTED_BITMASK, NULL, HFILL }
         },
         { &hf_adp_cont_cap_layer3_proxy,
             { "LAYER3_PROXY", "ieee17221.controller_capabilities.layer3_proxy",
-                FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CONT_LAYER3_PROXY_BITMASK, NULL, HFILL }
+                FT_BOOLEAN, 32, NULL, ADP_CONT_LAYER3_PROXY_BITMASK, NULL, HFILL }
         },
         { &hf_adp_avail_index,
             { "Available Index", "ieee17221.available_index", 
@@ -851,27 +2141,27 @@ void proto_register_17221(void)
         /* Sample rates Begin */
         { &hf_adp_samp_rate_44k1,
         { "44.1kHz", "ieee17221.default_audio_format.sample_rates.44k1", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ADP_SAMP_RATE_44K1_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 8, NULL, ADP_SAMP_RATE_44K1_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_samp_rate_48k,
         { "48kHz", "ieee17221.default_audio_format.sample_rates.48k", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ADP_SAMP_RATE_48K_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 8, NULL, ADP_SAMP_RATE_48K_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_samp_rate_88k2,
         { "88.2kHz", "ieee17221.default_audio_format.sample_rates.88k2", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ADP_SAMP_RATE_88K2_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 8, NULL, ADP_SAMP_RATE_88K2_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_samp_rate_96k,
         { "96kHz", "ieee17221.default_audio_format.sample_rates.96k", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ADP_SAMP_RATE_96K_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 8, NULL, ADP_SAMP_RATE_96K_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_samp_rate_176k4,
         { "176.4kHz", "ieee17221.default_audio_format.sample_rates.176k4", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ADP_SAMP_RATE_176K4_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 8, NULL, ADP_SAMP_RATE_176K4_BITMASK, NULL, HFILL } 
         },
         { &hf_adp_samp_rate_192k,
         { "192kHz", "ieee17221.default_audio_format.sample_rates.192k", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ADP_SAMP_RATE_192K_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 8, NULL, ADP_SAMP_RATE_192K_BITMASK, NULL, HFILL } 
         },
         /* Sample rates End */
         { &hf_adp_def_aud_max_chan,
@@ -880,11 +2170,11 @@ void proto_register_17221(void)
         },
         { &hf_adp_def_aud_saf_flag,
         { "saf", "ieee17221.default_audio_format.saf", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_DEF_AUDIO_SAF_MASK, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_DEF_AUDIO_SAF_MASK, NULL, HFILL } 
         },
         { &hf_adp_def_aud_float_flag,
         { "float", "ieee17221.default_audio_format.float", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_DEF_AUDIO_FLOAT_MASK, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_DEF_AUDIO_FLOAT_MASK, NULL, HFILL } 
         },
         { &hf_adp_def_aud_chan_formats,
         { "Channel Formats", "ieee17221.default_audio_format.channel_formats", 
@@ -893,67 +2183,67 @@ void proto_register_17221(void)
         /* Channel Formats Fields Start */
         { &hf_adp_chan_format_mono,
         { "MONO", "ieee17221.default_audio_format.channel_formats.mono", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_MONO, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_MONO, NULL, HFILL } 
         },
         { &hf_adp_chan_format_2ch,
         { "2_CH", "ieee17221.default_audio_format.channel_formats.2_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_2CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_2CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_3ch,
         { "3_CH", "ieee17221.default_audio_format.channel_formats.3_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_3CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_3CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_4ch,
         { "4_CH", "ieee17221.default_audio_format.channel_formats.4_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_4CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_4CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_5ch,
         { "5_CH", "ieee17221.default_audio_format.channel_formats.5_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_5CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_5CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_6ch,
         { "6_CH", "ieee17221.default_audio_format.channel_formats.6_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_6CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_6CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_7ch,
         { "7_CH", "ieee17221.default_audio_format.channel_formats.7_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_7CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_7CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_8ch,
         { "8_CH", "ieee17221.default_audio_format.channel_formats.8_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_8CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_8CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_10ch,
         { "10_CH", "ieee17221.default_audio_format.channel_formats.10_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_10CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_10CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_12ch,
         { "12_CH", "ieee17221.default_audio_format.channel_formats.12_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_12CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_12CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_14ch,
         { "14_CH", "ieee17221.default_audio_format.channel_formats.14_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_14CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_14CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_16ch,
         { "16_CH", "ieee17221.default_audio_format.channel_formats.16_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_16CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_16CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_18ch,
         { "18_CH", "ieee17221.default_audio_format.channel_formats.18_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_18CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_18CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_20ch,
         { "20_CH", "ieee17221.default_audio_format.channel_formats.20_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_20CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_20CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_22ch,
         { "22_CH", "ieee17221.default_audio_format.channel_formats.22_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_22CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_22CH, NULL, HFILL } 
         },
         { &hf_adp_chan_format_24ch,
         { "24_CH", "ieee17221.default_audio_format.channel_formats.24_ch", 
-              FT_UINT16, BASE_DEC, VALS(avb_bool_vals), ADP_CHAN_FORMAT_24CH, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ADP_CHAN_FORMAT_24CH, NULL, HFILL } 
         },
         /* Channel Formats Fields End */
         /* Default Audio Formats Fields End */
@@ -969,6 +2259,39 @@ void proto_register_17221(void)
         { "Entity Type", "ieee17221.entity_type", 
               FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL } 
         },
+        { &hf_adp_analysis_new_entity,
+            { "New Entity", "ieee17221.adp.analysis.new_entity",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "First ADP message seen for this entity GUID", HFILL }
+        },
+        { &hf_adp_analysis_previous_index,
+            { "Previous Available Index", "ieee17221.adp.analysis.previous_index",
+              FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_adp_analysis_reboot,
+            { "Entity Rebooted", "ieee17221.adp.analysis.reboot",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "available_index went backwards without an ENTITY_DEPARTING", HFILL }
+        },
+        { &hf_adp_analysis_guid_collision,
+            { "GUID Collision", "ieee17221.adp.analysis.guid_collision",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "Entity GUID announced by another station", HFILL }
+        },
+        { &hf_adp_analysis_reappeared,
+            { "Reappeared", "ieee17221.adp.analysis.reappeared",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "Entity announced again after silently departing", HFILL }
+        },
+        { &hf_adp_analysis_expired_guid,
+            { "Silently Departed Entity", "ieee17221.adp.analysis.expired_guid",
+              FT_UINT64, BASE_HEX, NULL, 0x00,
+              "Entity whose valid_time ran out before this frame without an ENTITY_DEPARTING", HFILL }
+        },
+        { &hf_adp_analysis_caps_changed,
+            { "Capabilities Changed", "ieee17221.adp.analysis.caps_changed",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
         /*******************************************************************/
         { &hf_acmp_message_type,
             { "Message Type", "ieee17221.message_type", 
@@ -1025,29 +2348,168 @@ void proto_register_17221(void)
         /* ACMP Flags Begin */
         { &hf_acmp_flags_class_b,
         { "CLASS_B", "ieee17221.flags.class_b", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ACMP_FLAG_CLASS_B_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ACMP_FLAG_CLASS_B_BITMASK, NULL, HFILL } 
         },
         { &hf_acmp_flags_fast_connect,
         { "FAST_CONNECT", "ieee17221.flags.fast_connect", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ACMP_FLAG_FAST_CONNECT_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ACMP_FLAG_FAST_CONNECT_BITMASK, NULL, HFILL } 
         },
         { &hf_acmp_flags_saved_state,
         { "SAVED_STATE", "ieee17221.flags.saved_state", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ACMP_FLAG_SAVED_STATE_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ACMP_FLAG_SAVED_STATE_BITMASK, NULL, HFILL } 
         },
         { &hf_acmp_flags_streaming_wait,
         { "STREAMING_WAIT", "ieee17221.flags.streaming_wait", 
-              FT_UINT8, BASE_DEC, VALS(avb_bool_vals), ACMP_FLAG_STREAMING_WAIT_BITMASK, NULL, HFILL } 
+              FT_BOOLEAN, 16, NULL, ACMP_FLAG_STREAMING_WAIT_BITMASK, NULL, HFILL } 
         },
         /* ACMP Flags End */
         { &hf_acmp_default_format,
             { "Default Format", "ieee17221.default_format", 
               FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL } 
+        },
+        { &hf_acmp_response_in,
+            { "Response In", "ieee17221.acmp.response_in",
+              FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+              "The response to this command is in this frame", HFILL }
+        },
+        { &hf_acmp_response_to,
+            { "Request In", "ieee17221.acmp.response_to",
+              FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+              "This is a response to the command in this frame", HFILL }
+        },
+        { &hf_acmp_response_time,
+            { "Response Time", "ieee17221.acmp.response_time",
+              FT_RELATIVE_TIME, BASE_NONE, NULL, 0x00,
+              "Time between the command and its response", HFILL }
+        },
+        { &hf_acmp_retransmission_of,
+            { "Retransmission Of", "ieee17221.acmp.retransmission_of",
+              FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+              "Earlier command with the same sequence ID that got no response", HFILL }
+        },
+        { &hf_acmp_duplicate_of,
+            { "Duplicate Of", "ieee17221.acmp.duplicate_of",
+              FT_FRAMENUM, BASE_NONE, NULL, 0x00,
+              "The command was already answered in this frame", HFILL }
+        },
+        { &hf_acmp_no_response,
+            { "No Response", "ieee17221.acmp.no_response",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "No response to this command in the capture", HFILL }
+        },
+        { &hf_acmp_no_command,
+            { "No Command", "ieee17221.acmp.no_command",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "The command for this response is not in the capture", HFILL }
+        },
+        { &hf_acmp_late_response,
+            { "Late Response", "ieee17221.acmp.late_response",
+              FT_BOOLEAN, BASE_NONE, NULL, 0x00,
+              "Response arrived after the command timeout", HFILL }
+        },
+        /* AECP */
+        { &hf_aecp_message_type,
+            { "Message Type", "ieee17221.aecp.message_type",
+              FT_UINT8, BASE_DEC, VALS(aecp_message_type_vals), AECP_MSG_TYPE_MASK, NULL, HFILL }
+        },
+        { &hf_aecp_status_field,
+            { "Status", "ieee17221.aecp.status",
+              FT_UINT8, BASE_DEC, VALS(aem_status_vals), AECP_STATUS_FIELD_MASK, NULL, HFILL }
+        },
+        { &hf_aecp_cd_length,
+            { "Control Data Length", "ieee17221.aecp.control_data_length",
+              FT_UINT16, BASE_DEC, NULL, AECP_CD_LENGTH_MASK, NULL, HFILL }
+        },
+        { &hf_aecp_target_guid,
+            { "Target GUID", "ieee17221.aecp.target_guid",
+              FT_UINT64, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aecp_controller_guid,
+            { "Controller GUID", "ieee17221.aecp.controller_guid",
+              FT_UINT64, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aecp_sequence_id,
+            { "Sequence ID", "ieee17221.aecp.sequence_id",
+              FT_UINT16, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aecp_unsolicited,
+            { "Unsolicited", "ieee17221.aecp.unsolicited",
+              FT_BOOLEAN, 16, NULL, AECP_UNSOLICITED_MASK, NULL, HFILL }
+        },
+        { &hf_aecp_command_type,
+            { "Command Type", "ieee17221.aecp.command_type",
+              FT_UINT16, BASE_HEX, VALS(aem_command_type_vals), AECP_COMMAND_TYPE_MASK, NULL, HFILL }
+        },
+        { &hf_aecp_payload,
+            { "Payload", "ieee17221.aecp.payload",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        /* AEM command payloads */
+        { &hf_aem_descriptor_type,
+            { "Descriptor Type", "ieee17221.aem.descriptor_type",
+              FT_UINT16, BASE_HEX, VALS(aem_descriptor_type_vals), 0x00, NULL, HFILL }
+        },
+        { &hf_aem_descriptor_index,
+            { "Descriptor Index", "ieee17221.aem.descriptor_index",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_acquire_flags,
+            { "Flags", "ieee17221.aem.flags",
+              FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_owner_guid,
+            { "Owner GUID", "ieee17221.aem.owner_guid",
+              FT_UINT64, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_configuration_index,
+            { "Configuration Index", "ieee17221.aem.configuration_index",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_stream_format,
+            { "Stream Format", "ieee17221.aem.stream_format",
+              FT_UINT64, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_name_index,
+            { "Name Index", "ieee17221.aem.name_index",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_name,
+            { "Name", "ieee17221.aem.name",
+              FT_STRINGZ, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_sampling_rate,
+            { "Sampling Rate", "ieee17221.aem.sampling_rate",
+              FT_UINT32, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_clock_source_index,
+            { "Clock Source Index", "ieee17221.aem.clock_source_index",
+              FT_UINT16, BASE_DEC, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_counters_valid,
+            { "Counters Valid", "ieee17221.aem.counters_valid",
+              FT_UINT32, BASE_HEX, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_counters_block,
+            { "Counters Block", "ieee17221.aem.counters_block",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_entity_name,
+            { "Entity Name", "ieee17221.aem.entity_name",
+              FT_STRINGZ, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_object_name,
+            { "Object Name", "ieee17221.aem.object_name",
+              FT_STRINGZ, BASE_NONE, NULL, 0x00, NULL, HFILL }
+        },
+        { &hf_aem_descriptor_data,
+            { "Descriptor Data", "ieee17221.aem.descriptor_data",
+              FT_BYTES, BASE_NONE, NULL, 0x00, NULL, HFILL }
         }
     };
     
     /* Setup protocol subtree array */
     static gint *ett[] = {
+        &ett_adp,
         &ett_adp_ent_cap,
         &ett_adp_talk_cap,
         &ett_adp_list_cap,
@@ -1055,26 +2517,35 @@ void proto_register_17221(void)
         &ett_adp_aud_format,
         &ett_adp_samp_rates,
         &ett_adp_chan_format,
-        &ett_acmp_flags
+        &ett_adp_analysis,
+        &ett_adp_expiry,
+        &ett_acmp,
+        &ett_acmp_flags,
+        &ett_aecp,
+        &ett_aem_descriptor
     };
 
     /* Register the protocol name and description */
     proto_17221 = proto_register_protocol("IEEE 1722.1 Protocol", "IEEE1722.1", "ieee17221");
+    register_dissector("ieee17221", dissect_17221, proto_17221);
     
     /* Required function calls to register the header fields and subtrees used */
     proto_register_field_array(proto_17221, hf, array_length(hf));
     proto_register_subtree_array(ett, array_length(ett));
+
+    register_init_routine(ieee17221_init);
+
+    adp_tap = register_tap("ieee17221.adp");
+    acmp_tap = register_tap("ieee17221.acmp");
 }
 
 void proto_reg_handoff_17221(void) 
 {
 
     dissector_handle_t avb17221_handle;
-    
-    // avb17221_handle = find_dissector("ieee1722");
 
-    avb17221_handle = create_dissector_handle(dissect_17221, proto_17221);
-    dissector_add_uint("ieee1722.subtype", 0x7A, avb17221_handle);
-    dissector_add_uint("ieee1722.subtype", 0x7B, avb17221_handle);
-    dissector_add_uint("ieee1722.subtype", 0x7C, avb17221_handle);
+    avb17221_handle = find_dissector("ieee17221");
+    dissector_add_uint("ieee1722.subtype", 0xFA, avb17221_handle);
+    dissector_add_uint("ieee1722.subtype", 0xFB, avb17221_handle);
+    dissector_add_uint("ieee1722.subtype", 0xFC, avb17221_handle);
 }
@@ -0,0 +1,115 @@
+/* packet-ieee17221.h
+ * Definitions shared by the IEEE 1722.1 (AVDECC) dissector and its taps
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __PACKET_IEEE17221_H__
+#define __PACKET_IEEE17221_H__
+
+/* ADP message types */
+#define IEEE17221_ADP_ENTITY_AVAILABLE      0x00
+#define IEEE17221_ADP_ENTITY_DEPARTING      0x01
+#define IEEE17221_ADP_ENTITY_DISCOVER       0x02
+/* Tap-only pseudo message: an entity's valid_time ran out */
+#define IEEE17221_ADP_ENTITY_TIMEOUT        0xff
+
+/* Outcome of the per-entity ADP analysis, any combination */
+#define IEEE17221_ADP_NEW_ENTITY            0x01
+#define IEEE17221_ADP_REBOOT                0x02    /* available_index went backwards */
+#define IEEE17221_ADP_GUID_COLLISION        0x04    /* GUID announced by another station */
+#define IEEE17221_ADP_CAPS_CHANGED          0x08
+#define IEEE17221_ADP_REAPPEARED            0x10    /* announced again after timing out */
+
+/* Queued on the "ieee17221.adp" tap for every ADP frame, and once per
+ * entity found silently departed (message_type IEEE17221_ADP_ENTITY_TIMEOUT,
+ * only entity_guid and valid_time set)
+ */
+typedef struct _ieee17221_adp_tap_info {
+    guint8  message_type;
+    guint8  valid_time;         /* in 2 second units */
+    guint8  analysis;           /* IEEE17221_ADP_xxx */
+    guint64 entity_guid;
+    guint32 vendor_id;
+    guint32 model_id;
+    guint32 entity_cap;
+    guint16 talker_stream_sources;
+    guint16 talker_cap;
+    guint16 listener_stream_sinks;
+    guint16 listener_cap;
+    guint32 controller_cap;
+    guint32 available_index;
+    guint32 previous_index;     /* before a reboot */
+} ieee17221_adp_tap_info_t;
+
+/* Outcome of the ACMP command/response matching, any combination */
+#define IEEE17221_ACMP_RETRANSMISSION       0x01    /* command repeated before any response */
+#define IEEE17221_ACMP_NO_COMMAND           0x02    /* response to a command not in the capture */
+#define IEEE17221_ACMP_DUPLICATE_RESPONSE   0x04
+#define IEEE17221_ACMP_LATE_RESPONSE        0x08    /* answered after the command timeout */
+
+/* Queued on the "ieee17221.acmp" tap for every ACMP frame */
+typedef struct _ieee17221_acmp_tap_info {
+    guint8  message_type;
+    guint8  status;
+    guint8  analysis;           /* IEEE17221_ACMP_xxx */
+    guint64 stream_id;
+    guint64 controller_guid;
+    guint64 talker_guid;
+    guint64 listener_guid;
+    guint16 talker_unique_id;
+    guint16 listener_unique_id;
+    guint8  stream_dest_mac[6];
+    guint16 connection_count;
+    guint16 sequence_id;
+    guint16 flags;
+    guint32 request_frame;      /* responses: matching command, or 0 if none
+                                   or not analysed */
+    nstime_t response_time;     /* valid when request_frame is set */
+    guint32 timeout_ms;         /* for the command type */
+} ieee17221_acmp_tap_info_t;
+
+/* ADP validity timers run on capture time, whatever the frame: the 1722
+ * dissector advances them on the first pass of every AVTPDU, before
+ * dissecting it, and reports the entities that ran out at that frame
+ * (expert info and an IEEE17221_ADP_ENTITY_TIMEOUT tap) after it.
+ */
+extern void ieee17221_adp_advance(packet_info *pinfo);
+extern void ieee17221_adp_add_expiries(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree);
+
+/* Talker of a stream, as learned from ACMP responses.  The names come
+ * from the talker's ENTITY and STREAM_OUTPUT descriptors when AECP has
+ * shown them, else they are NULL.
+ */
+typedef struct _ieee17221_stream_talker {
+    guint64 stream_id;
+    guint64 talker_guid;
+    guint16 talker_unique_id;
+    gboolean class_b;           /* SR class B, else A */
+    const gchar *entity_name;
+    const gchar *stream_name;
+} ieee17221_stream_talker_t;
+
+/* One hash lookup, three if the state tables have changed since, and no
+ * allocation; NULL if no ACMP response so far in the capture has named
+ * the stream's talker, or its record was evicted.  Valid until the next
+ * frame is dissected. */
+extern const ieee17221_stream_talker_t *ieee17221_stream_talker(guint64 stream_id);
+
+#endif /* __PACKET_IEEE17221_H__ */
@@ -0,0 +1,499 @@
+/* tap-acmpgraph.c
+ * ACMP stream connection graph for tshark
+ * ("-z acmp,graph[,report|dot|json][,filter]")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/packet-ieee17221.h>
+
+/* ACMP message types and status used to drive the model */
+#define ACMP_CONNECT_TX_RESPONSE        1
+#define ACMP_DISCONNECT_TX_RESPONSE     3
+#define ACMP_GET_TX_STATE_RESPONSE      5
+#define ACMP_CONNECT_RX_RESPONSE        7
+#define ACMP_DISCONNECT_RX_RESPONSE     9
+#define ACMP_GET_RX_STATE_RESPONSE      11
+#define ACMP_STATUS_SUCCESS             0
+
+enum {
+    ACMP_GRAPH_REPORT,
+    ACMP_GRAPH_DOT,
+    ACMP_GRAPH_JSON
+};
+
+/* A talker stream source or a listener stream sink */
+typedef struct _acmp_endpoint {
+    guint64 guid;
+    guint16 unique_id;
+} acmp_endpoint_t;
+
+/* One talker -> listener connection over the interval it existed.
+ * Appended when a listener connects and closed when it disconnects, so
+ * the edge list is the time index of the graph.
+ */
+typedef struct _acmp_edge {
+    acmp_endpoint_t talker;
+    acmp_endpoint_t listener;
+    guint64 stream_id;
+    guint8  dest_mac[6];
+    gint64  start_ns;
+    gint64  end_ns;
+    guint32 start_frame;
+    guint32 end_frame;          /* 0 while still connected */
+} acmp_edge_t;
+
+typedef struct _acmp_sink {
+    acmp_endpoint_t listener;
+    acmp_edge_t *edge;          /* current connection, or NULL */
+} acmp_sink_t;
+
+typedef struct _acmp_source {
+    acmp_endpoint_t talker;
+    guint64 stream_id;
+    guint8  dest_mac[6];
+    gboolean reported;          /* a TX response gave connection_count */
+    guint16 connection_count;   /* as last reported by the talker */
+    guint16 listeners;          /* connected sinks in the model */
+} acmp_source_t;
+
+typedef struct _acmpgraph_t {
+    char       *filter;
+    int         format;
+    GHashTable *sinks;
+    GHashTable *sources;
+    GPtrArray  *edges;
+    gint64      start_ns;
+    gint64      last_ns;
+    gboolean    started;
+    guint32     connects;
+    guint32     disconnects;
+    guint32     implicit_disconnects;   /* sink moved to another talker */
+    guint32     failures;
+    guint32     refreshes;              /* GET_RX_STATE agreeing with the model */
+} acmpgraph_t;
+
+static guint
+acmp_endpoint_hash(gconstpointer v)
+{
+    const acmp_endpoint_t *ep = v;
+
+    return (guint)ep->guid ^ (guint)(ep->guid >> 32) ^ ep->unique_id;
+}
+
+static gboolean
+acmp_endpoint_equal(gconstpointer v1, gconstpointer v2)
+{
+    const acmp_endpoint_t *e1 = v1;
+    const acmp_endpoint_t *e2 = v2;
+
+    return e1->guid == e2->guid && e1->unique_id == e2->unique_id;
+}
+
+static void
+acmpgraph_reset(void *arg)
+{
+    acmpgraph_t *ag = arg;
+    guint i;
+
+    g_hash_table_remove_all(ag->sinks);
+    g_hash_table_remove_all(ag->sources);
+    for (i = 0; i < ag->edges->len; i++)
+        g_free(g_ptr_array_index(ag->edges, i));
+    g_ptr_array_set_size(ag->edges, 0);
+    ag->started = FALSE;
+    ag->connects = 0;
+    ag->disconnects = 0;
+    ag->implicit_disconnects = 0;
+    ag->failures = 0;
+    ag->refreshes = 0;
+}
+
+static acmp_source_t *
+acmpgraph_source(acmpgraph_t *ag, guint64 guid, guint16 unique_id)
+{
+    acmp_endpoint_t key;
+    acmp_source_t *src;
+
+    memset(&key, 0, sizeof(key));
+    key.guid = guid;
+    key.unique_id = unique_id;
+    src = g_hash_table_lookup(ag->sources, &key);
+    if (src == NULL) {
+        src = g_new0(acmp_source_t, 1);
+        src->talker = key;
+        g_hash_table_insert(ag->sources, &src->talker, src);
+    }
+    return src;
+}
+
+static void
+acmpgraph_disconnect(acmpgraph_t *ag, acmp_sink_t *sink, gint64 now_ns, guint32 frame)
+{
+    acmp_source_t *src;
+
+    sink->edge->end_ns = now_ns;
+    sink->edge->end_frame = frame;
+    src = acmpgraph_source(ag, sink->edge->talker.guid, sink->edge->talker.unique_id);
+    if (src->listeners)
+        src->listeners--;
+    sink->edge = NULL;
+}
+
+static void
+acmpgraph_connect(acmpgraph_t *ag, acmp_sink_t *sink, const ieee17221_acmp_tap_info_t *info,
+                  gint64 now_ns, guint32 frame)
+{
+    acmp_edge_t *edge;
+    acmp_source_t *src;
+
+    edge = g_new0(acmp_edge_t, 1);
+    edge->talker.guid = info->talker_guid;
+    edge->talker.unique_id = info->talker_unique_id;
+    edge->listener = sink->listener;
+    edge->stream_id = info->stream_id;
+    memcpy(edge->dest_mac, info->stream_dest_mac, 6);
+    edge->start_ns = now_ns;
+    edge->start_frame = frame;
+    g_ptr_array_add(ag->edges, edge);
+    sink->edge = edge;
+
+    src = acmpgraph_source(ag, info->talker_guid, info->talker_unique_id);
+    src->listeners++;
+    src->stream_id = info->stream_id;
+    memcpy(src->dest_mac, info->stream_dest_mac, 6);
+}
+
+/* Apply one listener state change: connected to the talker named in the
+ * response, or not connected at all
+ */
+static void
+acmpgraph_update_sink(acmpgraph_t *ag, const ieee17221_acmp_tap_info_t *info, gboolean connected,
+                      gint64 now_ns, guint32 frame)
+{
+    acmp_endpoint_t key;
+    acmp_sink_t *sink;
+
+    memset(&key, 0, sizeof(key));
+    key.guid = info->listener_guid;
+    key.unique_id = info->listener_unique_id;
+    sink = g_hash_table_lookup(ag->sinks, &key);
+    if (sink == NULL) {
+        sink = g_new0(acmp_sink_t, 1);
+        sink->listener = key;
+        g_hash_table_insert(ag->sinks, &sink->listener, sink);
+    }
+
+    if (sink->edge && connected &&
+        sink->edge->talker.guid == info->talker_guid &&
+        sink->edge->talker.unique_id == info->talker_unique_id &&
+        sink->edge->stream_id == info->stream_id) {
+        ag->refreshes++;
+        return;
+    }
+
+    if (sink->edge) {
+        acmpgraph_disconnect(ag, sink, now_ns, frame);
+        if (connected)
+            ag->implicit_disconnects++;
+        else
+            ag->disconnects++;
+    }
+    if (connected) {
+        acmpgraph_connect(ag, sink, info, now_ns, frame);
+        ag->connects++;
+    }
+}
+
+static int
+acmpgraph_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    acmpgraph_t *ag = arg;
+    const ieee17221_acmp_tap_info_t *info = data;
+    acmp_source_t *src;
+    gint64 now_ns;
+
+    now_ns = (gint64)pinfo->fd->abs_ts.secs * 1000000000 + pinfo->fd->abs_ts.nsecs;
+    if (!ag->started) {
+        ag->start_ns = now_ns;
+        ag->started = TRUE;
+    }
+    ag->last_ns = now_ns;
+
+    /* Only responses say what actually happened */
+    if ((info->message_type & 1) == 0 || (info->analysis & IEEE17221_ACMP_DUPLICATE_RESPONSE))
+        return 0;
+    if (info->status != ACMP_STATUS_SUCCESS) {
+        if (info->message_type == ACMP_CONNECT_RX_RESPONSE)
+            ag->failures++;
+        return 1;
+    }
+
+    switch (info->message_type) {
+    case ACMP_CONNECT_RX_RESPONSE:
+        acmpgraph_update_sink(ag, info, TRUE, now_ns, pinfo->fd->num);
+        break;
+    case ACMP_DISCONNECT_RX_RESPONSE:
+        acmpgraph_update_sink(ag, info, FALSE, now_ns, pinfo->fd->num);
+        break;
+    case ACMP_GET_RX_STATE_RESPONSE:
+        acmpgraph_update_sink(ag, info, info->connection_count != 0, now_ns, pinfo->fd->num);
+        break;
+    case ACMP_CONNECT_TX_RESPONSE:
+    case ACMP_DISCONNECT_TX_RESPONSE:
+    case ACMP_GET_TX_STATE_RESPONSE:
+        src = acmpgraph_source(ag, info->talker_guid, info->talker_unique_id);
+        src->reported = TRUE;
+        src->connection_count = info->connection_count;
+        if (info->message_type != ACMP_DISCONNECT_TX_RESPONSE) {
+            src->stream_id = info->stream_id;
+            memcpy(src->dest_mac, info->stream_dest_mac, 6);
+        }
+        break;
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+static void
+acmp_collect(gpointer key _U_, gpointer value, gpointer user_data)
+{
+    g_ptr_array_add((GPtrArray *)user_data, value);
+}
+
+static gint
+acmp_source_compare(gconstpointer a, gconstpointer b)
+{
+    const acmp_source_t *sa = *(const acmp_source_t * const *)a;
+    const acmp_source_t *sb = *(const acmp_source_t * const *)b;
+
+    if (sa->talker.guid != sb->talker.guid)
+        return sa->talker.guid < sb->talker.guid ? -1 : 1;
+    return (gint)sa->talker.unique_id - (gint)sb->talker.unique_id;
+}
+
+static const char *
+acmp_mac_str(const guint8 *mac)
+{
+    static char buf[18];
+
+    g_snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+               mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return buf;
+}
+
+static void
+acmpgraph_draw_report(acmpgraph_t *ag)
+{
+    GPtrArray *sorted;
+    guint i;
+    guint open = 0;
+    char count[8];
+
+    for (i = 0; i < ag->edges->len; i++)
+        if (((acmp_edge_t *)g_ptr_array_index(ag->edges, i))->end_frame == 0)
+            open++;
+
+    printf("\n");
+    printf("=====================================================================================================\n");
+    printf("ACMP Connection Graph:\n");
+    if (ag->filter)
+        printf("Filter: %s\n", ag->filter);
+    printf("%u connects, %u disconnects, %u implicit disconnects, %u failed connects, %u state refreshes\n",
+           ag->connects, ag->disconnects, ag->implicit_disconnects, ag->failures, ag->refreshes);
+    printf("%u connections over the capture, %u still connected at %.3f s\n\n",
+           ag->edges->len, open, (ag->last_ns - ag->start_ns) / 1e9);
+
+    sorted = g_ptr_array_new();
+    g_hash_table_foreach(ag->sources, acmp_collect, sorted);
+    g_ptr_array_sort(sorted, acmp_source_compare);
+
+    printf("Talker GUID         Src  Stream ID           Dest MAC           Conn.Count  Listeners\n");
+    for (i = 0; i < sorted->len; i++) {
+        acmp_source_t *src = g_ptr_array_index(sorted, i);
+
+        /* Sources only seen in RX responses have no count to compare */
+        if (src->reported)
+            g_snprintf(count, sizeof(count), "%u", src->connection_count);
+        else
+            g_strlcpy(count, "-", sizeof(count));
+        printf("0x%016" G_GINT64_MODIFIER "x %4u  0x%016" G_GINT64_MODIFIER "x %s %11s %10u%s\n",
+               src->talker.guid, src->talker.unique_id, src->stream_id,
+               acmp_mac_str(src->dest_mac), count, src->listeners,
+               src->reported && src->connection_count != src->listeners ? "  (mismatch)" : "");
+    }
+
+    printf("\nConnected at end of capture:\n");
+    printf("Talker GUID         Src  Listener GUID       Sink  Stream ID            Since(s)  Frame\n");
+    for (i = 0; i < ag->edges->len; i++) {
+        acmp_edge_t *edge = g_ptr_array_index(ag->edges, i);
+
+        if (edge->end_frame)
+            continue;
+        printf("0x%016" G_GINT64_MODIFIER "x %4u  0x%016" G_GINT64_MODIFIER "x %4u  0x%016" G_GINT64_MODIFIER "x %11.3f %6u\n",
+               edge->talker.guid, edge->talker.unique_id,
+               edge->listener.guid, edge->listener.unique_id, edge->stream_id,
+               (edge->start_ns - ag->start_ns) / 1e9, edge->start_frame);
+    }
+    printf("=====================================================================================================\n");
+
+    g_ptr_array_free(sorted, TRUE);
+}
+
+/* Every connection becomes an edge labelled with its stream and lifetime;
+ * closed ones are dashed
+ */
+static void
+acmpgraph_draw_dot(acmpgraph_t *ag)
+{
+    guint i;
+
+    printf("digraph acmp {\n");
+    printf("    rankdir=LR;\n");
+    for (i = 0; i < ag->edges->len; i++) {
+        acmp_edge_t *edge = g_ptr_array_index(ag->edges, i);
+
+        printf("    \"talker 0x%016" G_GINT64_MODIFIER "x:%u\" -> \"listener 0x%016" G_GINT64_MODIFIER "x:%u\" "
+               "[label=\"0x%016" G_GINT64_MODIFIER "x\\n%.6f-",
+               edge->talker.guid, edge->talker.unique_id,
+               edge->listener.guid, edge->listener.unique_id,
+               edge->stream_id, (edge->start_ns - ag->start_ns) / 1e9);
+        if (edge->end_frame)
+            printf("%.6f s\", style=dashed];\n", (edge->end_ns - ag->start_ns) / 1e9);
+        else
+            printf(" s\"];\n");
+    }
+    printf("}\n");
+}
+
+static void
+acmpgraph_draw_json(acmpgraph_t *ag)
+{
+    guint i;
+
+    printf("{\"start_time\": %.9f, \"end_time\": %.9f, \"connections\": [",
+           ag->start_ns / 1e9, ag->last_ns / 1e9);
+    for (i = 0; i < ag->edges->len; i++) {
+        acmp_edge_t *edge = g_ptr_array_index(ag->edges, i);
+
+        printf("%s\n  {\"talker\": \"0x%016" G_GINT64_MODIFIER "x\", \"talker_unique_id\": %u, "
+               "\"listener\": \"0x%016" G_GINT64_MODIFIER "x\", \"listener_unique_id\": %u, "
+               "\"stream_id\": \"0x%016" G_GINT64_MODIFIER "x\", \"dest_mac\": \"%s\", "
+               "\"start\": %.9f, \"start_frame\": %u, ",
+               i ? "," : "", edge->talker.guid, edge->talker.unique_id,
+               edge->listener.guid, edge->listener.unique_id, edge->stream_id,
+               acmp_mac_str(edge->dest_mac), (edge->start_ns - ag->start_ns) / 1e9,
+               edge->start_frame);
+        if (edge->end_frame)
+            printf("\"end\": %.9f, \"end_frame\": %u}", (edge->end_ns - ag->start_ns) / 1e9,
+                   edge->end_frame);
+        else
+            printf("\"end\": null, \"end_frame\": null}");
+    }
+    printf("\n]}\n");
+}
+
+static void
+acmpgraph_draw(void *arg)
+{
+    acmpgraph_t *ag = arg;
+
+    switch (ag->format) {
+    case ACMP_GRAPH_DOT:
+        acmpgraph_draw_dot(ag);
+        break;
+    case ACMP_GRAPH_JSON:
+        acmpgraph_draw_json(ag);
+        break;
+    default:
+        acmpgraph_draw_report(ag);
+        break;
+    }
+}
+
+static void
+acmpgraph_init(const char *optarg, void *userdata _U_)
+{
+    acmpgraph_t *ag;
+    const char *args = NULL;
+    GString *error_string;
+
+    ag = g_new0(acmpgraph_t, 1);
+    if (strncmp(optarg, "acmp,graph,", 11) == 0)
+        args = optarg + 11;
+    if (args) {
+        static const struct { const char *name; int format; } formats[] = {
+            { "report", ACMP_GRAPH_REPORT },
+            { "dot",    ACMP_GRAPH_DOT },
+            { "json",   ACMP_GRAPH_JSON }
+        };
+        guint i;
+
+        for (i = 0; i < G_N_ELEMENTS(formats); i++) {
+            size_t len = strlen(formats[i].name);
+
+            if (strncmp(args, formats[i].name, len) == 0 && (args[len] == '\0' || args[len] == ',')) {
+                ag->format = formats[i].format;
+                args = args[len] ? args + len + 1 : NULL;
+                break;
+            }
+        }
+    }
+    if (args && *args)
+        ag->filter = g_strdup(args);
+    ag->sinks = g_hash_table_new_full(acmp_endpoint_hash, acmp_endpoint_equal, NULL, g_free);
+    ag->sources = g_hash_table_new_full(acmp_endpoint_hash, acmp_endpoint_equal, NULL, g_free);
+    ag->edges = g_ptr_array_new();
+
+    error_string = register_tap_listener("ieee17221.acmp", ag, ag->filter, 0,
+                                         acmpgraph_reset, acmpgraph_packet, acmpgraph_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_free(ag->filter);
+        g_hash_table_destroy(ag->sinks);
+        g_hash_table_destroy(ag->sources);
+        g_ptr_array_free(ag->edges, TRUE);
+        g_free(ag);
+
+        fprintf(stderr, "tshark: Couldn't register acmp,graph tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+void
+register_tap_listener_acmpgraph(void)
+{
+    register_stat_cmd_arg("acmp,graph", acmpgraph_init, NULL);
+}
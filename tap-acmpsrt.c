@@ -0,0 +1,189 @@
+/* tap-acmpsrt.c
+ * ACMP command service response times for tshark ("-z acmp,srt[,filter]")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/packet-ieee17221.h>
+
+/* One row per ACMP command type, indexed by message_type / 2 */
+#define ACMP_SRT_COMMANDS   7
+
+static const char *acmp_srt_command_names[ACMP_SRT_COMMANDS] = {
+    "CONNECT_TX",
+    "DISCONNECT_TX",
+    "GET_TX_STATE",
+    "CONNECT_RX",
+    "DISCONNECT_RX",
+    "GET_RX_STATE",
+    "GET_TX_CONNECTION"
+};
+
+typedef struct _acmp_srt_stats {
+    guint32 commands;
+    guint32 retransmissions;
+    guint32 responses;          /* first response to a command in the capture */
+    guint32 failures;           /* ... with a status other than SUCCESS */
+    guint32 late;
+    guint32 duplicates;
+    guint32 no_command;
+    guint32 timeout_ms;
+    nstime_t min;
+    nstime_t max;
+    gdouble total_ms;
+} acmp_srt_stats_t;
+
+typedef struct _acmpsrt_t {
+    char *filter;
+    acmp_srt_stats_t stats[ACMP_SRT_COMMANDS];
+} acmpsrt_t;
+
+static void
+acmpsrt_reset(void *arg)
+{
+    acmpsrt_t *as = arg;
+
+    memset(as->stats, 0, sizeof(as->stats));
+}
+
+static gboolean
+nstime_less(const nstime_t *a, const nstime_t *b)
+{
+    return a->secs < b->secs || (a->secs == b->secs && a->nsecs < b->nsecs);
+}
+
+static int
+acmpsrt_packet(void *arg, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *data)
+{
+    acmpsrt_t *as = arg;
+    const ieee17221_acmp_tap_info_t *info = data;
+    acmp_srt_stats_t *st;
+
+    if ((info->message_type >> 1) >= ACMP_SRT_COMMANDS)
+        return 0;
+    st = &as->stats[info->message_type >> 1];
+    st->timeout_ms = info->timeout_ms;
+
+    if ((info->message_type & 1) == 0) {
+        st->commands++;
+        if (info->analysis & IEEE17221_ACMP_RETRANSMISSION)
+            st->retransmissions++;
+        return 1;
+    }
+
+    if (info->analysis & IEEE17221_ACMP_NO_COMMAND) {
+        st->no_command++;
+        return 1;
+    }
+    if (info->analysis & IEEE17221_ACMP_DUPLICATE_RESPONSE) {
+        st->duplicates++;
+        return 1;
+    }
+    /* Revisited without the first pass's results: not analysed */
+    if (info->request_frame == 0)
+        return 0;
+
+    if (st->responses == 0 || nstime_less(&info->response_time, &st->min))
+        st->min = info->response_time;
+    if (st->responses == 0 || nstime_less(&st->max, &info->response_time))
+        st->max = info->response_time;
+    st->total_ms += nstime_to_msec(&info->response_time);
+    st->responses++;
+    if (info->status != 0)
+        st->failures++;
+    if (info->analysis & IEEE17221_ACMP_LATE_RESPONSE)
+        st->late++;
+
+    return 1;
+}
+
+static void
+acmpsrt_draw(void *arg)
+{
+    acmpsrt_t *as = arg;
+    guint i;
+
+    printf("\n");
+    printf("====================================================================================================================\n");
+    printf("ACMP SRT Statistics:\n");
+    if (as->filter)
+        printf("Filter: %s\n", as->filter);
+    printf("Command            Timeout(ms)  Commands  Retries  Unanswered  Responses  Failed  Late  Dup  No cmd   Min SRT(ms)   Max SRT(ms)   Avg SRT(ms)\n");
+    for (i = 0; i < ACMP_SRT_COMMANDS; i++) {
+        acmp_srt_stats_t *st = &as->stats[i];
+        /* Retransmissions share the transaction of the command they repeat */
+        guint32 transactions = st->commands - st->retransmissions;
+
+        if (st->commands == 0 && st->responses == 0 && st->duplicates == 0 && st->no_command == 0)
+            continue;
+        printf("%-18s %11u %9u %8u %11u %10u %7u %5u %4u %7u",
+               acmp_srt_command_names[i], st->timeout_ms, st->commands, st->retransmissions,
+               transactions > st->responses ? transactions - st->responses : 0,
+               st->responses, st->failures, st->late, st->duplicates, st->no_command);
+        if (st->responses)
+            printf(" %13.3f %13.3f %13.3f\n", nstime_to_msec(&st->min), nstime_to_msec(&st->max),
+                   st->total_ms / st->responses);
+        else
+            printf("\n");
+    }
+    printf("====================================================================================================================\n");
+}
+
+static void
+acmpsrt_init(const char *optarg, void *userdata _U_)
+{
+    acmpsrt_t *as;
+    GString *error_string;
+
+    as = g_new0(acmpsrt_t, 1);
+    if (strncmp(optarg, "acmp,srt,", 9) == 0)
+        as->filter = g_strdup(optarg + 9);
+
+    error_string = register_tap_listener("ieee17221.acmp", as, as->filter, 0,
+                                         acmpsrt_reset, acmpsrt_packet, acmpsrt_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_free(as->filter);
+        g_free(as);
+
+        fprintf(stderr, "tshark: Couldn't register acmp,srt tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+void
+register_tap_listener_acmpsrt(void)
+{
+    register_stat_cmd_arg("acmp,srt", acmpsrt_init, NULL);
+}
@@ -0,0 +1,237 @@
+/* tap-adpentities.c
+ * AVDECC entity inventory for tshark ("-z adp,entities[,filter]")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/packet-ieee17221.h>
+
+/* Per-entity summary, one pass over the capture */
+typedef struct _adp_entity_stats {
+    guint64 entity_guid;
+    guint32 vendor_id;
+    guint32 model_id;
+    guint32 entity_cap;
+    guint16 talker_stream_sources;
+    guint16 talker_cap;
+    guint16 listener_stream_sinks;
+    guint16 listener_cap;
+    guint32 controller_cap;
+    guint32 available_index;
+    guint8  valid_time;
+    gboolean departed;
+    guint32 first_frame;
+    gint64  first_ns;
+    gint64  last_ns;
+    guint32 available;
+    guint32 departing;
+    guint32 reboots;
+    guint32 collisions;
+    guint32 caps_changes;
+    guint32 timeouts;
+    gboolean timed_out;
+} adp_entity_stats_t;
+
+typedef struct _adpentities_t {
+    char       *filter;
+    GHashTable *entities;
+    gint64      start_ns;
+    gboolean    started;
+} adpentities_t;
+
+static void
+adpentities_reset(void *arg)
+{
+    adpentities_t *ae = arg;
+
+    g_hash_table_remove_all(ae->entities);
+    ae->started = FALSE;
+}
+
+static int
+adpentities_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    adpentities_t *ae = arg;
+    const ieee17221_adp_tap_info_t *info = data;
+    adp_entity_stats_t *st;
+    gint64 now_ns;
+
+    if (info->message_type == IEEE17221_ADP_ENTITY_DISCOVER)
+        return 0;
+
+    now_ns = (gint64)pinfo->fd->abs_ts.secs * 1000000000 + pinfo->fd->abs_ts.nsecs;
+    if (!ae->started) {
+        ae->start_ns = now_ns;
+        ae->started = TRUE;
+    }
+
+    st = g_hash_table_lookup(ae->entities, &info->entity_guid);
+    if (st == NULL) {
+        st = g_new0(adp_entity_stats_t, 1);
+        st->entity_guid = info->entity_guid;
+        st->first_frame = pinfo->fd->num;
+        st->first_ns = now_ns;
+        g_hash_table_insert(ae->entities, &st->entity_guid, st);
+    }
+
+    if (info->message_type == IEEE17221_ADP_ENTITY_TIMEOUT) {
+        st->timeouts++;
+        st->departed = TRUE;
+        st->timed_out = TRUE;
+        return 1;
+    }
+
+    if (info->analysis & IEEE17221_ADP_GUID_COLLISION) {
+        /* Someone else's announcement; keep the owner's details */
+        st->collisions++;
+        return 1;
+    }
+
+    st->last_ns = now_ns;
+    st->vendor_id = info->vendor_id;
+    st->model_id = info->model_id;
+    if (info->analysis & IEEE17221_ADP_REBOOT)
+        st->reboots++;
+    if (info->analysis & IEEE17221_ADP_CAPS_CHANGED)
+        st->caps_changes++;
+
+    st->timed_out = FALSE;
+    if (info->message_type == IEEE17221_ADP_ENTITY_DEPARTING) {
+        st->departing++;
+        st->departed = TRUE;
+        return 1;
+    }
+
+    st->available++;
+    st->departed = FALSE;
+    st->valid_time = info->valid_time;
+    st->entity_cap = info->entity_cap;
+    st->talker_stream_sources = info->talker_stream_sources;
+    st->talker_cap = info->talker_cap;
+    st->listener_stream_sinks = info->listener_stream_sinks;
+    st->listener_cap = info->listener_cap;
+    st->controller_cap = info->controller_cap;
+    st->available_index = info->available_index;
+
+    return 1;
+}
+
+static gint
+adp_entity_compare(gconstpointer a, gconstpointer b)
+{
+    const adp_entity_stats_t *ea = *(const adp_entity_stats_t * const *)a;
+    const adp_entity_stats_t *eb = *(const adp_entity_stats_t * const *)b;
+
+    if (ea->entity_guid == eb->entity_guid)
+        return 0;
+    return ea->entity_guid < eb->entity_guid ? -1 : 1;
+}
+
+static void
+adp_entity_collect(gpointer key _U_, gpointer value, gpointer user_data)
+{
+    g_ptr_array_add((GPtrArray *)user_data, value);
+}
+
+static void
+adpentities_draw(void *arg)
+{
+    adpentities_t *ae = arg;
+    GPtrArray *sorted;
+    guint32 reboots = 0;
+    guint32 collisions = 0;
+    guint32 timeouts = 0;
+    guint i;
+
+    sorted = g_ptr_array_new();
+    g_hash_table_foreach(ae->entities, adp_entity_collect, sorted);
+    g_ptr_array_sort(sorted, adp_entity_compare);
+
+    printf("\n");
+    printf("============================================================================================================================================\n");
+    printf("ADP Entities:\n");
+    if (ae->filter)
+        printf("Filter: %s\n", ae->filter);
+    printf("Entity GUID         Vendor ID  Model ID   EntityCap  Src TalkCap Sink ListCap ContCap     First(s)     Last(s)  Avail  Dep  T/O   Index   Boot  Coll  Caps\n");
+    for (i = 0; i < sorted->len; i++) {
+        adp_entity_stats_t *st = g_ptr_array_index(sorted, i);
+
+        reboots += st->reboots;
+        collisions += st->collisions;
+        timeouts += st->timeouts;
+        printf("0x%016" G_GINT64_MODIFIER "x  0x%08x 0x%08x 0x%08x %4u  0x%04x %4u  0x%04x 0x%08x %11.3f %11.3f %6u %4u %4u %7u %6u %5u %5u%s\n",
+               st->entity_guid, st->vendor_id, st->model_id, st->entity_cap,
+               st->talker_stream_sources, st->talker_cap,
+               st->listener_stream_sinks, st->listener_cap, st->controller_cap,
+               (st->first_ns - ae->start_ns) / 1e9, (st->last_ns - ae->start_ns) / 1e9,
+               st->available, st->departing, st->timeouts, st->available_index,
+               st->reboots, st->collisions, st->caps_changes,
+               st->timed_out ? " (timed out)" : st->departed ? " (departed)" : "");
+    }
+    printf("\n%u entities, %u reboots, %u GUID collisions, %u silent departures\n",
+           sorted->len, reboots, collisions, timeouts);
+    printf("============================================================================================================================================\n");
+
+    g_ptr_array_free(sorted, TRUE);
+}
+
+static void
+adpentities_init(const char *optarg, void *userdata _U_)
+{
+    adpentities_t *ae;
+    GString *error_string;
+
+    ae = g_new0(adpentities_t, 1);
+    if (strncmp(optarg, "adp,entities,", 13) == 0)
+        ae->filter = g_strdup(optarg + 13);
+    ae->entities = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, g_free);
+
+    error_string = register_tap_listener("ieee17221.adp", ae, ae->filter, 0,
+                                         adpentities_reset, adpentities_packet, adpentities_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_free(ae->filter);
+        g_hash_table_destroy(ae->entities);
+        g_free(ae);
+
+        fprintf(stderr, "tshark: Couldn't register adp,entities tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+void
+register_tap_listener_adpentities(void)
+{
+    register_stat_cmd_arg("adp,entities", adpentities_init, NULL);
+}
@@ -0,0 +1,190 @@
+/* tap-avtpindex.c
+ * Write a sidecar index of the frames of each AVTP stream, AVDECC entity
+ * and AVTP subtype for tshark ("-z avtp,index,<file>")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Stream data frames are indexed by stream ID and subtype, ADP frames by
+ * entity GUID and ACMP frames by the controller, talker and listener
+ * GUIDs they carry.  Frames no tap sees (AECP, MAAP) are not indexed.
+ * The file format is described in ieee1722-index.h.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/packet-ieee1722.h>
+#include <epan/dissectors/packet-ieee17221.h>
+#include <epan/dissectors/ieee1722-index.h>
+
+typedef struct _avtpindex_t {
+    char    *filename;
+    ieee1722_index_builder_t *builder;
+    guint32  first_frame;
+    guint32  last_frame;
+    nstime_t first_ts;
+    gboolean written;
+} avtpindex_t;
+
+static void
+avtpindex_reset(void *arg)
+{
+    avtpindex_t *ai = arg;
+
+    /* All three listeners share the index; rebuild it only once */
+    ai->written = FALSE;
+    if (ai->last_frame == 0)
+        return;
+    ieee1722_index_builder_free(ai->builder);
+    ai->builder = ieee1722_index_builder_new();
+    ai->first_frame = 0;
+    ai->last_frame = 0;
+}
+
+static void
+avtpindex_frame(avtpindex_t *ai, packet_info *pinfo)
+{
+    if (ai->first_frame == 0) {
+        ai->first_frame = pinfo->fd->num;
+        ai->first_ts = pinfo->fd->abs_ts;
+    }
+    ai->last_frame = pinfo->fd->num;
+}
+
+static int
+avtpindex_stream_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    avtpindex_t *ai = arg;
+    const ieee1722_tap_info_t *info = data;
+
+    avtpindex_frame(ai, pinfo);
+    ieee1722_index_add(ai->builder, IEEE1722_INDEX_STREAM, info->stream_id, pinfo->fd->num);
+    ieee1722_index_add(ai->builder, IEEE1722_INDEX_SUBTYPE, info->subtype, pinfo->fd->num);
+    return 0;
+}
+
+static int
+avtpindex_adp_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    avtpindex_t *ai = arg;
+    const ieee17221_adp_tap_info_t *info = data;
+
+    /* Timeouts are queued on whatever frame found them, which is not the entity's */
+    if (info->message_type == IEEE17221_ADP_ENTITY_TIMEOUT)
+        return 0;
+    avtpindex_frame(ai, pinfo);
+    ieee1722_index_add(ai->builder, IEEE1722_INDEX_ENTITY, info->entity_guid, pinfo->fd->num);
+    return 0;
+}
+
+static int
+avtpindex_acmp_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    avtpindex_t *ai = arg;
+    const ieee17221_acmp_tap_info_t *info = data;
+
+    avtpindex_frame(ai, pinfo);
+    if (info->controller_guid != 0)
+        ieee1722_index_add(ai->builder, IEEE1722_INDEX_ENTITY, info->controller_guid, pinfo->fd->num);
+    if (info->talker_guid != 0)
+        ieee1722_index_add(ai->builder, IEEE1722_INDEX_ENTITY, info->talker_guid, pinfo->fd->num);
+    if (info->listener_guid != 0)
+        ieee1722_index_add(ai->builder, IEEE1722_INDEX_ENTITY, info->listener_guid, pinfo->fd->num);
+    return 0;
+}
+
+static void
+avtpindex_draw(void *arg)
+{
+    avtpindex_t *ai = arg;
+
+    /* Called once per listener; write the index for the first */
+    if (ai->written)
+        return;
+    ai->written = TRUE;
+
+    ieee1722_index_set_capture(ai->builder, ai->first_frame, ai->last_frame,
+                               (guint64)ai->first_ts.secs, ai->first_ts.nsecs);
+
+    printf("\n");
+    printf("===================================================================\n");
+    if (!ieee1722_index_write(ai->builder, ai->filename))
+        printf("AVTP stream index: can't write %s: %s\n", ai->filename, g_strerror(errno));
+    else
+        printf("AVTP stream index of frames %u-%u, %u keys, written to %s\n",
+               ai->first_frame, ai->last_frame, ieee1722_index_builder_keys(ai->builder),
+               ai->filename);
+    printf("===================================================================\n");
+}
+
+static void
+avtpindex_init(const char *optarg, void *userdata _U_)
+{
+    static const struct {
+        const char *tap;
+        tap_packet_cb packet;
+    } listeners[] = {
+        { "ieee1722",       avtpindex_stream_packet },
+        { "ieee17221.adp",  avtpindex_adp_packet },
+        { "ieee17221.acmp", avtpindex_acmp_packet }
+    };
+    avtpindex_t *ai;
+    GString *error_string;
+    guint i;
+
+    if (strncmp(optarg, "avtp,index,", 11) != 0 || optarg[11] == '\0') {
+        fprintf(stderr, "tshark: invalid \"-z avtp,index,<file>\" argument\n");
+        exit(1);
+    }
+
+    ai = g_new0(avtpindex_t, 1);
+    ai->filename = g_strdup(optarg + 11);
+    ai->builder = ieee1722_index_builder_new();
+
+    for (i = 0; i < G_N_ELEMENTS(listeners); i++) {
+        error_string = register_tap_listener(listeners[i].tap, ai, NULL, 0,
+                                             avtpindex_reset, listeners[i].packet,
+                                             avtpindex_draw);
+        if (error_string) {
+            fprintf(stderr, "tshark: Couldn't register avtp,index tap: %s\n",
+                    error_string->str);
+            g_string_free(error_string, TRUE);
+            exit(1);
+        }
+    }
+}
+
+void
+register_tap_listener_avtpindex(void)
+{
+    register_stat_cmd_arg("avtp,index,", avtpindex_init, NULL);
+}
@@ -0,0 +1,109 @@
+/* tap-avtpstate.c
+ * Occupancy of the IEEE 1722 / 1722.1 analysis state tables for tshark
+ * ("-z avtp,state")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The tables are not fed by the tap; it only provides the point at the
+ * end of the run at which their counters are printed.  A table with
+ * evictions had more streams or entities than the
+ * ieee1722.state_memory budget holds.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/ieee1722-state.h>
+
+#define AVTPSTATE_MAX_TABLES    16
+
+static int
+avtpstate_packet(void *arg _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_,
+                 const void *data _U_)
+{
+    return 0;
+}
+
+static void
+avtpstate_draw(void *arg _U_)
+{
+    ieee1722_state_stats_t stats[AVTPSTATE_MAX_TABLES];
+    guint64 used;
+    guint64 budget;
+    guint64 evictions = 0;
+    guint n;
+    guint i;
+
+    n = ieee1722_state_stats(stats, AVTPSTATE_MAX_TABLES, &used, &budget);
+    n = MIN(n, AVTPSTATE_MAX_TABLES);
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("AVTP analysis state:\n");
+    printf("Table                  Entries     Peak        KiB       Inserts    Evictions\n");
+    for (i = 0; i < n; i++) {
+        printf("%-20s %9u %9u %10" G_GINT64_MODIFIER "u %13" G_GINT64_MODIFIER "u %12"
+               G_GINT64_MODIFIER "u\n",
+               stats[i].name, stats[i].entries, stats[i].peak_entries,
+               (stats[i].bytes + 1023) / 1024, stats[i].inserts, stats[i].evictions);
+        evictions += stats[i].evictions;
+    }
+    printf("\n%" G_GINT64_MODIFIER "u of %" G_GINT64_MODIFIER "u KiB in use, %"
+           G_GINT64_MODIFIER "u entries evicted\n",
+           (used + 1023) / 1024, budget / 1024, evictions);
+    printf("===================================================================\n");
+}
+
+static void
+avtpstate_init(const char *optarg, void *userdata _U_)
+{
+    GString *error_string;
+
+    if (strcmp(optarg, "avtp,state") != 0) {
+        fprintf(stderr, "tshark: invalid \"-z avtp,state\" argument\n");
+        exit(1);
+    }
+
+    error_string = register_tap_listener("ieee1722", NULL, NULL, 0, NULL, avtpstate_packet,
+                                         avtpstate_draw);
+    if (error_string) {
+        fprintf(stderr, "tshark: Couldn't register avtp,state tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+void
+register_tap_listener_avtpstate(void)
+{
+    register_stat_cmd_arg("avtp,state", avtpstate_init, NULL);
+}
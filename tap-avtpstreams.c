@@ -0,0 +1,387 @@
+/* tap-avtpstreams.c
+ * AVTP stream statistics for tshark ("-z avtp,streams[,filter]")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/packet-ieee1722.h>
+
+/* Presentation time margin histogram bucket limits (us); the first bucket
+ * counts late frames, the last everything above the final limit.
+ */
+static const gint pt_bucket_limits_us[] = { 0, 250, 500, 1000, 2000, 5000 };
+#define PT_BUCKETS (G_N_ELEMENTS(pt_bucket_limits_us) + 1)
+
+/* Per-stream counters, one pass over the capture */
+typedef struct _avtp_stream_stats {
+    guint64 stream_id;
+    guint8  subtype;
+    guint32 packets;
+    guint64 bytes;
+    guint64 data_blocks;
+    guint32 seq_gaps;
+    guint32 seq_lost;
+    guint32 seq_duplicates;
+    guint32 seq_out_of_order;
+    gint64  first_ns;
+    gint64  last_ns;
+    gint64  min_iat_ns;
+    gint64  max_iat_ns;
+    guint8  dbs;
+    guint8  fmt;
+    guint8  fdf;
+    gboolean format_changed;
+    /* Presentation time analysis */
+    guint32 pt_packets;
+    gint64  pt_margin_sum_ns;
+    gint64  pt_margin_min_ns;
+    gint64  pt_margin_max_ns;
+    guint32 transit_jitter_ns;
+    guint32 max_transit_jitter_ns;
+    guint32 pt_histogram[PT_BUCKETS];
+    /* Media clock */
+    gdouble clock_nominal_hz;
+    guint32 clock_packets;
+    gfloat  clock_drift_ppm;
+    gfloat  clock_drift_min_ppm;
+    gfloat  clock_drift_max_ppm;
+    gfloat  clock_jitter_ns;
+    gfloat  clock_jitter_max_ns;
+    guint32 syt_backwards;
+    /* 61883-6 DBC continuity */
+    guint32 dbc_skips;
+    guint32 blocks_skipped;
+    guint32 dbc_repeats;
+    guint32 blocks_repeated;
+    guint32 blocks_lost;        /* with lost packets */
+    /* SR class reservation */
+    gboolean class_b;
+    guint32 bursts;
+    guint16 reserved_frames;
+    guint32 oversubscriptions;
+    guint32 max_window_kbps;
+    guint32 reserved_kbps;
+} avtp_stream_stats_t;
+
+typedef struct _avtpstreams_t {
+    char       *filter;
+    GHashTable *streams;
+} avtpstreams_t;
+
+static void
+avtpstreams_reset(void *arg)
+{
+    avtpstreams_t *as = arg;
+
+    g_hash_table_remove_all(as->streams);
+}
+
+static int
+avtpstreams_packet(void *arg, packet_info *pinfo, epan_dissect_t *edt _U_, const void *data)
+{
+    avtpstreams_t *as = arg;
+    const ieee1722_tap_info_t *info = data;
+    avtp_stream_stats_t *st;
+    gint64 now_ns;
+
+    now_ns = (gint64)pinfo->fd->abs_ts.secs * 1000000000 + pinfo->fd->abs_ts.nsecs;
+
+    st = g_hash_table_lookup(as->streams, &info->stream_id);
+    if (st == NULL) {
+        st = g_new0(avtp_stream_stats_t, 1);
+        st->stream_id = info->stream_id;
+        st->subtype = info->subtype;
+        st->first_ns = now_ns;
+        st->min_iat_ns = G_MAXINT64;
+        st->dbs = info->dbs;
+        st->fmt = info->fmt;
+        st->fdf = info->fdf;
+        g_hash_table_insert(as->streams, &st->stream_id, st);
+    }
+    else {
+        gint64 iat = now_ns - st->last_ns;
+
+        if (iat < st->min_iat_ns)
+            st->min_iat_ns = iat;
+        if (iat > st->max_iat_ns)
+            st->max_iat_ns = iat;
+        if (st->dbs != info->dbs || st->fmt != info->fmt || st->fdf != info->fdf) {
+            st->format_changed = TRUE;
+            st->dbs = info->dbs;
+            st->fmt = info->fmt;
+            st->fdf = info->fdf;
+        }
+    }
+    st->last_ns = now_ns;
+    st->packets++;
+    st->bytes += pinfo->fd->pkt_len;
+    st->data_blocks += info->data_blocks;
+
+    switch (info->seq_status) {
+        case IEEE1722_SEQ_LOST:
+            st->seq_gaps++;
+            st->seq_lost += info->lost;
+            break;
+        case IEEE1722_SEQ_DUPLICATE:
+            st->seq_duplicates++;
+            break;
+        case IEEE1722_SEQ_OUT_OF_ORDER:
+            st->seq_out_of_order++;
+            break;
+        default:
+            break;
+    }
+
+    if (info->has_pt) {
+        guint bucket = 0;
+
+        if (st->pt_packets == 0 || info->pt_margin_ns < st->pt_margin_min_ns)
+            st->pt_margin_min_ns = info->pt_margin_ns;
+        if (st->pt_packets == 0 || info->pt_margin_ns > st->pt_margin_max_ns)
+            st->pt_margin_max_ns = info->pt_margin_ns;
+        st->pt_margin_sum_ns += info->pt_margin_ns;
+        st->pt_packets++;
+        st->transit_jitter_ns = info->transit_jitter_ns;
+        if (info->transit_jitter_ns > st->max_transit_jitter_ns)
+            st->max_transit_jitter_ns = info->transit_jitter_ns;
+
+        while (bucket < PT_BUCKETS - 1 &&
+               info->pt_margin_ns >= (gint64)pt_bucket_limits_us[bucket] * 1000)
+            bucket++;
+        st->pt_histogram[bucket]++;
+    }
+
+    if (info->clock_nominal_hz > 0.0)
+        st->clock_nominal_hz = info->clock_nominal_hz;
+    if (info->has_clock) {
+        if (st->clock_packets == 0 || info->clock_drift_ppm < st->clock_drift_min_ppm)
+            st->clock_drift_min_ppm = info->clock_drift_ppm;
+        if (st->clock_packets == 0 || info->clock_drift_ppm > st->clock_drift_max_ppm)
+            st->clock_drift_max_ppm = info->clock_drift_ppm;
+        if (info->clock_jitter_ns > st->clock_jitter_max_ns)
+            st->clock_jitter_max_ns = info->clock_jitter_ns;
+        st->clock_drift_ppm = info->clock_drift_ppm;
+        st->clock_jitter_ns = info->clock_jitter_ns;
+        st->clock_packets++;
+    }
+    if (info->clock_faults & IEEE1722_CLOCK_SYT_BACKWARDS)
+        st->syt_backwards++;
+
+    if (info->bw_faults) {
+        st->class_b = info->class_b;
+        st->reserved_frames = info->reserved_frames;
+        st->reserved_kbps = info->reserved_kbps;
+        if (info->bw_faults & IEEE1722_BW_BURST)
+            st->bursts++;
+        if (info->bw_faults & IEEE1722_BW_OVERSUBSCRIBED) {
+            st->oversubscriptions++;
+            if (info->window_kbps > st->max_window_kbps)
+                st->max_window_kbps = info->window_kbps;
+        }
+    }
+
+    switch (info->dbc_status) {
+        case IEEE1722_DBC_SKIPPED:
+            st->dbc_skips++;
+            st->blocks_skipped += info->dbc_blocks;
+            break;
+        case IEEE1722_DBC_REPEATED:
+            st->dbc_repeats++;
+            st->blocks_repeated += info->dbc_blocks;
+            break;
+        case IEEE1722_DBC_LOST:
+            st->blocks_lost += info->dbc_blocks;
+            break;
+        default:
+            break;
+    }
+
+    return 1;
+}
+
+static gint
+avtp_stream_compare(gconstpointer a, gconstpointer b)
+{
+    const avtp_stream_stats_t *sa = *(const avtp_stream_stats_t * const *)a;
+    const avtp_stream_stats_t *sb = *(const avtp_stream_stats_t * const *)b;
+
+    if (sa->stream_id == sb->stream_id)
+        return 0;
+    return sa->stream_id < sb->stream_id ? -1 : 1;
+}
+
+static void
+avtp_stream_collect(gpointer key _U_, gpointer value, gpointer user_data)
+{
+    g_ptr_array_add((GPtrArray *)user_data, value);
+}
+
+static void
+avtpstreams_draw(void *arg)
+{
+    avtpstreams_t *as = arg;
+    GPtrArray *sorted;
+    guint i;
+
+    sorted = g_ptr_array_new();
+    g_hash_table_foreach(as->streams, avtp_stream_collect, sorted);
+    g_ptr_array_sort(sorted, avtp_stream_compare);
+
+    printf("\n");
+    printf("===================================================================================================================\n");
+    printf("AVTP Streams:\n");
+    if (as->filter)
+        printf("Filter: %s\n", as->filter);
+    printf("Stream ID           Subtype  Packets        Bytes   Blocks/s  Gaps  Lost  Dup   OoO  IAT min/avg/max (us)       DBS FMT  FDF\n");
+    for (i = 0; i < sorted->len; i++) {
+        avtp_stream_stats_t *st = g_ptr_array_index(sorted, i);
+        gint64 duration_ns = st->last_ns - st->first_ns;
+        double blocks_per_sec = 0.0;
+        double avg_iat_us = 0.0;
+
+        if (duration_ns > 0)
+            blocks_per_sec = st->data_blocks * 1e9 / duration_ns;
+        if (st->packets > 1)
+            avg_iat_us = duration_ns / 1e3 / (st->packets - 1);
+
+        printf("0x%016" G_GINT64_MODIFIER "x  0x%02x  %9u %12" G_GINT64_MODIFIER "u %10.0f %5u %5u %5u %5u ",
+               st->stream_id, st->subtype, st->packets, st->bytes, blocks_per_sec,
+               st->seq_gaps, st->seq_lost, st->seq_duplicates, st->seq_out_of_order);
+        if (st->packets > 1)
+            printf("%8.1f/%8.1f/%8.1f ", st->min_iat_ns / 1e3, avg_iat_us, st->max_iat_ns / 1e3);
+        else
+            printf("%26s ", "-");
+        printf("%3u 0x%02x 0x%02x%s\n", st->dbs, st->fmt, st->fdf,
+               st->format_changed ? " (changed)" : "");
+    }
+
+    for (i = 0; i < sorted->len; i++) {
+        avtp_stream_stats_t *st = g_ptr_array_index(sorted, i);
+        guint b;
+
+        if (st->pt_packets == 0)
+            continue;
+        printf("\nPresentation time of 0x%016" G_GINT64_MODIFIER "x (%u packets):\n",
+               st->stream_id, st->pt_packets);
+        printf("  Margin min/avg/max (us): %.3f/%.3f/%.3f\n",
+               st->pt_margin_min_ns / 1e3, st->pt_margin_sum_ns / 1e3 / st->pt_packets,
+               st->pt_margin_max_ns / 1e3);
+        printf("  Transit jitter last/max (us): %.3f/%.3f\n",
+               st->transit_jitter_ns / 1e3, st->max_transit_jitter_ns / 1e3);
+        printf("  Margin histogram:");
+        for (b = 0; b < PT_BUCKETS; b++) {
+            if (b == 0)
+                printf(" late:%u", st->pt_histogram[b]);
+            else if (b == PT_BUCKETS - 1)
+                printf(" >=%d:%u", pt_bucket_limits_us[b - 1], st->pt_histogram[b]);
+            else
+                printf(" %d-%d:%u", pt_bucket_limits_us[b - 1], pt_bucket_limits_us[b],
+                       st->pt_histogram[b]);
+        }
+        printf("\n");
+    }
+
+    for (i = 0; i < sorted->len; i++) {
+        avtp_stream_stats_t *st = g_ptr_array_index(sorted, i);
+
+        if (st->clock_packets == 0 && st->syt_backwards == 0)
+            continue;
+        printf("\nMedia clock of 0x%016" G_GINT64_MODIFIER "x (%.3f Hz nominal, %u packets):\n",
+               st->stream_id, st->clock_nominal_hz, st->clock_packets);
+        if (st->clock_packets != 0) {
+            printf("  Drift last/min/max (ppm): %.3f/%.3f/%.3f\n",
+                   st->clock_drift_ppm, st->clock_drift_min_ppm, st->clock_drift_max_ppm);
+            printf("  Phase jitter last/max (ns): %.1f/%.1f\n",
+                   st->clock_jitter_ns, st->clock_jitter_max_ns);
+        }
+        if (st->syt_backwards != 0)
+            printf("  SYT steps backwards: %u\n", st->syt_backwards);
+    }
+
+    for (i = 0; i < sorted->len; i++) {
+        avtp_stream_stats_t *st = g_ptr_array_index(sorted, i);
+
+        if (st->dbc_skips == 0 && st->dbc_repeats == 0 && st->blocks_lost == 0)
+            continue;
+        printf("\nData block continuity of 0x%016" G_GINT64_MODIFIER "x:\n", st->stream_id);
+        printf("  Blocks lost with packets: %u\n", st->blocks_lost);
+        printf("  Blocks skipped: %u in %u packets\n", st->blocks_skipped, st->dbc_skips);
+        printf("  Blocks repeated: %u in %u packets\n", st->blocks_repeated, st->dbc_repeats);
+    }
+
+    for (i = 0; i < sorted->len; i++) {
+        avtp_stream_stats_t *st = g_ptr_array_index(sorted, i);
+
+        if (st->bursts == 0 && st->oversubscriptions == 0)
+            continue;
+        printf("\nSR class %c reservation of 0x%016" G_GINT64_MODIFIER "x (%u frames per interval, %u kbit/s):\n",
+               st->class_b ? 'B' : 'A', st->stream_id, st->reserved_frames, st->reserved_kbps);
+        printf("  Intervals with a burst: %u\n", st->bursts);
+        printf("  Windows over the reservation: %u, peaking at %u kbit/s\n",
+               st->oversubscriptions, st->max_window_kbps);
+    }
+    printf("===================================================================================================================\n");
+
+    g_ptr_array_free(sorted, TRUE);
+}
+
+static void
+avtpstreams_init(const char *optarg, void *userdata _U_)
+{
+    avtpstreams_t *as;
+    GString *error_string;
+
+    as = g_new0(avtpstreams_t, 1);
+    if (strncmp(optarg, "avtp,streams,", 13) == 0)
+        as->filter = g_strdup(optarg + 13);
+    as->streams = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, g_free);
+
+    error_string = register_tap_listener("ieee1722", as, as->filter, 0,
+                                         avtpstreams_reset, avtpstreams_packet, avtpstreams_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_free(as->filter);
+        g_hash_table_destroy(as->streams);
+        g_free(as);
+
+        fprintf(stderr, "tshark: Couldn't register avtp,streams tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+void
+register_tap_listener_avtpstreams(void)
+{
+    register_stat_cmd_arg("avtp,streams", avtpstreams_init, NULL);
+}
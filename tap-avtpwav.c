@@ -0,0 +1,391 @@
+/* tap-avtpwav.c
+ * Export the AM824 audio of one AVTP stream to WAV for tshark
+ * ("-z avtp,wav,<stream id>,<file>[,split]")
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Samples are written as 32-bit PCM with 24 valid bits
+ * (WAVE_FORMAT_EXTENSIBLE), which lets the AM824 quadlets be converted in
+ * place: drop the label, byte-swap the 24-bit sample and leave it
+ * left-justified.  With "split" each channel goes to <file>-<n>.wav,
+ * otherwise one interleaved multichannel file is written.  Lost packets
+ * are filled with silence so the channels stay time-aligned.
+ *
+ * Converted samples are staged in a fixed buffer per output file and
+ * written in batches; nothing is allocated per packet.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_cmd_args.h>
+#include <epan/dissectors/packet-ieee1722.h>
+
+#define WAV_HEADER_SIZE     68
+#define WAV_BATCH_SAMPLES   16384       /* per output file */
+#define WAV_MAX_DATA_SIZE   (G_MAXUINT32 - WAV_HEADER_SIZE)
+#define WAV_MAX_CHANNELS    64
+
+typedef struct _wav_file {
+    FILE   *fp;
+    guint32 data_bytes;
+    guint   nbuffered;
+    guint32 buffer[WAV_BATCH_SAMPLES];
+} wav_file_t;
+
+typedef struct _avtpwav_t {
+    guint64 stream_id;
+    char   *filename;
+    gboolean split;
+    guint8  dbs;                /* channel count, fixed by the first frame */
+    guint32 sample_rate;
+    guint   last_blocks;        /* data blocks in the previous frame */
+    guint32 frames;
+    guint32 skipped;
+    guint32 silence_blocks;
+    gboolean truncated;
+    guint   nfiles;
+    wav_file_t *files;
+    guint32 scratch[WAV_BATCH_SAMPLES];
+} avtpwav_t;
+
+/* IEC 61883-6 SFC (low 3 bits of the AM824 FDF) to sampling frequency */
+static const guint32 sfc_rates[8] = {
+    32000, 44100, 48000, 88200, 96000, 176400, 192000, 0
+};
+
+/* Convert n AM824 quadlets (label, 24-bit big endian sample) to
+ * little-endian 32-bit samples with the 24 bits in the top three bytes.
+ * On a little-endian load the quadlet reads L|M<<8|m<<16|l<<24 and the
+ * result must be 0|l<<8|m<<16|M<<24, i.e. bswap32(x) << 8.
+ */
+static void
+am824_to_s32le(guint32 *dst, const guint8 *src, guint n)
+{
+    guint i = 0;
+
+#ifdef __SSE2__
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i*4));
+
+        /* Swap the bytes of each 16-bit half, then the halves */
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+        x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_slli_epi32(x, 8));
+    }
+#endif
+    for (; i < n; i++) {
+        const guint8 *q = src + i*4;
+        guint8 *d = (guint8 *)(dst + i);
+
+        d[0] = 0;
+        d[1] = q[3];
+        d[2] = q[2];
+        d[3] = q[1];
+    }
+}
+
+static void
+put_le16(guint8 *p, guint16 v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static void
+put_le32(guint8 *p, guint32 v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = v >> 24;
+}
+
+/* WAVE_FORMAT_EXTENSIBLE header for 32-bit containers with 24 valid bits */
+static void
+wav_write_header(wav_file_t *wf, guint channels, guint32 rate)
+{
+    static const guint8 ksdataformat_pcm[16] = {
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+        0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71
+    };
+    guint8 h[WAV_HEADER_SIZE];
+
+    memcpy(h, "RIFF", 4);
+    put_le32(h + 4, WAV_HEADER_SIZE - 8 + wf->data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le32(h + 16, 40);
+    put_le16(h + 20, 0xfffe);                   /* WAVE_FORMAT_EXTENSIBLE */
+    put_le16(h + 22, channels);
+    put_le32(h + 24, rate);
+    put_le32(h + 28, rate * channels * 4);
+    put_le16(h + 32, channels * 4);
+    put_le16(h + 34, 32);
+    put_le16(h + 36, 22);
+    put_le16(h + 38, 24);                       /* valid bits */
+    put_le32(h + 40, 0);                        /* no speaker mapping */
+    memcpy(h + 44, ksdataformat_pcm, 16);
+    memcpy(h + 60, "data", 4);
+    put_le32(h + 64, wf->data_bytes);
+
+    fseek(wf->fp, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), wf->fp);
+}
+
+static void
+wav_flush(avtpwav_t *aw, wav_file_t *wf)
+{
+    guint32 bytes = wf->nbuffered * 4;
+
+    if (wf->nbuffered == 0)
+        return;
+    if (wf->data_bytes > WAV_MAX_DATA_SIZE - bytes) {
+        aw->truncated = TRUE;
+        bytes = (WAV_MAX_DATA_SIZE - wf->data_bytes) & ~3U;
+    }
+    fwrite(wf->buffer, 1, bytes, wf->fp);
+    wf->data_bytes += bytes;
+    wf->nbuffered = 0;
+}
+
+/* Append n samples, spaced stride apart in src, to one output file */
+static void
+wav_append(avtpwav_t *aw, wav_file_t *wf, const guint32 *src, guint n, guint stride)
+{
+    guint i;
+
+    for (i = 0; i < n; i++) {
+        if (wf->nbuffered == WAV_BATCH_SAMPLES)
+            wav_flush(aw, wf);
+        wf->buffer[wf->nbuffered++] = src[i*stride];
+    }
+}
+
+static void
+avtpwav_write_blocks(avtpwav_t *aw, const guint32 *samples, guint nblocks)
+{
+    guint c;
+
+    if (!aw->split) {
+        wav_append(aw, &aw->files[0], samples, nblocks * aw->dbs, 1);
+        return;
+    }
+    for (c = 0; c < aw->dbs; c++)
+        wav_append(aw, &aw->files[c], samples + c, nblocks, aw->dbs);
+}
+
+static gboolean
+avtpwav_open(avtpwav_t *aw)
+{
+    guint i;
+
+    aw->nfiles = aw->split ? aw->dbs : 1;
+    aw->files = g_new0(wav_file_t, aw->nfiles);
+    for (i = 0; i < aw->nfiles; i++) {
+        gchar *name;
+
+        if (aw->split)
+            name = g_strdup_printf("%s-%u.wav", aw->filename, i + 1);
+        else
+            name = g_strdup(aw->filename);
+        aw->files[i].fp = fopen(name, "wb");
+        if (aw->files[i].fp == NULL) {
+            fprintf(stderr, "tshark: avtp,wav: can't create %s\n", name);
+            g_free(name);
+            return FALSE;
+        }
+        g_free(name);
+        wav_write_header(&aw->files[i], aw->split ? 1 : aw->dbs, aw->sample_rate);
+    }
+    return TRUE;
+}
+
+static void
+avtpwav_close(avtpwav_t *aw)
+{
+    guint i;
+
+    for (i = 0; i < aw->nfiles; i++) {
+        if (aw->files[i].fp == NULL)
+            continue;
+        wav_flush(aw, &aw->files[i]);
+        wav_write_header(&aw->files[i], aw->split ? 1 : aw->dbs, aw->sample_rate);
+        fclose(aw->files[i].fp);
+    }
+    g_free(aw->files);
+    aw->files = NULL;
+    aw->nfiles = 0;
+}
+
+static void
+avtpwav_reset(void *arg)
+{
+    avtpwav_t *aw = arg;
+
+    avtpwav_close(aw);
+    aw->dbs = 0;
+    aw->last_blocks = 0;
+    aw->frames = 0;
+    aw->skipped = 0;
+    aw->silence_blocks = 0;
+    aw->truncated = FALSE;
+}
+
+static int
+avtpwav_packet(void *arg, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *data)
+{
+    avtpwav_t *aw = arg;
+    const ieee1722_tap_info_t *info = data;
+    guint done;
+
+    if (info->stream_id != aw->stream_id)
+        return 0;
+
+    if (info->am824 == NULL || info->dbs > WAV_MAX_CHANNELS ||
+        (aw->dbs != 0 && info->dbs != aw->dbs)) {
+        aw->skipped++;
+        return 0;
+    }
+
+    if (aw->dbs == 0) {
+        aw->dbs = info->dbs;
+        aw->sample_rate = sfc_rates[info->fdf & 0x07];
+        if (aw->sample_rate == 0)
+            aw->sample_rate = 48000;
+        if (!avtpwav_open(aw)) {
+            avtpwav_close(aw);
+            exit(1);
+        }
+    }
+
+    /* Keep the timeline: one previous frame's worth of silence per lost packet */
+    if (info->seq_status == IEEE1722_SEQ_LOST && aw->last_blocks != 0) {
+        guint silent = info->lost * aw->last_blocks;
+
+        memset(aw->scratch, 0, sizeof(aw->scratch));
+        aw->silence_blocks += silent;
+        while (silent != 0) {
+            guint n = MIN(silent, WAV_BATCH_SAMPLES / aw->dbs);
+
+            avtpwav_write_blocks(aw, aw->scratch, n);
+            silent -= n;
+        }
+    }
+    else if (info->seq_status == IEEE1722_SEQ_DUPLICATE) {
+        aw->skipped++;
+        return 0;
+    }
+
+    for (done = 0; done < info->data_blocks; ) {
+        guint n = MIN(info->data_blocks - done, WAV_BATCH_SAMPLES / aw->dbs);
+
+        am824_to_s32le(aw->scratch, info->am824 + done * aw->dbs * 4, n * aw->dbs);
+        avtpwav_write_blocks(aw, aw->scratch, n);
+        done += n;
+    }
+    aw->last_blocks = info->data_blocks;
+    aw->frames++;
+
+    return 0;
+}
+
+static void
+avtpwav_draw(void *arg)
+{
+    avtpwav_t *aw = arg;
+    guint8 dbs = aw->dbs;
+
+    avtpwav_close(aw);
+
+    printf("\n");
+    printf("===================================================================\n");
+    printf("AVTP WAV export of stream 0x%016" G_GINT64_MODIFIER "x:\n", aw->stream_id);
+    if (dbs == 0) {
+        printf("No AM824 audio found\n");
+    }
+    else {
+        printf("%u frames, %u channels at %u Hz written to %s%s\n", aw->frames, dbs,
+               aw->sample_rate, aw->filename, aw->split ? "-<channel>.wav" : "");
+        printf("%u data blocks of silence inserted for lost packets, %u frames skipped\n",
+               aw->silence_blocks, aw->skipped);
+        if (aw->truncated)
+            printf("Output truncated at the 4 GB WAV size limit\n");
+    }
+    printf("===================================================================\n");
+}
+
+static void
+avtpwav_init(const char *optarg, void *userdata _U_)
+{
+    avtpwav_t *aw;
+    GString *error_string;
+    gchar **args;
+    gchar *end;
+
+    args = g_strsplit(optarg, ",", 5);
+    if (g_strv_length(args) < 4 || (args[4] != NULL && strcmp(args[4], "split") != 0)) {
+        fprintf(stderr, "tshark: invalid \"-z avtp,wav,<stream id>,<file>[,split]\" argument\n");
+        exit(1);
+    }
+
+    aw = g_new0(avtpwav_t, 1);
+    aw->stream_id = g_ascii_strtoull(args[2], &end, 16);
+    if (*end != '\0') {
+        fprintf(stderr, "tshark: avtp,wav: invalid stream ID \"%s\"\n", args[2]);
+        exit(1);
+    }
+    aw->filename = g_strdup(args[3]);
+    aw->split = args[4] != NULL;
+    g_strfreev(args);
+
+    error_string = register_tap_listener("ieee1722", aw, NULL, 0,
+                                         avtpwav_reset, avtpwav_packet, avtpwav_draw);
+    if (error_string) {
+        /* error, we failed to attach to the tap. clean up */
+        g_free(aw->filename);
+        g_free(aw);
+
+        fprintf(stderr, "tshark: Couldn't register avtp,wav tap: %s\n",
+                error_string->str);
+        g_string_free(error_string, TRUE);
+        exit(1);
+    }
+}
+
+void
+register_tap_listener_avtpwav(void)
+{
+    register_stat_cmd_arg("avtp,wav,", avtpwav_init, NULL);
+}